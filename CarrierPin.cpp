@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2025 Tomosawa
+ * All rights reserved.
+ *
+ * This code is part of the WiFi2JJY project.
+ * GitHub: https://github.com/Tomosawa/WIFI2JJY
+ */
+#include "CarrierPin.h"
+#include "driver/ledc.h"
+#include "soc/ledc_periph.h"
+#include "HAL.h"
+#include <math.h>
+
+// 6 位占空比分辨率：占空比 d 的方波基波幅度正比于 sin(πd)，
+// 2/64 约 10%（JJY），3/64 约 15%（WWVB/DCF77）；计数周期仍然很短，
+// LEDC 分数分频器得到的平均频率误差很小（40kHz 精确，60kHz 约 +4Hz，77.5kHz 约 +1Hz）
+static const ledc_timer_bit_t CARRIER_RESOLUTION = LEDC_TIMER_6_BIT;
+static const uint32_t DUTY_STEPS = 64;
+static const uint32_t FULL_DUTY = DUTY_STEPS / 2;  // 50%
+static const ledc_mode_t CARRIER_MODE = LEDC_LOW_SPEED_MODE;
+static const ledc_timer_t CARRIER_TIMER = LEDC_TIMER_0;
+static const ledc_channel_t FULL_CHANNEL = LEDC_CHANNEL_0;
+static const ledc_channel_t REDUCED_CHANNEL = LEDC_CHANNEL_1;
+
+// 基波幅度为满幅 percent% 的占空比
+static uint32_t reducedDutyFor(uint8_t percent) {
+    if (percent >= 100) {
+        return FULL_DUTY;
+    }
+    return (uint32_t)lroundf(asinf(percent / 100.0f) * DUTY_STEPS / (float)M_PI);
+}
+
+CarrierPin::CarrierPin(int pin, uint32_t carrierHz, uint8_t reducedPercent)
+    : m_pin(pin), m_carrierHz(carrierHz), m_reducedDuty(reducedDutyFor(reducedPercent)),
+      m_fullSignal(ledc_periph_signal[CARRIER_MODE].sig_out0_idx + FULL_CHANNEL),
+      m_reducedSignal(ledc_periph_signal[CARRIER_MODE].sig_out0_idx + REDUCED_CHANNEL) {
+}
+
+bool CarrierPin::begin(uint8_t idleLevel) {
+    ledc_timer_config_t timerConfig = {};
+    timerConfig.speed_mode = CARRIER_MODE;
+    timerConfig.duty_resolution = CARRIER_RESOLUTION;
+    timerConfig.timer_num = CARRIER_TIMER;
+    timerConfig.freq_hz = m_carrierHz;
+    timerConfig.clk_cfg = LEDC_AUTO_CLK;
+    esp_err_t err = ledc_timer_config(&timerConfig);
+    if (err != ESP_OK) {
+        hal::log("[CarrierPin] ledc_timer_config failed: %d\n", err);
+        return false;
+    }
+
+    // 两个通道都挂在同一个定时器上，相位一致，切换时载波不断续
+    ledc_channel_config_t channelConfig = {};
+    channelConfig.gpio_num = m_pin;
+    channelConfig.speed_mode = CARRIER_MODE;
+    channelConfig.intr_type = LEDC_INTR_DISABLE;
+    channelConfig.timer_sel = CARRIER_TIMER;
+    channelConfig.hpoint = 0;
+
+    channelConfig.channel = FULL_CHANNEL;
+    channelConfig.duty = FULL_DUTY;
+    err = ledc_channel_config(&channelConfig);
+    if (err == ESP_OK) {
+        channelConfig.channel = REDUCED_CHANNEL;
+        channelConfig.duty = m_reducedDuty;
+        err = ledc_channel_config(&channelConfig);
+    }
+    if (err != ESP_OK) {
+        hal::log("[CarrierPin] ledc_channel_config failed: %d\n", err);
+        return false;
+    }
+
+    write(idleLevel);
+    hal::log("[CarrierPin] %lu Hz carrier ready (Pin: %d, actual %lu Hz)\n",
+             (unsigned long)m_carrierHz, m_pin,
+             (unsigned long)ledc_get_freq(CARRIER_MODE, CARRIER_TIMER));
+    return true;
+}
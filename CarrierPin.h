@@ -0,0 +1,42 @@
+/*
+ * Copyright (c) 2025 Tomosawa
+ * All rights reserved.
+ *
+ * This code is part of the WiFi2JJY project.
+ * GitHub: https://github.com/Tomosawa/WIFI2JJY
+ */
+#ifndef CARRIERPIN_H
+#define CARRIERPIN_H
+
+#include <Arduino.h>
+#include "esp_rom_gpio.h"
+
+// 载波输出引脚策略：LEDC 的同一个定时器驱动两个通道持续产生 40/60/77.5kHz 方波，
+// 一个占空比 50%（满幅），一个按协议的降幅占空比（JJY 为 2/64，基波幅度 sin(π/32) ≈ 10%）。
+// write(level) 只切换 GPIO 矩阵把哪个通道接到引脚上，CPU 不参与每个载波周期，
+// 可在中断上下文中调用。DA低电平对应满幅，高电平对应降幅。
+class CarrierPin {
+public:
+    static constexpr uint32_t CARRIER_40KHZ = 40000;  // 大鷹鳥谷山送信所
+    static constexpr uint32_t CARRIER_60KHZ = 60000;  // はがね山送信所
+
+    // reducedPercent 为降幅时的基波幅度（满幅的百分比），0 为断载波
+    CarrierPin(int pin, uint32_t carrierHz, uint8_t reducedPercent = 10);
+
+    // 配置 LEDC 定时器与两个通道，引脚初始为协议的空闲电平（JJY 为降幅，WWVB/DCF77/MSF 为满幅）；
+    // LEDC 配置失败时返回 false
+    bool begin(uint8_t idleLevel);
+
+    inline void write(uint8_t level) const {
+        esp_rom_gpio_connect_out_signal(m_pin, level ? m_reducedSignal : m_fullSignal, false, false);
+    }
+
+private:
+    int m_pin;
+    uint32_t m_carrierHz;
+    uint32_t m_reducedDuty;
+    uint32_t m_fullSignal;     // 满幅通道的 GPIO 矩阵输出信号
+    uint32_t m_reducedSignal;  // 降幅通道的 GPIO 矩阵输出信号
+};
+
+#endif // CARRIERPIN_H
@@ -0,0 +1,144 @@
+/*
+ * Copyright (c) 2025 Tomosawa
+ * All rights reserved.
+ *
+ * This code is part of the WiFi2JJY project.
+ * GitHub: https://github.com/Tomosawa/WIFI2JJY
+ */
+#include "ClockApp.h"
+#include "IOPin.h"
+#include "HAL.h"
+
+ClockApp::ClockApp(JJYSender::OutputBackend backend, TimeCodeProtocol protocol, int webPort,
+                   bool traceVcd)
+    : m_webService(&m_wifiManager, webPort), m_jjySender(PIN_DA, backend, protocol),
+      m_traceVcd(traceVcd) {
+  m_webService.setTimeSync(&m_timeSync);
+}
+
+void ClockApp::setup() {
+  hal::log("=== JJY Clock Initialization ===\n");
+
+  hal::pinInput(PIN_PON);
+  hal::log("[Setup] PON pin configured as INPUT, current value: %s\n",
+           hal::pinRead(PIN_PON) ? "HIGH" : "LOW");
+  if (m_traceVcd) {
+    m_jjySender.enableTrace();
+  }
+  if (m_calibrationPin >= 0 && !m_jjySender.calibrate(m_calibrationPin, m_calibrationToleranceUs)) {
+    hal::log("[Setup] Edge calibration failed, sending without compensation\n");
+  }
+
+  // 频率已学到、还没到校时间隔时不开无线，按本地时钟直接发送
+  m_timeSync.begin();
+  if (!m_timeSync.syncDue()) {
+    m_timeSync.freeRun();
+    m_networkSkipped = true;
+    hal::log("=== Initialization Complete (NTP sync not due, WiFi off) ===\n");
+    return;
+  }
+
+  // 初始化WiFi管理器
+  hal::log("[WiFi] Initializing WiFi Manager...\n");
+  m_wifiManager.begin();
+  // 启动Web服务器
+  m_webService.begin();
+  hal::log("[WebServer] Configuration server started at %s\n",
+           m_wifiManager.getLocalIP().c_str());
+
+  // 如果没有保存的配置，直接跳过等待，保持 AP 模式
+  if (!m_wifiManager.hasSavedConfig()) {
+    hal::log("[WiFi] No saved WiFi config, stay in AP mode for setup.\n");
+    hal::log("=== Initialization Complete ===\n");
+    return;
+  }
+
+  // 等待WiFi连接（仅在已有配置时尝试）
+  hal::log("[WiFi] Waiting for saved WiFi connection...\n");
+  uint32_t wifiStartTime = hal::monotonicMs();
+  const uint32_t wifiTimeout = 30000; // 30秒超时
+
+  while (!m_wifiManager.isConnected() &&
+         (hal::monotonicMs() - wifiStartTime < wifiTimeout)) {
+    m_wifiManager.handleConnection();
+    m_webService.handleClient();
+    hal::sleepMs(100);
+
+    // 每5秒打印一次状态
+    if ((hal::monotonicMs() - wifiStartTime) % 5000 < 100) {
+      hal::log("[WiFi] Status: %s\n", m_wifiManager.getConnectionStatus().c_str());
+    }
+  }
+
+  if (m_wifiManager.isConnected()) {
+    m_wifiConnected = true;
+    hal::log("[WiFi] Connected successfully!\n");
+    hal::log("[WiFi] IP address: %s\n", m_wifiManager.getLocalIP().c_str());
+
+    // 同步NTP时间
+    m_timeSync.startNTPSyncTask();
+  } else {
+    hal::log("[WiFi] Connection timeout or failed, continuing in AP mode...\n");
+    m_holdover = m_timeSync.holdover();
+  }
+
+  hal::log("=== Initialization Complete ===\n");
+}
+
+void ClockApp::loop() {
+  // 处理Web服务器请求
+  m_webService.handleClient();
+  // 启动时WIFI未连接过，但现在已连接，保存配置
+  if (!m_wifiConnected && m_wifiManager.isConnected()) {
+    m_wifiConnected = true;
+    hal::log("[WiFi] WIFI Connected, Saving Configuration...\n");
+    m_wifiManager.saveWiFiConfig();
+  }
+
+  // 上次校时失败（服务器没有应答，或 WiFi 在应答前又断开了），不管现在连没连着，
+  // 误差估计还在上限内就先守时发送，不让钟表等着；每次校时只判断一次
+  if (!m_timeSync.timeSynced && m_timeSync.syncFailed() && !m_holdoverChecked) {
+    m_holdoverChecked = true;
+    m_holdover = m_timeSync.holdover();
+  }
+
+  // WIFI连接了，但是时间还没有同步，则尝试同步
+  if (m_wifiConnected && m_wifiManager.isConnected() && !m_timeSync.timeSynced) {
+    hal::log("[WiFi] WIFI Connected, Time synchronization...\n");
+    m_holdoverChecked = false;
+    m_timeSync.startNTPSyncTask();
+    hal::sleepMs(3000); // 等待3秒后重试
+    return; // 退出当前循环，避免继续执行后续代码
+  }
+
+  // 按学到的频率修正挂钟
+  if (m_timeSync.timeSynced) {
+    m_timeSync.tickDiscipline();
+  }
+
+  // WiFi 已连接（或本次不需要校时、正在守时）且时间同步后，启动高优先级任务发送JJY，不阻塞主循环
+  if ((m_wifiConnected || m_networkSkipped || m_holdover) && m_timeSync.timeSynced && !m_jjySender.isAsyncRunning() &&
+      !m_jjySender.isAsyncDone()) {
+    hal::log("\n=== Starting JJY send task ===\n");
+    m_jjySender.startAsyncSend(&m_timeSync);
+  }
+
+  // 如果发送任务完成，准备休眠
+  if (m_jjySender.isAsyncDone()) {
+    hal::log("\n=== Exiting Main Loop ===\n");
+    if (m_traceVcd) {
+      m_jjySender.dumpTrace();
+    }
+    hal::log("[System] Configuring deep sleep with PON pin wakeup...\n");
+    hal::log("[System] GPIO%d configured for GPIO wakeup\n", PIN_PON);
+    hal::log("[System] Entering deep sleep...\n");
+
+    m_timeSync.saveDiscipline();
+    hal::netShutdown();
+    hal::sleepMs(50);
+    hal::deepSleep(PIN_PON);
+  }
+
+  // 继续处理Web请求 / 连接维护
+  hal::sleepMs(50);
+}
@@ -0,0 +1,68 @@
+/*
+ * Copyright (c) 2025 Tomosawa
+ * All rights reserved.
+ *
+ * This code is part of the WiFi2JJY project.
+ * GitHub: https://github.com/Tomosawa/WIFI2JJY
+ */
+#ifndef CLOCKAPP_H
+#define CLOCKAPP_H
+
+#include "WiFiManager.h"
+#include "WebService.h"
+#include "JJYSender.h"
+#include "TimeSync.h"
+
+// 主流程：启动时连接 WiFi 并校时（时钟驯服认为还不需要校时则不开无线），之后在后台任务中发送时间码，
+// 钟表拉高 PON（校时完成）后关闭无线进入深度睡眠。
+// WiFi 连不上或 NTP 没有应答时，若误差估计不超过守时上限，按本地时钟照常发送（守时）。
+// WiFi2JJY.ino 的 setup()/loop() 只转调这里；主机模拟器用同一份逻辑。
+class ClockApp {
+public:
+    // JJYSender 对象（BACKEND_SOFTWARE 可切换回软件输出做对比）
+    // 时间码协议可改为 PROTOCOL_WWVB / PROTOCOL_DCF77 / PROTOCOL_MSF；
+    // traceVcd 为 true 时记录 DA/PON 波形，睡眠前以 VCD 格式输出到串口。
+    // 同时驱动多路不同协议/时区的钟表时改用 JJYMultiSender，例如
+    //   JJYChannelConfig channels[] = {{PIN_DA, PROTOCOL_JJY, 9 * 3600}, {5, PROTOCOL_WWVB}};
+    //   JJYMultiSender multiSender(channels, 2);
+    explicit ClockApp(JJYSender::OutputBackend backend = JJYSender::BACKEND_RMT,
+                      TimeCodeProtocol protocol = PROTOCOL_JJY, int webPort = 80,
+                      bool traceVcd = false);
+
+    // setup 时校准 DA 边沿延迟（DA 须用导线接到 capturePin）。
+    // 当前后端已有保存的补偿时跳过，结果存入 NVS 后每次发送自动应用
+    void calibrateOnBoot(int capturePin, uint32_t toleranceUs = 1000) {
+        m_calibrationPin = capturePin;
+        m_calibrationToleranceUs = toleranceUs;
+    }
+
+    // 钟表拉高 PON 后怎样结束发送（默认停在下一个整秒），在 setup 之前调用
+    void stopOnPon(JJYSender::PonStop mode) { m_jjySender.setPonStop(mode); }
+
+    // 守时允许的误差上限（微秒，默认 100ms），在 setup 之前调用
+    void setHoldoverLimit(uint32_t limitUs) { m_timeSync.setHoldoverLimit(limitUs); }
+
+    void setup();
+    void loop();
+
+    const JJYSender& jjySender() const { return m_jjySender; }
+    const TimeSync& timeSync() const { return m_timeSync; }
+
+private:
+    // WiFi管理器和Web服务器
+    WiFiManager m_wifiManager;
+    WebService m_webService;
+    JJYSender m_jjySender;
+    TimeSync m_timeSync;
+
+    // 系统状态
+    bool m_wifiConnected = false;
+    bool m_networkSkipped = false;  // 本次唤醒不需要校时，没有打开无线
+    bool m_holdover = false;        // WiFi 没连上或校时失败，按本地时钟守时
+    bool m_holdoverChecked = false; // 本次校时失败后已判断过能否守时
+    bool m_traceVcd;
+    int m_calibrationPin = -1;
+    uint32_t m_calibrationToleranceUs = 1000;
+};
+
+#endif // CLOCKAPP_H
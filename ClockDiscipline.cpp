@@ -0,0 +1,138 @@
+/*
+ * Copyright (c) 2025 Tomosawa
+ * All rights reserved.
+ *
+ * This code is part of the WiFi2JJY project.
+ * GitHub: https://github.com/Tomosawa/WIFI2JJY
+ */
+#include "ClockDiscipline.h"
+#include <stdlib.h>
+#include <string>
+#include "HAL.h"
+
+static const char* NVS_NAMESPACE = "clock-disc";
+
+static int64_t loadNumber(hal::Nvs& nvs, const char* key) {
+    return atoll(nvs.getString(key, "0").c_str());
+}
+
+void ClockDiscipline::load() {
+    hal::Nvs nvs;
+    if (!nvs.begin(NVS_NAMESPACE)) {
+        return;
+    }
+    m_frequencyPpb = loadNumber(nvs, "freq");
+    m_referenceUs = loadNumber(nvs, "ref");
+    m_appliedUs = loadNumber(nvs, "applied");
+    m_pollS = (uint32_t)loadNumber(nvs, "poll");
+    m_updates = (uint32_t)loadNumber(nvs, "updates");
+    m_wanderPpb = loadNumber(nvs, "wander");
+    m_syncErrorUs = loadNumber(nvs, "syncerr");
+    if (m_updates > 0) {
+        hal::log("[Clock] Loaded frequency correction %+.3f ppm, poll %lu s\n", m_frequencyPpb / 1000.0,
+                 (unsigned long)m_pollS);
+    }
+}
+
+bool ClockDiscipline::save() const {
+    hal::Nvs nvs;
+    if (!nvs.begin(NVS_NAMESPACE)) {
+        return false;
+    }
+    return nvs.putString("freq", std::to_string(m_frequencyPpb)) &&
+           nvs.putString("ref", std::to_string(m_referenceUs)) &&
+           nvs.putString("applied", std::to_string(m_appliedUs)) &&
+           nvs.putString("poll", std::to_string(m_pollS)) &&
+           nvs.putString("updates", std::to_string(m_updates)) &&
+           nvs.putString("wander", std::to_string(m_wanderPpb)) &&
+           nvs.putString("syncerr", std::to_string(m_syncErrorUs));
+}
+
+int64_t ClockDiscipline::pendingUs(int64_t wallUs) const {
+    if (m_appliedUs == 0 || wallUs <= m_appliedUs) {
+        return 0;
+    }
+    return (wallUs - m_appliedUs) * m_frequencyPpb / 1000000000LL;
+}
+
+void ClockDiscipline::tick(bool force) {
+    const int64_t nowUs = hal::wallTimeUs();
+    if (m_appliedUs == 0 || nowUs < m_appliedUs) {
+        return;
+    }
+    if (!force && nowUs - m_appliedUs < TICK_US) {
+        return;
+    }
+    const int64_t correctionUs = pendingUs(nowUs);
+    if (correctionUs != 0) {
+        hal::slewWallTime(correctionUs);
+    }
+    m_appliedUs = nowUs;
+}
+
+void ClockDiscipline::catchUp() {
+    const int64_t nowUs = hal::wallTimeUs();
+    if (m_appliedUs == 0 || nowUs < m_appliedUs) {
+        return;
+    }
+    const int64_t correctionUs = pendingUs(nowUs);
+    if (correctionUs != 0) {
+        hal::setWallTimeUs(hal::wallTimeUs() + correctionUs);
+    }
+    m_appliedUs = nowUs + correctionUs;
+}
+
+void ClockDiscipline::update(int64_t wallUs, int64_t offsetUs, int64_t errorUs, bool stepped) {
+    const int64_t intervalUs = wallUs - m_referenceUs;
+    if (stepped) {
+        // 挂钟跳变，间隔内的偏差不可信；频率保留，但要重新确认
+        if (m_referenceUs != 0) {
+            m_pollS = 0;
+        }
+    } else if (m_referenceUs != 0 && intervalUs >= MIN_INTERVAL_US) {
+        // 残差：假如频率修正都已应用，本地时钟还差多少
+        const int64_t residualUs = offsetUs - pendingUs(wallUs);
+        const int64_t residualPpb = residualUs * 1000000000LL / intervalUs;
+        // 第一次直接采用，之后只修正一半，平滑测量噪声
+        int64_t frequencyPpb = m_frequencyPpb + (m_updates == 0 ? residualPpb : residualPpb / 2);
+        if (frequencyPpb > MAX_FREQUENCY_PPB) {
+            frequencyPpb = MAX_FREQUENCY_PPB;
+        } else if (frequencyPpb < -MAX_FREQUENCY_PPB) {
+            frequencyPpb = -MAX_FREQUENCY_PPB;
+        }
+        m_frequencyPpb = frequencyPpb;
+        m_wanderPpb = llabs(residualPpb);
+        m_updates++;
+
+        if (llabs(residualUs) > ACCURACY_US) {
+            m_pollS = m_pollS / 2 >= MIN_POLL_S ? m_pollS / 2 : 0;
+        } else if (m_updates >= 2 && llabs(residualUs) <= ACCURACY_US / 2) {
+            m_pollS = m_pollS == 0 ? MIN_POLL_S : (m_pollS * 2 <= MAX_POLL_S ? m_pollS * 2 : MAX_POLL_S);
+        }
+        hal::log("[Clock] Residual %+lld us over %lld s, frequency correction %+.3f ppm, poll %lu s\n",
+                 (long long)residualUs, (long long)(intervalUs / 1000000LL), m_frequencyPpb / 1000.0,
+                 (unsigned long)m_pollS);
+    }
+    m_referenceUs = wallUs + offsetUs;
+    m_appliedUs = m_referenceUs;
+    m_syncErrorUs = errorUs;
+}
+
+int64_t ClockDiscipline::estimatedErrorUs(int64_t wallUs) const {
+    if (m_referenceUs == 0 || wallUs < m_referenceUs) {
+        return INT64_MAX;
+    }
+    int64_t wanderPpb = m_updates == 0 ? UNLEARNED_WANDER_PPB : m_wanderPpb;
+    if (wanderPpb < MIN_WANDER_PPB) {
+        wanderPpb = MIN_WANDER_PPB;
+    }
+    return m_syncErrorUs + (wallUs - m_referenceUs) * wanderPpb / 1000000000LL;
+}
+
+bool ClockDiscipline::syncDue() const {
+    if (m_pollS == 0 || m_referenceUs == 0) {
+        return true;
+    }
+    const int64_t nowUs = hal::wallTimeUs();
+    return nowUs < m_referenceUs || nowUs - m_referenceUs >= (int64_t)m_pollS * 1000000LL;
+}
@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) 2025 Tomosawa
+ * All rights reserved.
+ *
+ * This code is part of the WiFi2JJY project.
+ * GitHub: https://github.com/Tomosawa/WIFI2JJY
+ */
+#ifndef CLOCKDISCIPLINE_H
+#define CLOCKDISCIPLINE_H
+
+#include <stdint.h>
+
+// 时钟驯服（FLL）：两次 NTP 校时之间本地时钟累积的偏差除以间隔，就是
+// 晶振（和深度睡眠时 RTC 慢时钟）的频率误差。学到的频率修正 frequencyPpb
+// 按经过的挂钟时长换算成微秒，用 hal::slewWallTime 渐进加到挂钟上，不步进。
+// 相位偏差仍由每次 NTP 校时消除，这里只管频率。
+//
+// 频率稳定后，校时时的残差越来越小，校时间隔 pollIntervalS 按 NTP 的做法
+// 翻倍（残差超过目标时减半），唤醒时没到间隔就不连 WiFi，直接按本地时钟发送。
+// 频率、参考时刻和间隔保存在 NVS 命名空间 "clock-disc"，跨深度睡眠和重启。
+//
+// 误差估计：上次校时的误差上界，加上距上次校时的时长 × 频率的不确定度。
+// 不确定度取最近一次频率更新的修正量（不小于 1ppm），频率还没学到时按 100ppm 算。
+// 网络不可用时据此判断能否继续按本地时钟发送（守时）。
+class ClockDiscipline {
+public:
+    static constexpr int64_t MAX_FREQUENCY_PPB = 500000;  // ±500ppm，超出的测量视为异常
+    static constexpr int64_t ACCURACY_US = 10000;         // 校时残差目标，超出时缩短间隔
+    static constexpr uint32_t MIN_POLL_S = 1024;
+    static constexpr uint32_t MAX_POLL_S = 16384;
+    static constexpr int64_t MIN_INTERVAL_US = 60LL * 1000000LL;  // 间隔太短时残差主要是测量噪声
+    static constexpr int64_t TICK_US = 16LL * 1000000LL;          // tick 最短间隔
+    static constexpr int64_t MIN_WANDER_PPB = 1000;        // 频率不确定度下限（温度变化等）
+    static constexpr int64_t UNLEARNED_WANDER_PPB = 100000;
+
+    // 从 NVS 载入，没有保存过时从零开始
+    void load();
+    // 保存到 NVS（校时后和深度睡眠前调用）
+    bool save() const;
+
+    // 把上次应用以来的频率修正渐进加到挂钟上；距上次不足 TICK_US 且 force 为 false 时不做
+    void tick(bool force = false);
+    // 同上但直接步进：唤醒后还没有任何东西在用挂钟，睡眠期间积累的修正不必等渐进调整走完
+    void catchUp();
+
+    // 一次 NTP 测量：wallUs 为测量时的本地挂钟，offsetUs 为服务器 - 本地，errorUs 为其误差上界，
+    // 挂钟随后会被步进（stepped）或渐进调整 offsetUs。更新频率和校时间隔，以校正后的挂钟为新的参考
+    void update(int64_t wallUs, int64_t offsetUs, int64_t errorUs, bool stepped);
+
+    // 挂钟为 wallUs 时的误差上界估计（微秒），从没校时过为 INT64_MAX
+    int64_t estimatedErrorUs(int64_t wallUs) const;
+
+    // 是否该做 NTP 校时：频率还没学到、挂钟未设置，或距上次校时已超过间隔
+    bool syncDue() const;
+
+    int64_t frequencyPpb() const { return m_frequencyPpb; }
+    uint32_t pollIntervalS() const { return m_pollS; }
+    // 上次 NTP 校时的挂钟时刻（未校时为0）
+    int64_t referenceUs() const { return m_referenceUs; }
+    // 频率已至少更新过一次
+    bool learned() const { return m_updates > 0; }
+
+private:
+    int64_t m_frequencyPpb = 0;
+    int64_t m_referenceUs = 0;
+    int64_t m_appliedUs = 0;  // 频率修正已应用到的挂钟时刻
+    uint32_t m_pollS = 0;     // 0 为每次唤醒都校时
+    uint32_t m_updates = 0;
+    int64_t m_wanderPpb = 0;   // 最近一次频率更新的修正量
+    int64_t m_syncErrorUs = 0; // 上次校时的误差上界
+
+    // 从 m_appliedUs 到 wallUs 应加的修正
+    int64_t pendingUs(int64_t wallUs) const;
+};
+
+#endif // CLOCKDISCIPLINE_H
@@ -0,0 +1,62 @@
+/*
+ * Copyright (c) 2025 Tomosawa
+ * All rights reserved.
+ *
+ * This code is part of the WiFi2JJY project.
+ * GitHub: https://github.com/Tomosawa/WIFI2JJY
+ */
+#ifndef FASTPIN_H
+#define FASTPIN_H
+
+#include <Arduino.h>
+#include "driver/gpio.h"
+#include "soc/gpio_reg.h"
+#include "soc/soc.h"
+
+// 输出引脚策略：begin(idleLevel) 配置为输出并置于协议的空闲电平，外设配置失败时返回 false；
+// write(level) 设置电平，可在中断上下文中调用
+
+// 编译期已知的引脚：置位/清零各是一条 W1TS/W1TC 寄存器写
+template<gpio_num_t Pin>
+struct FastPin {
+    static_assert(Pin >= 0 && Pin < 32, "FastPin only covers GPIO0-31");
+    static constexpr uint32_t MASK = 1UL << Pin;
+
+    bool begin(uint8_t idleLevel) const {
+        pinMode(Pin, OUTPUT);
+        write(idleLevel);
+        return true;
+    }
+
+    __attribute__((always_inline)) static inline void high() {
+        REG_WRITE(GPIO_OUT_W1TS_REG, MASK);
+    }
+
+    __attribute__((always_inline)) static inline void low() {
+        REG_WRITE(GPIO_OUT_W1TC_REG, MASK);
+    }
+
+    __attribute__((always_inline)) static inline void write(uint8_t level) {
+        REG_WRITE(level ? GPIO_OUT_W1TS_REG : GPIO_OUT_W1TC_REG, MASK);
+    }
+};
+
+// 运行时指定的引脚，走 gpio_set_level
+struct RuntimePin {
+    explicit RuntimePin(int pin) : m_pin((gpio_num_t)pin) {}
+
+    bool begin(uint8_t idleLevel) const {
+        pinMode(m_pin, OUTPUT);
+        write(idleLevel);
+        return true;
+    }
+
+    void write(uint8_t level) const {
+        gpio_set_level(m_pin, level);
+    }
+
+private:
+    gpio_num_t m_pin;
+};
+
+#endif // FASTPIN_H
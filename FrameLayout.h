@@ -0,0 +1,216 @@
+/*
+ * Copyright (c) 2025 Tomosawa
+ * All rights reserved.
+ *
+ * This code is part of the WiFi2JJY project.
+ * GitHub: https://github.com/Tomosawa/WIFI2JJY
+ */
+#ifndef FRAMELAYOUT_H
+#define FRAMELAYOUT_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <time.h>
+#include <initializer_list>
+#include <tuple>
+#include <utility>
+
+// 时间码帧布局模板
+// 一帧60秒，第 s 秒对应64位掩码的第 (63 - s) 位：先发送的秒落在高位，
+// 因此时间上高位在前的字段只需一次移位即可写入。
+// 布局在编译期展开成固定的移位/常数除法，运行时不再解释布局。
+
+constexpr uint64_t frameSecondBit(int second) {
+    return 1ULL << (63 - second);
+}
+
+// 宽度为 width、最高位位于第 msbSecond 秒的位组的移位量
+constexpr int frameFieldShift(int msbSecond, int width) {
+    return 64 - msbSecond - width;
+}
+
+// 检查一组掩码两两不重叠
+constexpr bool masksDisjoint(std::initializer_list<uint64_t> masks) {
+    uint64_t seen = 0;
+    for (uint64_t mask : masks) {
+        if (seen & mask) return false;
+        seen |= mask;
+    }
+    return true;
+}
+
+// 连续位组：最高位位于第 Msb 秒，共 Width 位
+template<int Msb, int Width>
+struct BitGroup {
+    static_assert(Width > 0 && Width <= 8, "bit group width out of range");
+    static_assert(Msb >= 0 && Msb + Width <= 60, "bit group outside the 60-second frame");
+
+    static constexpr int SHIFT = frameFieldShift(Msb, Width);
+    static constexpr uint64_t MASK = ((1ULL << Width) - 1) << SHIFT;
+
+    // 超出 Width 位的部分被截掉，不会写进相邻的秒
+    static constexpr uint64_t place(uint32_t digit) {
+        return (uint64_t)(digit & ((1U << Width) - 1)) << SHIFT;
+    }
+};
+
+// 把 width 位的 value 按位倒序
+constexpr uint32_t reverseBits(uint32_t value, int width) {
+    uint32_t result = 0;
+    for (int i = 0; i < width; i++) {
+        result = (result << 1) | ((value >> i) & 1U);
+    }
+    return result;
+}
+
+// Width 位数值的倒序表
+template<int Width>
+struct ReversedDigits {
+    uint8_t bits[1 << Width];
+
+    constexpr ReversedDigits() : bits() {
+        for (uint32_t value = 0; value < (1U << Width); value++) {
+            bits[value] = (uint8_t)reverseBits(value, Width);
+        }
+    }
+};
+
+// 低位在前的连续位组（DCF77）：最低位位于第 Lsb 秒，共 Width 位。
+// 写入时查表倒序后与 BitGroup 一样一次移位
+template<int Lsb, int Width>
+struct LsbFirstBitGroup {
+    using Group = BitGroup<Lsb, Width>;
+    static constexpr uint64_t MASK = Group::MASK;
+    static constexpr ReversedDigits<Width> REVERSED{};
+
+    static uint64_t place(uint32_t digit) {
+        return Group::place(REVERSED.bits[digit & ((1U << Width) - 1)]);
+    }
+};
+
+// 按 Radix 进制拆分数位的字段，Groups 从最高位数字排到个位
+template<uint32_t Radix, class... Groups>
+struct DigitField {
+    static constexpr size_t COUNT = sizeof...(Groups);
+    static constexpr uint64_t MASK = (Groups::MASK | ...);
+    static_assert(masksDisjoint({Groups::MASK...}), "digit groups overlap");
+
+    static uint64_t encode(uint32_t value) {
+        return encodeDigits(value, std::make_index_sequence<COUNT>{});
+    }
+
+private:
+    static constexpr uint32_t weight(size_t digit) {
+        return digit == 0 ? 1 : Radix * weight(digit - 1);
+    }
+
+    template<size_t... I>
+    static uint64_t encodeDigits(uint32_t value, std::index_sequence<I...>) {
+        return (std::tuple_element_t<I, std::tuple<Groups...>>::place(
+                    (value / weight(COUNT - 1 - I)) % Radix) | ...);
+    }
+};
+
+// BCD 字段
+template<class... Groups>
+using BcdField = DigitField<10, Groups...>;
+
+// 直接二进制字段
+template<class Group>
+struct BinaryField {
+    static constexpr uint64_t MASK = Group::MASK;
+
+    static uint64_t encode(uint32_t value) {
+        return Group::place(value);
+    }
+};
+
+// 字段与时间来源的绑定，Source::get 从 struct tm 取出字段值
+template<class Encoding, class Source>
+struct Field {
+    static constexpr uint64_t MASK = Encoding::MASK;
+
+    static uint64_t encode(const struct tm* timeinfo) {
+        return Encoding::encode(Source::get(timeinfo));
+    }
+};
+
+// 第 Second 秒的偶校验位，覆盖 Fields 的全部数据位
+template<int Second, class... Fields>
+struct EvenParity {
+    static constexpr uint64_t MASK = frameSecondBit(Second);
+    static constexpr uint64_t COVER = (Fields::MASK | ...);
+    static_assert((COVER & MASK) == 0, "parity bit inside its own coverage");
+
+    static uint64_t encode(uint64_t data) {
+        return (uint64_t)(__builtin_popcountll(data & COVER) & 1) << (63 - Second);
+    }
+};
+
+// 第 Second 秒的奇校验位（MSF）：连同校验位在内 1 的个数为奇数
+template<int Second, class... Fields>
+struct OddParity {
+    static constexpr uint64_t MASK = frameSecondBit(Second);
+    static constexpr uint64_t COVER = (Fields::MASK | ...);
+    static_assert((COVER & MASK) == 0, "parity bit inside its own coverage");
+
+    static uint64_t encode(uint64_t data) {
+        return (uint64_t)((__builtin_popcountll(data & COVER) & 1) ^ 1) << (63 - Second);
+    }
+};
+
+template<class... Fields> struct FieldList {};
+template<class... Parities> struct ParityList {};
+
+// 一组秒的掩码
+template<int... Seconds>
+struct SecondList {
+    static constexpr uint64_t MASK = (0ULL | ... | frameSecondBit(Seconds));
+};
+
+// 位置标记所在的秒
+template<int... Seconds>
+using MarkerList = SecondList<Seconds...>;
+
+// 计算 Parities 的全部校验位，校验位可以写在与数据不同的位平面上
+template<class... Parities>
+inline uint64_t encodeParities(ParityList<Parities...>, [[maybe_unused]] uint64_t data) {
+    return (0ULL | ... | Parities::encode(data));
+}
+
+// 布局中的字段、校验位与标记互不重叠
+template<class... Fields, class... Parities, class Markers>
+constexpr bool layoutDisjoint(FieldList<Fields...>, ParityList<Parities...>, Markers) {
+    return masksDisjoint({Markers::MASK, Fields::MASK..., Parities::MASK...});
+}
+
+// 由布局生成的编码器：Layout 需提供 Fields / Parities / Markers
+template<class Layout>
+struct FrameEncoder {
+    static_assert(layoutDisjoint(typename Layout::Fields{}, typename Layout::Parities{},
+                                 typename Layout::Markers{}),
+                  "frame layout fields overlap");
+
+    static uint64_t encode(const struct tm* timeinfo) {
+        return encode(typename Layout::Fields{}, typename Layout::Parities{}, timeinfo);
+    }
+
+private:
+    template<class... Fields, class... Parities>
+    static uint64_t encode(FieldList<Fields...>, ParityList<Parities...>, const struct tm* timeinfo) {
+        const uint64_t data = (0ULL | ... | Fields::encode(timeinfo));
+        return data | encodeParities(ParityList<Parities...>{}, data);
+    }
+};
+
+// struct tm 字段来源
+struct TmMinute    { static uint32_t get(const struct tm* t) { return t->tm_min; } };
+struct TmHour      { static uint32_t get(const struct tm* t) { return t->tm_hour; } };
+struct TmDayOfYear { static uint32_t get(const struct tm* t) { return t->tm_yday + 1; } };  // tm_yday从0开始
+struct TmYear2     { static uint32_t get(const struct tm* t) { return (t->tm_year + 1900) % 100; } };
+struct TmWeekDay   { static uint32_t get(const struct tm* t) { return t->tm_wday; } };  // 0=星期日
+struct TmIsoWeekDay { static uint32_t get(const struct tm* t) { return t->tm_wday ? t->tm_wday : 7; } };  // 1=星期一 ... 7=星期日
+struct TmMonthDay  { static uint32_t get(const struct tm* t) { return t->tm_mday; } };
+struct TmMonth     { static uint32_t get(const struct tm* t) { return t->tm_mon + 1; } };  // tm_mon从0开始
+
+#endif // FRAMELAYOUT_H
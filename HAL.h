@@ -0,0 +1,271 @@
+/*
+ * Copyright (c) 2025 Tomosawa
+ * All rights reserved.
+ *
+ * This code is part of the WiFi2JJY project.
+ * GitHub: https://github.com/Tomosawa/WIFI2JJY
+ */
+#ifndef HAL_H
+#define HAL_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <functional>
+#include <string>
+
+// 硬件抽象层：上层模块（TimeSync、WiFiManager、WebService、发送流程）只通过这里
+// 访问 GPIO、时钟、定时器、NVS 和网络，不直接调用 Arduino / ESP-IDF。
+// HALEsp32.cpp 是固件实现，host/HALLinux.cpp 是主机实现（CMake 主机构建使用）。
+namespace hal {
+
+// ---- 日志 ----
+
+// printf 风格输出一行日志（固件为串口，主机为标准输出），不自动换行
+void log(const char* format, ...) __attribute__((format(printf, 1, 2)));
+// 原样输出一段数据（例如 VCD 记录）
+void logWrite(const char* data, size_t length);
+
+// ---- GPIO ----
+
+// 配置为输出并立即输出 level
+void pinOutput(int pin, bool level);
+void pinInput(int pin);
+void pinWrite(int pin, bool level);
+bool pinRead(int pin);
+
+// 输入引脚电平变化时调用 handler（固件中在中断里调用，monoUs 为变化时的单调时钟）。
+// handler 为 nullptr 时停止捕获
+typedef void (*PinEdgeHandler)(void* arg, bool level, int64_t monoUs);
+bool pinCapture(int pin, PinEdgeHandler handler, void* arg);
+
+// ---- 单调时钟 ----
+
+// 启动后经过的微秒数（esp_timer / CLOCK_MONOTONIC），不受校时影响
+int64_t monotonicUs();
+uint32_t monotonicMs();
+void sleepMs(uint32_t ms);
+// 阻塞到单调时钟到达 targetUs（固件为粗等加自旋，精度为微秒级）
+void waitUntilUs(int64_t targetUs);
+// 自旋等待时让出处理器
+void yield();
+
+// ---- 挂钟 ----
+
+// 当前挂钟时间（UTC 微秒），NTP 校时后会被步进或渐进调整
+int64_t wallTimeUs();
+
+// 把挂钟立即设为 wallUs（settimeofday）
+void setWallTimeUs(int64_t wallUs);
+// 渐进调整挂钟 deltaUs（adjtime：挂钟暂时走快或走慢，不跳变），叠加在尚未完成的调整上
+void slewWallTime(int64_t deltaUs);
+
+// 设置本地时区（UTC 偏移秒数，东为正），影响 localtime
+void setUtcOffset(long utcOffset);
+
+// ---- 任务 ----
+
+// 启动一个后台任务，fn 返回后任务自动结束
+bool startTask(void (*fn)(void*), const char* name, uint32_t stackBytes, void* arg, int priority);
+
+// ---- 同步 ----
+
+// 无限等待
+constexpr uint32_t WAIT_FOREVER = 0xFFFFFFFFU;
+
+// 计数信号量（任务之间使用；中断中只能 giveFromIsr）
+class Semaphore {
+public:
+    Semaphore(uint32_t maxCount, uint32_t initialCount);
+    ~Semaphore();
+
+    void give();
+    // 在中断中 give，必要时在中断返回时切换到被唤醒的任务（主机构建同 give）
+    void giveFromIsr();
+    // 在超时（毫秒，WAIT_FOREVER 为无限）前取到返回 true
+    bool take(uint32_t timeoutMs);
+
+private:
+    struct Impl;
+    Impl* m_impl;
+
+    Semaphore(const Semaphore&) = delete;
+    Semaphore& operator=(const Semaphore&) = delete;
+};
+
+// ---- 定时器 ----
+
+// 一次性定时器，到点后在定时器任务（不是中断）中调用回调
+class OneShotTimer {
+public:
+    typedef void (*Callback)(void* arg);
+
+    OneShotTimer(Callback callback, void* arg, const char* name);
+    ~OneShotTimer();
+
+    bool start(int64_t delayUs);
+    void stop();
+
+private:
+    struct Impl;
+    Impl* m_impl;
+
+    OneShotTimer(const OneShotTimer&) = delete;
+    OneShotTimer& operator=(const OneShotTimer&) = delete;
+};
+
+// 二值事件：signal 可在定时器回调中调用，wait 在超时前等到信号返回 true
+class Event {
+public:
+    Event();
+    ~Event();
+
+    void signal();
+    bool wait(uint32_t timeoutMs);
+
+private:
+    struct Impl;
+    Impl* m_impl;
+
+    Event(const Event&) = delete;
+    Event& operator=(const Event&) = delete;
+};
+
+// ---- NVS ----
+
+// 按命名空间分组的键值存储（固件为 Preferences，主机为目录下每键一个文件）
+class Nvs {
+public:
+    Nvs();
+    ~Nvs();
+
+    bool begin(const char* nameSpace);
+    std::string getString(const char* key, const char* defaultValue = "");
+    bool putString(const char* key, const std::string& value);
+    bool remove(const char* key);
+
+private:
+    struct Impl;
+    Impl* m_impl;
+
+    Nvs(const Nvs&) = delete;
+    Nvs& operator=(const Nvs&) = delete;
+};
+
+// ---- 网络 ----
+
+enum NetStatus {
+    NET_IDLE,
+    NET_NO_SSID_AVAIL,
+    NET_SCAN_COMPLETED,
+    NET_CONNECTED,
+    NET_CONNECT_FAILED,
+    NET_CONNECTION_LOST,
+    NET_DISCONNECTED,
+    NET_UNKNOWN
+};
+
+// 扫描到的一个网络
+struct ScanEntry {
+    std::string ssid;
+    int rssi;
+    const char* encryption;  // "Open"、"WPA2" 等
+};
+
+// 打开无线并切换到 AP+STA 模式
+void netBegin();
+
+// 启动 AP，地址固定为 192.168.1.1
+void netStartAccessPoint(const char* ssid, const char* password);
+std::string netAccessPointIP();
+
+// 发起 STA 连接，立即返回
+void netConnect(const char* ssid, const char* password);
+NetStatus netStatus();
+// STA 的 IP 地址，未连接时为空
+std::string netLocalIP();
+
+// 异步扫描；netScanComplete 返回 -1 表示仍在扫描，-2 表示失败，否则为网络数量
+void netStartScan();
+int netScanComplete();
+bool netScanEntry(int index, ScanEntry& entry);
+
+// 断开并关闭无线（休眠前调用）
+void netShutdown();
+
+// 解析主机名（或点分地址）为 IPv4 地址，a.b.c.d 对应 0xaabbccdd
+bool netResolve(const char* host, uint32_t& address);
+
+// UDP 套接字，绑定任意本地端口
+class UdpSocket {
+public:
+    UdpSocket();
+    ~UdpSocket();
+
+    bool open();
+    bool sendTo(uint32_t address, uint16_t port, const void* data, size_t length);
+    // 最多等待 timeoutMs 收一个数据报，返回长度（超时或出错为 -1）；
+    // monoUs 为收到时的单调时钟，from 为来源地址
+    int receive(void* buffer, size_t size, uint32_t timeoutMs, int64_t& monoUs, uint32_t& from);
+
+private:
+    struct Impl;
+    Impl* m_impl;
+
+    UdpSocket(const UdpSocket&) = delete;
+    UdpSocket& operator=(const UdpSocket&) = delete;
+};
+
+// ---- HTTP 服务 ----
+
+enum HttpMethod {
+    HTTP_METHOD_ANY,
+    HTTP_METHOD_GET,
+    HTTP_METHOD_POST
+};
+
+// 单连接的轻量 HTTP 服务，路由回调在 handleClient 内同步执行
+class HttpServer {
+public:
+    typedef std::function<void()> Handler;
+
+    explicit HttpServer(int port);
+    ~HttpServer();
+
+    void on(const char* path, HttpMethod method, Handler handler);
+    void onNotFound(Handler handler);
+    void begin();
+    void stop();
+
+    // 监听端口（构造时为0则在 begin 后由系统分配）
+    int port() const;
+
+    // 处理一个待处理的请求（没有时立即返回）
+    void handleClient();
+
+    // 当前请求的查询参数或表单字段
+    std::string arg(const char* name);
+
+    // 以下在路由回调内调用：追加响应头并发送响应，或直接写原始字节（含状态行）
+    void sendHeader(const char* name, const char* value);
+    void send(int code, const char* contentType, const std::string& content);
+    void sendRaw(const char* data, size_t length);
+
+private:
+    struct Impl;
+    Impl* m_impl;
+
+    HttpServer(const HttpServer&) = delete;
+    HttpServer& operator=(const HttpServer&) = delete;
+};
+
+// ---- 系统 ----
+
+// 重启（主机实现为退出进程）
+void restart();
+
+// 进入深度睡眠，wakePin 变为低电平时唤醒并从头启动，不返回
+[[noreturn]] void deepSleep(int wakePin);
+
+}  // namespace hal
+
+#endif // HAL_H
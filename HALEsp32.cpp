@@ -0,0 +1,536 @@
+/*
+ * Copyright (c) 2025 Tomosawa
+ * All rights reserved.
+ *
+ * This code is part of the WiFi2JJY project.
+ * GitHub: https://github.com/Tomosawa/WIFI2JJY
+ */
+#include "HAL.h"
+#include <Arduino.h>
+#include <WiFi.h>
+#include <WebServer.h>
+#include <Preferences.h>
+#include <stdarg.h>
+#include <sys/time.h>
+#include "esp_timer.h"
+#include "lwip/netdb.h"
+#include "lwip/sockets.h"
+#include "esp_sleep.h"
+#include "driver/gpio.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+
+// ESP32 实现：Arduino-ESP32 与 ESP-IDF 的薄封装
+namespace hal {
+
+void log(const char* format, ...) {
+    char buffer[256];
+    va_list args;
+    va_start(args, format);
+    int length = vsnprintf(buffer, sizeof(buffer), format, args);
+    va_end(args);
+    if (length < (int)sizeof(buffer)) {
+        Serial.print(buffer);
+        return;
+    }
+
+    // 超长的行在堆上重新格式化
+    char* line = new char[length + 1];
+    va_start(args, format);
+    vsnprintf(line, length + 1, format, args);
+    va_end(args);
+    Serial.print(line);
+    delete[] line;
+}
+
+void logWrite(const char* data, size_t length) {
+    Serial.write(reinterpret_cast<const uint8_t*>(data), length);
+}
+
+void pinOutput(int pin, bool level) {
+    pinMode(pin, OUTPUT);
+    digitalWrite(pin, level ? HIGH : LOW);
+}
+
+void pinInput(int pin) {
+    pinMode(pin, INPUT);
+}
+
+void pinWrite(int pin, bool level) {
+    digitalWrite(pin, level ? HIGH : LOW);
+}
+
+bool pinRead(int pin) {
+    return digitalRead(pin) != 0;
+}
+
+struct CaptureSlot {
+    PinEdgeHandler handler;
+    void* arg;
+};
+
+static CaptureSlot s_captures[GPIO_NUM_MAX];
+
+static void IRAM_ATTR onPinEdge(void* arg) {
+    const int pin = (int)(intptr_t)arg;
+    const int64_t nowUs = esp_timer_get_time();
+    const CaptureSlot& slot = s_captures[pin];
+    if (slot.handler != nullptr) {
+        slot.handler(slot.arg, gpio_get_level((gpio_num_t)pin) != 0, nowUs);
+    }
+}
+
+bool pinCapture(int pin, PinEdgeHandler handler, void* arg) {
+    if (pin < 0 || pin >= GPIO_NUM_MAX) {
+        return false;
+    }
+    if (handler == nullptr) {
+        detachInterrupt(pin);
+        s_captures[pin] = {nullptr, nullptr};
+        return true;
+    }
+    s_captures[pin] = {handler, arg};
+    pinMode(pin, INPUT);
+    attachInterruptArg(pin, onPinEdge, (void*)(intptr_t)pin, CHANGE);
+    return true;
+}
+
+int64_t monotonicUs() {
+    return esp_timer_get_time();
+}
+
+uint32_t monotonicMs() {
+    return millis();
+}
+
+void sleepMs(uint32_t ms) {
+    delay(ms);
+}
+
+void waitUntilUs(int64_t targetUs) {
+    // 先粗略等待，剩余不到10ms时自旋
+    int64_t remainingUs = targetUs - esp_timer_get_time();
+    if (remainingUs > 10000) {
+        delay((remainingUs - 10000) / 1000);
+    }
+    while (esp_timer_get_time() < targetUs) {
+        ::yield();
+    }
+}
+
+void yield() {
+    ::yield();
+}
+
+int64_t wallTimeUs() {
+    struct timeval tv;
+    gettimeofday(&tv, nullptr);
+    return (int64_t)tv.tv_sec * 1000000LL + tv.tv_usec;
+}
+
+static struct timeval toTimeval(int64_t us) {
+    struct timeval tv;
+    tv.tv_sec = (time_t)(us / 1000000LL);
+    tv.tv_usec = (suseconds_t)(us % 1000000LL);
+    if (tv.tv_usec < 0) {
+        tv.tv_sec -= 1;
+        tv.tv_usec += 1000000;
+    }
+    return tv;
+}
+
+void setWallTimeUs(int64_t wallUs) {
+    struct timeval tv = toTimeval(wallUs);
+    settimeofday(&tv, nullptr);
+}
+
+void slewWallTime(int64_t deltaUs) {
+    // newlib 按经过时间的 1/64 逐渐修正；新的调整会替换未完成的部分，先取出来加上
+    struct timeval outstanding = {};
+    adjtime(nullptr, &outstanding);
+    struct timeval tv = toTimeval(deltaUs + (int64_t)outstanding.tv_sec * 1000000LL + outstanding.tv_usec);
+    adjtime(&tv, nullptr);
+}
+
+void setUtcOffset(long utcOffset) {
+    // POSIX TZ 的符号与 UTC 偏移相反：东8区写作 UTC-8
+    char tz[24];
+    long magnitude = utcOffset < 0 ? -utcOffset : utcOffset;
+    snprintf(tz, sizeof(tz), "UTC%c%ld:%02ld", utcOffset > 0 ? '-' : '+', magnitude / 3600,
+             (magnitude % 3600) / 60);
+    setenv("TZ", tz, 1);
+    tzset();
+}
+
+// ---- 任务 ----
+
+struct TaskStart {
+    void (*fn)(void*);
+    void* arg;
+};
+
+static void taskTrampoline(void* param) {
+    TaskStart start = *static_cast<TaskStart*>(param);
+    delete static_cast<TaskStart*>(param);
+    start.fn(start.arg);
+    vTaskDelete(nullptr);
+}
+
+bool startTask(void (*fn)(void*), const char* name, uint32_t stackBytes, void* arg, int priority) {
+    TaskStart* start = new TaskStart{fn, arg};
+    if (xTaskCreate(taskTrampoline, name, stackBytes, start, priority, nullptr) != pdPASS) {
+        delete start;
+        return false;
+    }
+    return true;
+}
+
+// ---- 同步 ----
+
+static TickType_t toTicks(uint32_t timeoutMs) {
+    return timeoutMs == WAIT_FOREVER ? portMAX_DELAY : pdMS_TO_TICKS(timeoutMs);
+}
+
+struct Semaphore::Impl {
+    SemaphoreHandle_t semaphore;
+};
+
+Semaphore::Semaphore(uint32_t maxCount, uint32_t initialCount) : m_impl(new Impl) {
+    m_impl->semaphore = xSemaphoreCreateCounting(maxCount, initialCount);
+}
+
+Semaphore::~Semaphore() {
+    if (m_impl->semaphore != nullptr) {
+        vSemaphoreDelete(m_impl->semaphore);
+    }
+    delete m_impl;
+}
+
+void Semaphore::give() {
+    xSemaphoreGive(m_impl->semaphore);
+}
+
+void IRAM_ATTR Semaphore::giveFromIsr() {
+    BaseType_t woken = pdFALSE;
+    xSemaphoreGiveFromISR(m_impl->semaphore, &woken);
+    if (woken == pdTRUE) {
+        portYIELD_FROM_ISR();
+    }
+}
+
+bool Semaphore::take(uint32_t timeoutMs) {
+    return xSemaphoreTake(m_impl->semaphore, toTicks(timeoutMs)) == pdTRUE;
+}
+
+// ---- 定时器 ----
+
+struct OneShotTimer::Impl {
+    esp_timer_handle_t handle = nullptr;
+};
+
+OneShotTimer::OneShotTimer(Callback callback, void* arg, const char* name) : m_impl(new Impl) {
+    esp_timer_create_args_t args = {
+        .callback = callback,
+        .arg = arg,
+        .dispatch_method = ESP_TIMER_TASK, // 任务上下文，允许使用 FreeRTOS API
+        .name = name
+    };
+    if (esp_timer_create(&args, &m_impl->handle) != ESP_OK) {
+        m_impl->handle = nullptr;
+    }
+}
+
+OneShotTimer::~OneShotTimer() {
+    if (m_impl->handle != nullptr) {
+        esp_timer_stop(m_impl->handle);
+        esp_timer_delete(m_impl->handle);
+    }
+    delete m_impl;
+}
+
+bool OneShotTimer::start(int64_t delayUs) {
+    if (m_impl->handle == nullptr) {
+        return false;
+    }
+    esp_timer_stop(m_impl->handle);
+    return esp_timer_start_once(m_impl->handle, delayUs) == ESP_OK;
+}
+
+void OneShotTimer::stop() {
+    if (m_impl->handle != nullptr) {
+        esp_timer_stop(m_impl->handle);
+    }
+}
+
+struct Event::Impl {
+    SemaphoreHandle_t semaphore;
+};
+
+Event::Event() : m_impl(new Impl) {
+    m_impl->semaphore = xSemaphoreCreateBinary();
+}
+
+Event::~Event() {
+    if (m_impl->semaphore != nullptr) {
+        vSemaphoreDelete(m_impl->semaphore);
+    }
+    delete m_impl;
+}
+
+void Event::signal() {
+    xSemaphoreGive(m_impl->semaphore);
+}
+
+bool Event::wait(uint32_t timeoutMs) {
+    return xSemaphoreTake(m_impl->semaphore, toTicks(timeoutMs)) == pdTRUE;
+}
+
+// ---- NVS ----
+
+struct Nvs::Impl {
+    Preferences preferences;
+};
+
+Nvs::Nvs() : m_impl(new Impl) {
+}
+
+Nvs::~Nvs() {
+    m_impl->preferences.end();
+    delete m_impl;
+}
+
+bool Nvs::begin(const char* nameSpace) {
+    return m_impl->preferences.begin(nameSpace, false);
+}
+
+std::string Nvs::getString(const char* key, const char* defaultValue) {
+    return m_impl->preferences.getString(key, defaultValue).c_str();
+}
+
+bool Nvs::putString(const char* key, const std::string& value) {
+    return m_impl->preferences.putString(key, value.c_str()) == value.length();
+}
+
+bool Nvs::remove(const char* key) {
+    return m_impl->preferences.remove(key);
+}
+
+// ---- 网络 ----
+
+void netBegin() {
+    WiFi.mode(WIFI_AP_STA);
+}
+
+void netStartAccessPoint(const char* ssid, const char* password) {
+    WiFi.softAPConfig(IPAddress(192, 168, 1, 1), IPAddress(192, 168, 1, 1), IPAddress(255, 255, 255, 0));
+    WiFi.softAP(ssid, password);
+}
+
+std::string netAccessPointIP() {
+    return WiFi.softAPIP().toString().c_str();
+}
+
+void netConnect(const char* ssid, const char* password) {
+    WiFi.begin(ssid, password);
+}
+
+NetStatus netStatus() {
+    switch (WiFi.status()) {
+        case WL_IDLE_STATUS: return NET_IDLE;
+        case WL_NO_SSID_AVAIL: return NET_NO_SSID_AVAIL;
+        case WL_SCAN_COMPLETED: return NET_SCAN_COMPLETED;
+        case WL_CONNECTED: return NET_CONNECTED;
+        case WL_CONNECT_FAILED: return NET_CONNECT_FAILED;
+        case WL_CONNECTION_LOST: return NET_CONNECTION_LOST;
+        case WL_DISCONNECTED: return NET_DISCONNECTED;
+        default: return NET_UNKNOWN;
+    }
+}
+
+std::string netLocalIP() {
+    if (WiFi.status() != WL_CONNECTED) {
+        return "";
+    }
+    IPAddress ip = WiFi.localIP();
+    if (ip == IPAddress(0, 0, 0, 0)) {
+        return "";
+    }
+    return ip.toString().c_str();
+}
+
+void netStartScan() {
+    WiFi.scanNetworks(true, true); // 异步扫描，包含隐藏网络
+}
+
+int netScanComplete() {
+    return WiFi.scanComplete();
+}
+
+static const char* encryptionName(wifi_auth_mode_t mode) {
+    switch (mode) {
+        case WIFI_AUTH_OPEN: return "Open";
+        case WIFI_AUTH_WEP: return "WEP";
+        case WIFI_AUTH_WPA_PSK: return "WPA";
+        case WIFI_AUTH_WPA2_PSK: return "WPA2";
+        case WIFI_AUTH_WPA_WPA2_PSK: return "WPA/WPA2";
+        case WIFI_AUTH_WPA2_ENTERPRISE: return "WPA2 Enterprise";
+        case WIFI_AUTH_WPA3_PSK: return "WPA3";
+        case WIFI_AUTH_WPA2_WPA3_PSK: return "WPA2/WPA3";
+        default: return "Unknown";
+    }
+}
+
+bool netScanEntry(int index, ScanEntry& entry) {
+    if (index < 0 || index >= WiFi.scanComplete()) {
+        return false;
+    }
+    entry.ssid = WiFi.SSID(index).c_str();
+    entry.rssi = WiFi.RSSI(index);
+    entry.encryption = encryptionName(WiFi.encryptionType(index));
+    return true;
+}
+
+void netShutdown() {
+    WiFi.scanDelete();
+    WiFi.disconnect(true);
+    WiFi.mode(WIFI_OFF);
+}
+
+bool netResolve(const char* host, uint32_t& address) {
+    struct addrinfo hints = {};
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_DGRAM;
+    struct addrinfo* result = nullptr;
+    if (lwip_getaddrinfo(host, nullptr, &hints, &result) != 0 || result == nullptr) {
+        return false;
+    }
+    address = ntohl(((struct sockaddr_in*)result->ai_addr)->sin_addr.s_addr);
+    lwip_freeaddrinfo(result);
+    return true;
+}
+
+// ---- UDP ----
+
+struct UdpSocket::Impl {
+    int fd = -1;
+};
+
+UdpSocket::UdpSocket() : m_impl(new Impl) {
+}
+
+UdpSocket::~UdpSocket() {
+    if (m_impl->fd >= 0) {
+        lwip_close(m_impl->fd);
+    }
+    delete m_impl;
+}
+
+bool UdpSocket::open() {
+    if (m_impl->fd < 0) {
+        m_impl->fd = lwip_socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    }
+    return m_impl->fd >= 0;
+}
+
+bool UdpSocket::sendTo(uint32_t address, uint16_t port, const void* data, size_t length) {
+    struct sockaddr_in to = {};
+    to.sin_family = AF_INET;
+    to.sin_port = htons(port);
+    to.sin_addr.s_addr = htonl(address);
+    return lwip_sendto(m_impl->fd, data, length, 0, (struct sockaddr*)&to, sizeof(to)) == (int)length;
+}
+
+int UdpSocket::receive(void* buffer, size_t size, uint32_t timeoutMs, int64_t& monoUs, uint32_t& from) {
+    fd_set readable;
+    FD_ZERO(&readable);
+    FD_SET(m_impl->fd, &readable);
+    struct timeval timeout = toTimeval((int64_t)timeoutMs * 1000);
+    if (lwip_select(m_impl->fd + 1, &readable, nullptr, nullptr, &timeout) <= 0) {
+        return -1;
+    }
+    // select 返回后立即取时间戳，尽量靠近数据报到达的时刻
+    monoUs = esp_timer_get_time();
+    struct sockaddr_in source = {};
+    socklen_t sourceLength = sizeof(source);
+    int length = lwip_recvfrom(m_impl->fd, buffer, size, 0, (struct sockaddr*)&source, &sourceLength);
+    from = ntohl(source.sin_addr.s_addr);
+    return length;
+}
+
+// ---- HTTP 服务 ----
+
+struct HttpServer::Impl {
+    explicit Impl(int port) : port(port), server(port) {}
+    int port;
+    WebServer server;
+};
+
+HttpServer::HttpServer(int port) : m_impl(new Impl(port)) {
+}
+
+HttpServer::~HttpServer() {
+    delete m_impl;
+}
+
+static HTTPMethod toWebServerMethod(HttpMethod method) {
+    switch (method) {
+        case HTTP_METHOD_GET: return HTTP_GET;
+        case HTTP_METHOD_POST: return HTTP_POST;
+        default: return HTTP_ANY;
+    }
+}
+
+void HttpServer::on(const char* path, HttpMethod method, Handler handler) {
+    m_impl->server.on(path, toWebServerMethod(method), handler);
+}
+
+void HttpServer::onNotFound(Handler handler) {
+    m_impl->server.onNotFound(handler);
+}
+
+void HttpServer::begin() {
+    m_impl->server.begin();
+}
+
+void HttpServer::stop() {
+    m_impl->server.stop();
+}
+
+int HttpServer::port() const {
+    return m_impl->port;
+}
+
+void HttpServer::handleClient() {
+    m_impl->server.handleClient();
+}
+
+std::string HttpServer::arg(const char* name) {
+    return m_impl->server.arg(name).c_str();
+}
+
+void HttpServer::sendHeader(const char* name, const char* value) {
+    m_impl->server.sendHeader(name, value);
+}
+
+void HttpServer::send(int code, const char* contentType, const std::string& content) {
+    m_impl->server.send(code, contentType, content.c_str());
+}
+
+void HttpServer::sendRaw(const char* data, size_t length) {
+    m_impl->server.client().write(reinterpret_cast<const uint8_t*>(data), length);
+}
+
+// ---- 系统 ----
+
+void restart() {
+    esp_restart();
+}
+
+void deepSleep(int wakePin) {
+    esp_deep_sleep_enable_gpio_wakeup(1ULL << wakePin, ESP_GPIO_WAKEUP_GPIO_LOW);
+    Serial.flush();
+    esp_deep_sleep_start();
+}
+
+}  // namespace hal
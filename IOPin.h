@@ -7,9 +7,16 @@
  */
 #ifndef IOPIN_H
 #define IOPIN_H
-#include <Arduino.h>
 
-#define PIN_DA      GPIO_NUM_3
-#define PIN_PON     GPIO_NUM_4
+// GPIO 编号（与 GPIO_NUM_x 相同），不依赖 Arduino，主机构建也使用
+#define PIN_DA      3
+#define PIN_PON     4
+
+// I2S 采样流输出（BACKEND_I2S，DA 引脚作为数据输出）
+#define PIN_I2S_BCLK 6
+#define PIN_I2S_WS   7
+
+// 边沿延迟校准时 DA 用导线接回的输入引脚（ClockApp::calibrateOnBoot）
+#define PIN_DA_CAPTURE 10
 
 #endif // IOPIN_H
@@ -0,0 +1,161 @@
+/*
+ * Copyright (c) 2025 Tomosawa
+ * All rights reserved.
+ *
+ * This code is part of the WiFi2JJY project.
+ * GitHub: https://github.com/Tomosawa/WIFI2JJY
+ */
+#include "JJYCalibration.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include "HAL.h"
+#include "TimeSync.h"
+
+static const char* NVS_NAMESPACE = "jjy-calib";
+
+static std::string keyOf(const char* backendKey, const char* edge) {
+    return std::string(backendKey) + "." + edge;
+}
+
+bool JJYEdgeCompensation::load(const char* backendKey, JJYEdgeCompensation& compensation) {
+    hal::Nvs nvs;
+    if (!nvs.begin(NVS_NAMESPACE)) {
+        return false;
+    }
+    std::string pulse = nvs.getString(keyOf(backendKey, "pulse").c_str(), "");
+    std::string idle = nvs.getString(keyOf(backendKey, "idle").c_str(), "");
+    if (pulse.empty() || idle.empty()) {
+        return false;
+    }
+    compensation.toPulseUs = (int32_t)atol(pulse.c_str());
+    compensation.toIdleUs = (int32_t)atol(idle.c_str());
+    return true;
+}
+
+bool JJYEdgeCompensation::save(const char* backendKey) const {
+    hal::Nvs nvs;
+    if (!nvs.begin(NVS_NAMESPACE)) {
+        return false;
+    }
+    return nvs.putString(keyOf(backendKey, "pulse").c_str(), std::to_string(toPulseUs)) &&
+           nvs.putString(keyOf(backendKey, "idle").c_str(), std::to_string(toIdleUs));
+}
+
+bool JJYEdgeCompensation::clear(const char* backendKey) {
+    hal::Nvs nvs;
+    if (!nvs.begin(NVS_NAMESPACE)) {
+        return false;
+    }
+    nvs.remove(keyOf(backendKey, "pulse").c_str());
+    nvs.remove(keyOf(backendKey, "idle").c_str());
+    return true;
+}
+
+JJYCalibrator::JJYCalibrator(JJYOutput& output, int capturePin, uint8_t idleLevel)
+    : m_output(output), m_capturePin(capturePin), m_idleLevel(idleLevel) {
+}
+
+void JJYCalibrator::onEdge(void* arg, bool level, int64_t monoUs) {
+    JJYCalibrator* self = static_cast<JJYCalibrator*>(arg);
+    self->m_captured.push({monoUs, (uint8_t)level});
+}
+
+bool JJYCalibrator::measure(const JJYEdgeCompensation& compensation, Pass& pass) {
+    static const int64_t WIDTHS_US[] = {200000, 500000, 800000};
+    const uint8_t pulseLevel = m_idleLevel ? 0 : 1;
+
+    // 测试脉冲从两秒后的整秒开始，先换算好每个标称边沿的单调时钟时刻
+    static JJYTimeline timeline;
+    int64_t nominalMonoUs[2 * PULSES];
+    const int64_t startUs = (TimeSync::wallTimeUs() / JJYTimeline::SECOND_US + 2) * JJYTimeline::SECOND_US;
+    timeline.clear(startUs, m_idleLevel);
+    for (int i = 0; i < PULSES; i++) {
+        const int64_t pulseUs = startUs + i * JJYTimeline::SECOND_US;
+        timeline.append(pulseUs, pulseLevel);
+        timeline.append(pulseUs + WIDTHS_US[i % 3], m_idleLevel);
+    }
+    for (int i = 0; i < timeline.size(); i++) {
+        nominalMonoUs[i] = TimeSync::wallToMonotonicUs(timeline[i].timeUs);
+    }
+    timeline.advanceEdges(compensation.toPulseUs, compensation.toIdleUs);
+
+    CapturedEdge edge;
+    while (m_captured.pop(edge)) {
+    }
+    if (!hal::pinCapture(m_capturePin, onEdge, this)) {
+        hal::log("[Calibration] Cannot capture GPIO%d\n", m_capturePin);
+        return false;
+    }
+    bool played = m_output.submit(timeline, PLAY_TIMEOUT_MS) && m_output.waitIdle(PLAY_TIMEOUT_MS);
+    // 最后一个边沿可能还在路上
+    hal::sleepMs((uint32_t)(MATCH_WINDOW_US / 1000) + 50);
+    hal::pinCapture(m_capturePin, nullptr, nullptr);
+    if (!played) {
+        hal::log("[Calibration] %s output failed to play test pulses\n", m_output.name());
+        return false;
+    }
+
+    // 按顺序把捕获的边沿配给标称边沿：电平相同且在窗口内
+    int64_t actualMonoUs[2 * PULSES];
+    bool found[2 * PULSES];
+    bool haveEdge = m_captured.pop(edge);
+    int64_t sums[2] = {0, 0};
+    int counts[2] = {0, 0};
+    pass = Pass();
+    pass.expected = timeline.size();
+    for (int i = 0; i < timeline.size(); i++) {
+        found[i] = false;
+        while (haveEdge && (edge.level != timeline[i].level || edge.monoUs < nominalMonoUs[i] - MATCH_WINDOW_US)) {
+            haveEdge = m_captured.pop(edge);
+        }
+        if (!haveEdge || edge.monoUs > nominalMonoUs[i] + MATCH_WINDOW_US) {
+            continue;
+        }
+        found[i] = true;
+        actualMonoUs[i] = edge.monoUs;
+        const int direction = timeline[i].level != m_idleLevel ? 0 : 1;
+        sums[direction] += edge.monoUs - nominalMonoUs[i];
+        counts[direction]++;
+        pass.matched++;
+        haveEdge = m_captured.pop(edge);
+    }
+    pass.toPulseUs = counts[0] > 0 ? (int32_t)(sums[0] / counts[0]) : 0;
+    pass.toIdleUs = counts[1] > 0 ? (int32_t)(sums[1] / counts[1]) : 0;
+
+    for (int i = 0; i + 1 < timeline.size(); i += 2) {
+        if (!found[i] || !found[i + 1]) {
+            continue;
+        }
+        int64_t errorUs = (actualMonoUs[i + 1] - actualMonoUs[i]) - (nominalMonoUs[i + 1] - nominalMonoUs[i]);
+        int32_t magnitude = (int32_t)llabs(errorUs);
+        if (magnitude > pass.maxWidthErrorUs) {
+            pass.maxWidthErrorUs = magnitude;
+        }
+    }
+    hal::log("[Calibration] %s: %d/%d edges, latency to pulse %+ld us, to idle %+ld us, max width error %ld us\n",
+             m_output.name(), pass.matched, pass.expected, (long)pass.toPulseUs, (long)pass.toIdleUs,
+             (long)pass.maxWidthErrorUs);
+    return pass.matched == pass.expected;
+}
+
+bool JJYCalibrator::run(uint32_t toleranceUs, Result& result) {
+    result = Result();
+    hal::log("[Calibration] Measuring %s output edge latency on GPIO%d...\n", m_output.name(), m_capturePin);
+    if (!measure(JJYEdgeCompensation(), result.measured)) {
+        hal::log("[Calibration] Not all test edges seen, is DA wired to GPIO%d?\n", m_capturePin);
+        return false;
+    }
+    result.compensation.toPulseUs = result.measured.toPulseUs;
+    result.compensation.toIdleUs = result.measured.toIdleUs;
+
+    hal::log("[Calibration] Verifying with compensation...\n");
+    if (!measure(result.compensation, result.verified)) {
+        return false;
+    }
+    const int64_t tolerance = toleranceUs;
+    result.ok = llabs(result.verified.toPulseUs) <= tolerance && llabs(result.verified.toIdleUs) <= tolerance &&
+                result.verified.maxWidthErrorUs <= tolerance;
+    hal::log("[Calibration] %s (tolerance %lu us)\n", result.ok ? "Passed" : "Failed", (unsigned long)toleranceUs);
+    return result.ok;
+}
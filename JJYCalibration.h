@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2025 Tomosawa
+ * All rights reserved.
+ *
+ * This code is part of the WiFi2JJY project.
+ * GitHub: https://github.com/Tomosawa/WIFI2JJY
+ */
+#ifndef JJYCALIBRATION_H
+#define JJYCALIBRATION_H
+
+#include <stdint.h>
+#include "JJYOutput.h"
+#include "SpscRing.h"
+
+// 输出后端的边沿延迟补偿（微秒）：引脚实际变化比时间表晚多少，按边沿方向区分。
+// 发送时时间表中对应方向的边沿提前这么多（JJYTimeline::advanceEdges）。
+struct JJYEdgeCompensation {
+    int32_t toPulseUs = 0;  // 进入脉冲的边沿（JJY 的下降沿）
+    int32_t toIdleUs = 0;   // 回到空闲电平的边沿
+
+    bool isZero() const { return toPulseUs == 0 && toIdleUs == 0; }
+
+    // 保存在 NVS 命名空间 "jjy-calib"，每个输出后端一组（键为 "<后端>.pulse" / "<后端>.idle"）
+    static bool load(const char* backendKey, JJYEdgeCompensation& compensation);
+    bool save(const char* backendKey) const;
+    static bool clear(const char* backendKey);
+};
+
+// 边沿延迟校准：DA 用导线接回一个输入引脚，经输出后端播放一组测试脉冲
+// （0.2/0.5/0.8 秒宽，每秒一个），在输入引脚上捕获实际边沿的单调时钟时刻，
+// 与时间表比较得出两个方向的系统延迟。第二遍带上补偿重新播放做验证，
+// 两个方向的残差和每个脉宽的误差都在容差内才算成功。
+// 捕获回调本身的中断延迟会计入测得的延迟。
+class JJYCalibrator {
+public:
+    // 一遍测量的结果
+    struct Pass {
+        int expected = 0;             // 测试脉冲的边沿数
+        int matched = 0;              // 在输入引脚上找到的边沿数
+        int32_t toPulseUs = 0;        // 实际边沿相对标称时刻的平均延迟
+        int32_t toIdleUs = 0;
+        int32_t maxWidthErrorUs = 0;  // |实测脉宽 - 标称脉宽| 的最大值
+    };
+
+    struct Result {
+        bool ok = false;
+        JJYEdgeCompensation compensation;
+        Pass measured;  // 不带补偿
+        Pass verified;  // 带上 compensation
+    };
+
+    // output 须已 start；idleLevel 为协议的空闲电平
+    JJYCalibrator(JJYOutput& output, int capturePin, uint8_t idleLevel);
+
+    // 测量并验证，阻塞约十几秒
+    bool run(uint32_t toleranceUs, Result& result);
+
+    // 带 compensation 播放一遍测试脉冲并测量
+    bool measure(const JJYEdgeCompensation& compensation, Pass& pass);
+
+private:
+    static constexpr int PULSES = 6;
+    static constexpr int64_t MATCH_WINDOW_US = 150000;  // 小于最短脉宽，边沿不会配错
+    static constexpr uint32_t PLAY_TIMEOUT_MS = 15000;
+
+    struct CapturedEdge {
+        int64_t monoUs;
+        uint8_t level;
+    };
+
+    JJYOutput& m_output;
+    int m_capturePin;
+    uint8_t m_idleLevel;
+    SpscRing<CapturedEdge, 64> m_captured;  // 生产者为捕获中断
+
+    static void onEdge(void* arg, bool level, int64_t monoUs);
+};
+
+#endif // JJYCALIBRATION_H
@@ -0,0 +1,154 @@
+/*
+ * Copyright (c) 2025 Tomosawa
+ * All rights reserved.
+ *
+ * This code is part of the WiFi2JJY project.
+ * GitHub: https://github.com/Tomosawa/WIFI2JJY
+ */
+#include "JJYDecoder.h"
+
+// 位置标记 M, P1-P5, P0
+static const int MARKER_SECONDS[] = {0, 9, 19, 29, 39, 49, 59};
+
+// 保留为0的秒
+static const int RESERVED_SECONDS[] = {4, 10, 11, 14, 20, 21, 24, 34, 35, 38, 40, 53, 54, 55, 56, 57, 58};
+
+// 从第 first 秒起按 weights 读出一个加权和（高位在前），同时累计其中1的个数
+static int readWeighted(const JJYFrame& frame, int first, const int* weights, int count, int& ones) {
+    int value = 0;
+    for (int i = 0; i < count; i++) {
+        if (frame.symbol(first + i) == JJYFrame::ONE) {
+            value += weights[i];
+            ones++;
+        }
+    }
+    return value;
+}
+
+// 读一个 BCD 数字，超出 0-9 时返回 -1
+static int readDigit(const JJYFrame& frame, int first, int width, int& ones) {
+    static const int WEIGHTS[4] = {8, 4, 2, 1};
+    int digit = readWeighted(frame, first, WEIGHTS + 4 - width, width, ones);
+    return digit > 9 ? -1 : digit;
+}
+
+JJYDecoder::Result JJYDecoder::decode(const JJYFrame& frame, JJYDecoded& out) {
+    uint64_t markerSeconds = 0;
+    for (int second : MARKER_SECONDS) {
+        markerSeconds |= 1ULL << second;
+    }
+    for (int second = 0; second < 60; second++) {
+        bool isMarker = frame.symbol(second) == JJYFrame::MARKER;
+        if (isMarker != (((markerSeconds >> second) & 1) != 0)) {
+            return BAD_MARKER;
+        }
+        if (frame.symbol(second) == JJYFrame::BOTH) {
+            return BAD_MARKER;
+        }
+    }
+    for (int second : RESERVED_SECONDS) {
+        if (frame.symbol(second) != JJYFrame::ZERO) {
+            return BAD_RESERVED;
+        }
+    }
+
+    // 分钟：1-3秒（40/20/10），5-8秒（8/4/2/1）
+    int minuteOnes = 0;
+    int minuteTens = readDigit(frame, 1, 3, minuteOnes);
+    int minuteUnits = readDigit(frame, 5, 4, minuteOnes);
+    // 小时：12-13秒（20/10），15-18秒
+    int hourOnes = 0;
+    int hourTens = readDigit(frame, 12, 2, hourOnes);
+    int hourUnits = readDigit(frame, 15, 4, hourOnes);
+    // 年积日：22-23秒（200/100），25-28秒（80/40/20/10），30-33秒
+    int ignored = 0;
+    int dayHundreds = readDigit(frame, 22, 2, ignored);
+    int dayTens = readDigit(frame, 25, 4, ignored);
+    int dayUnits = readDigit(frame, 30, 4, ignored);
+    // 年：41-44秒（80/40/20/10），45-48秒
+    int yearTens = readDigit(frame, 41, 4, ignored);
+    int yearUnits = readDigit(frame, 45, 4, ignored);
+    // 星期：50-52秒（4/2/1）
+    static const int WEEK_WEIGHTS[3] = {4, 2, 1};
+    int weekDay = readWeighted(frame, 50, WEEK_WEIGHTS, 3, ignored);
+
+    if (minuteTens < 0 || minuteUnits < 0 || hourTens < 0 || hourUnits < 0 || dayHundreds < 0 ||
+        dayTens < 0 || dayUnits < 0 || yearTens < 0 || yearUnits < 0) {
+        return BAD_BCD;
+    }
+    out.minute = minuteTens * 10 + minuteUnits;
+    out.hour = hourTens * 10 + hourUnits;
+    out.dayOfYear = dayHundreds * 100 + dayTens * 10 + dayUnits;
+    out.year2 = yearTens * 10 + yearUnits;
+    out.weekDay = weekDay;
+    if (out.minute > 59 || out.hour > 23 || out.dayOfYear < 1 || out.dayOfYear > 366 || out.weekDay > 6) {
+        return BAD_BCD;
+    }
+
+    // PA1：小时各位的偶校验；PA2：分钟各位的偶校验
+    int pa1 = frame.symbol(36) == JJYFrame::ONE ? 1 : 0;
+    int pa2 = frame.symbol(37) == JJYFrame::ONE ? 1 : 0;
+    if ((hourOnes & 1) != pa1) {
+        return BAD_PARITY1;
+    }
+    if ((minuteOnes & 1) != pa2) {
+        return BAD_PARITY2;
+    }
+    return OK;
+}
+
+JJYDecoder::Result JJYDecoder::decode(const JJYTimeline& timeline, JJYDecoded& out) {
+    // 按低电平宽度还原码元：0.8秒=0，0.5秒=1，0.2秒=标记，容差 ±50ms
+    static const int64_t TOLERANCE_US = 50000;
+    JJYFrame frame;
+    frame.data = 0;
+    frame.markers = 0;
+    uint64_t seen = 0;
+
+    int64_t lowStartUs = -1;
+    for (int i = 0; i < timeline.size(); i++) {
+        const JJYEdge& edge = timeline[i];
+        if (edge.level == 0) {
+            lowStartUs = edge.timeUs;
+            continue;
+        }
+        if (lowStartUs < 0) {
+            continue;
+        }
+        int64_t sinceEpochUs = lowStartUs - timeline.epochUs();
+        int second = (int)(sinceEpochUs / JJYTimeline::SECOND_US);
+        if (sinceEpochUs < 0 || second >= 60 || sinceEpochUs % JJYTimeline::SECOND_US != 0) {
+            return BAD_PULSE;
+        }
+        int64_t widthUs = edge.timeUs - lowStartUs;
+        uint64_t bit = frameSecondBit(second);
+        if (widthUs > 800000 - TOLERANCE_US && widthUs < 800000 + TOLERANCE_US) {
+            // 数据位0
+        } else if (widthUs > 500000 - TOLERANCE_US && widthUs < 500000 + TOLERANCE_US) {
+            frame.data |= bit;
+        } else if (widthUs > 200000 - TOLERANCE_US && widthUs < 200000 + TOLERANCE_US) {
+            frame.markers |= bit;
+        } else {
+            return BAD_PULSE;
+        }
+        seen |= bit;
+        lowStartUs = -1;
+    }
+    if (seen != (0xFFFFFFFFFFFFFFFFULL << 4)) {
+        return BAD_PULSE;
+    }
+    return decode(frame, out);
+}
+
+const char* JJYDecoder::resultName(Result result) {
+    switch (result) {
+        case OK: return "ok";
+        case BAD_MARKER: return "bad marker";
+        case BAD_RESERVED: return "reserved bit set";
+        case BAD_BCD: return "bad BCD";
+        case BAD_PARITY1: return "bad PA1 (hour) parity";
+        case BAD_PARITY2: return "bad PA2 (minute) parity";
+        case BAD_PULSE: return "bad pulse width";
+    }
+    return "unknown";
+}
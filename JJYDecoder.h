@@ -0,0 +1,48 @@
+/*
+ * Copyright (c) 2025 Tomosawa
+ * All rights reserved.
+ *
+ * This code is part of the WiFi2JJY project.
+ * GitHub: https://github.com/Tomosawa/WIFI2JJY
+ */
+#ifndef JJYDECODER_H
+#define JJYDECODER_H
+
+#include <stdint.h>
+#include "JJYFrame.h"
+#include "JJYTimeline.h"
+
+// 解码得到的 JJY 时间字段
+struct JJYDecoded {
+    int minute;
+    int hour;
+    int dayOfYear;  // 1-366
+    int year2;      // 年份后两位
+    int weekDay;    // 0=星期日
+};
+
+// JJY 参考解码器：按 NICT 公布的格式逐秒读取，不使用 FrameLayout，
+// 与编码器相互独立，用来校验编码器（布局、BCD、校验位）的正确性。
+// 不依赖 Arduino，可在主机上编译。
+class JJYDecoder {
+public:
+    enum Result {
+        OK = 0,
+        BAD_MARKER,     // 位置标记缺失或出现在非标记秒
+        BAD_RESERVED,   // 保留位不为0
+        BAD_BCD,        // BCD 数字超出0-9或字段超出范围
+        BAD_PARITY1,    // PA1（小时）偶校验错误
+        BAD_PARITY2,    // PA2（分钟）偶校验错误
+        BAD_PULSE       // 时间表中的脉冲宽度无法识别
+    };
+
+    // 从帧的码元解码
+    static Result decode(const JJYFrame& frame, JJYDecoded& out);
+
+    // 从边沿时间表按每秒的低电平宽度还原码元后解码
+    static Result decode(const JJYTimeline& timeline, JJYDecoded& out);
+
+    static const char* resultName(Result result);
+};
+
+#endif // JJYDECODER_H
@@ -0,0 +1,60 @@
+/*
+ * Copyright (c) 2025 Tomosawa
+ * All rights reserved.
+ *
+ * This code is part of the WiFi2JJY project.
+ * GitHub: https://github.com/Tomosawa/WIFI2JJY
+ */
+#ifndef JJYFRAME_H
+#define JJYFRAME_H
+
+#include <stdint.h>
+#include "FrameLayout.h"
+
+// JJY 帧布局
+struct JJYLayout {
+    // 分钟（1-8位）：十位1-3位（40/20/10），第4位保留，个位5-8位（8/4/2/1）
+    using Minute = Field<BcdField<BitGroup<1, 3>, BitGroup<5, 4>>, TmMinute>;
+    // 小时（12-18位）：十位12-13位（20/10），第14位保留，个位15-18位
+    using Hour = Field<BcdField<BitGroup<12, 2>, BitGroup<15, 4>>, TmHour>;
+    // 当年第几天（22-33位）：百位22-23位，第24位保留，十位25-28位，个位30-33位
+    using DayOfYear = Field<BcdField<BitGroup<22, 2>, BitGroup<25, 4>, BitGroup<30, 4>>, TmDayOfYear>;
+    // 年份（41-48位）：只编码后两位
+    using Year = Field<BcdField<BitGroup<41, 4>, BitGroup<45, 4>>, TmYear2>;
+    // 星期（50-52位）：0=星期日 ... 6=星期六
+    using WeekDay = Field<BinaryField<BitGroup<50, 3>>, TmWeekDay>;
+
+    using Fields = FieldList<Minute, Hour, DayOfYear, Year, WeekDay>;
+    // 奇偶校验位1（36位）：小时；奇偶校验位2（37位）：分钟
+    using Parities = ParityList<EvenParity<36, Hour>, EvenParity<37, Minute>>;
+    // 位置标记 M, P1-P5, P0
+    using Markers = MarkerList<0, 9, 19, 29, 39, 49, 59>;
+
+    // 第10,11,20,21,34,35,38,40,53-58位保留为0
+};
+
+// 一帧（60 秒）时间码的紧凑表示，共 16 字节。
+// 每秒的码元由两个位平面组合而成，各协议共用这一表示（见 TimeCode.h）：
+// JJY/WWVB/DCF77 的 data 为数据位、markers 为位置标记；MSF 的 data 为 A 位、markers 为 B 位
+struct JJYFrame {
+    // 每秒的码元类型，数值与脉冲形状表下标一致
+    enum Symbol : uint8_t {
+        ZERO   = 0,  // 数据位0（JJY：低电平0.8秒）
+        ONE    = 1,  // 数据位1（JJY：低电平0.5秒）
+        MARKER = 2,  // 位置标记（JJY：低电平0.2秒）；MSF 为 A=0、B=1
+        BOTH   = 3   // 两个位平面都置位，只有 MSF（A=1、B=1）使用
+    };
+
+    static constexpr uint64_t MARKER_MASK = JJYLayout::Markers::MASK;
+
+    uint64_t data = 0;               // 第一位平面：数据位为1的秒
+    uint64_t markers = MARKER_MASK;  // 第二位平面：位置标记所在的秒
+
+    // 取第 second 秒的码元（无分支）
+    Symbol symbol(int second) const {
+        const int shift = 63 - second;
+        return static_cast<Symbol>((((markers >> shift) & 1U) << 1) | ((data >> shift) & 1U));
+    }
+};
+
+#endif // JJYFRAME_H
@@ -0,0 +1,50 @@
+/*
+ * Copyright (c) 2025 Tomosawa
+ * All rights reserved.
+ *
+ * This code is part of the WiFi2JJY project.
+ * GitHub: https://github.com/Tomosawa/WIFI2JJY
+ */
+#include "JJYFrameCache.h"
+
+JJYFrameCache::JJYFrameCache(const TimeCode& code, int32_t utcOffset)
+    : m_encode(code.encode), m_utcOffset(utcOffset), m_generation(0) {
+    invalidate();
+}
+
+void JJYFrameCache::prefill(time_t firstMinute, uint32_t generation) {
+    if (generation != m_generation) {
+        invalidate();
+        m_generation = generation;
+    }
+
+    for (int i = 0; i < CAPACITY; i++) {
+        time_t minute = firstMinute + (time_t)i * 60;
+        Entry& entry = m_entries[slotOf(minute)];
+        if (entry.valid && entry.minute == minute) {
+            continue;
+        }
+
+        m_encode(entry.frame, minute, m_utcOffset);
+        entry.minute = minute;
+        entry.valid = true;
+    }
+}
+
+bool JJYFrameCache::lookup(time_t minute, uint32_t generation, JJYFrame& frame) const {
+    if (generation != m_generation) {
+        return false;
+    }
+    const Entry& entry = m_entries[slotOf(minute)];
+    if (!entry.valid || entry.minute != minute) {
+        return false;
+    }
+    frame = entry.frame;
+    return true;
+}
+
+void JJYFrameCache::invalidate() {
+    for (int i = 0; i < CAPACITY; i++) {
+        m_entries[i].valid = false;
+    }
+}
@@ -0,0 +1,53 @@
+/*
+ * Copyright (c) 2025 Tomosawa
+ * All rights reserved.
+ *
+ * This code is part of the WiFi2JJY project.
+ * GitHub: https://github.com/Tomosawa/WIFI2JJY
+ */
+#ifndef JJYFRAMECACHE_H
+#define JJYFRAMECACHE_H
+
+#include <stdint.h>
+#include <time.h>
+#include "JJYFrame.h"
+#include "TimeCode.h"
+
+// 预编码帧缓存：在当前分钟的空闲时间里提前编码之后若干分钟的帧，
+// 整分到来时直接取用，编码不再处于分钟边界到第一个下降沿之间的关键路径上
+class JJYFrameCache {
+public:
+    static constexpr int CAPACITY = 4;  // 预编码的分钟数
+
+    // 用 code 的编码函数按 utcOffset 时区预编码
+    explicit JJYFrameCache(const TimeCode& code, int32_t utcOffset = TIME_CODE_NATIVE_ZONE);
+
+    // 预编码从 firstMinute（整分的UTC秒数）开始的 CAPACITY 个分钟
+    // generation 为时钟代数，与缓存中不一致时先清空缓存
+    void prefill(time_t firstMinute, uint32_t generation);
+
+    // 查找 minute 对应的帧，命中返回 true
+    bool lookup(time_t minute, uint32_t generation, JJYFrame& frame) const;
+
+    // 清空缓存（时钟被步进调整时调用）
+    void invalidate();
+
+private:
+    struct Entry {
+        time_t minute;
+        JJYFrame frame;
+        bool valid;
+    };
+
+    TimeCode::EncodeFn m_encode;
+    int32_t m_utcOffset;
+    Entry m_entries[CAPACITY];
+    uint32_t m_generation;
+
+    // 一个分钟固定落在环中的某个槽位
+    static int slotOf(time_t minute) {
+        return (int)((minute / 60) % CAPACITY);
+    }
+};
+
+#endif // JJYFRAMECACHE_H
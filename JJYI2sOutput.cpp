@@ -0,0 +1,200 @@
+/*
+ * Copyright (c) 2025 Tomosawa
+ * All rights reserved.
+ *
+ * This code is part of the WiFi2JJY project.
+ * GitHub: https://github.com/Tomosawa/WIFI2JJY
+ */
+#include "JJYI2sOutput.h"
+#include "TimeSync.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+JJYI2sOutput::JJYI2sOutput(int bclkPin, int wsPin, int doutPin, const JJYWaveform::Config& config)
+    : m_bclkPin(bclkPin), m_wsPin(wsPin), m_doutPin(doutPin), m_channel(nullptr), m_running(false) {
+    if (!m_waveform.configure(config)) {
+        hal::log("[JJYI2sOutput] Carrier does not fit the sample rate, using defaults\n");
+        m_waveform.configure(JJYWaveform::Config());
+    }
+}
+
+JJYI2sOutput::~JJYI2sOutput() {
+    if (m_channel != nullptr) {
+        stopStream();
+        i2s_del_channel(m_channel);
+    }
+}
+
+bool JJYI2sOutput::begin() {
+    if (m_channel != nullptr) {
+        return true;
+    }
+
+    i2s_chan_config_t chanConfig = I2S_CHANNEL_DEFAULT_CONFIG(I2S_NUM_0, I2S_ROLE_MASTER);
+    // 欠载时输出静音而不是重复旧数据
+    chanConfig.auto_clear = true;
+    esp_err_t err = i2s_new_channel(&chanConfig, &m_channel, nullptr);
+    if (err != ESP_OK) {
+        hal::log("[JJYI2sOutput] i2s_new_channel failed: %d\n", err);
+        m_channel = nullptr;
+        return false;
+    }
+
+    i2s_std_config_t stdConfig = {
+        .clk_cfg = I2S_STD_CLK_DEFAULT_CONFIG(m_waveform.config().sampleRate),
+        .slot_cfg = I2S_STD_PHILIPS_SLOT_DEFAULT_CONFIG(I2S_DATA_BIT_WIDTH_16BIT, I2S_SLOT_MODE_MONO),
+        .gpio_cfg = {
+            .mclk = I2S_GPIO_UNUSED,
+            .bclk = (gpio_num_t)m_bclkPin,
+            .ws = (gpio_num_t)m_wsPin,
+            .dout = (gpio_num_t)m_doutPin,
+            .din = I2S_GPIO_UNUSED,
+            .invert_flags = {},
+        },
+    };
+    err = i2s_channel_init_std_mode(m_channel, &stdConfig);
+    if (err != ESP_OK) {
+        hal::log("[JJYI2sOutput] i2s_channel_init_std_mode failed: %d\n", err);
+        i2s_del_channel(m_channel);
+        m_channel = nullptr;
+        return false;
+    }
+
+    hal::log("[JJYI2sOutput] I2S ready (%lu Hz, %u-sample carrier table, DOUT: %d)\n",
+             (unsigned long)m_waveform.config().sampleRate,
+             (unsigned)m_waveform.tableSamples(), m_doutPin);
+    return true;
+}
+
+bool JJYI2sOutput::writeBlock(const int16_t* samples, size_t count) {
+    size_t written = 0;
+    esp_err_t err = i2s_channel_write(m_channel, samples, count * sizeof(int16_t), &written, WRITE_TIMEOUT_MS);
+    return err == ESP_OK && written == count * sizeof(int16_t);
+}
+
+bool JJYI2sOutput::startStream(const JJYTimeline& timeline, int64_t anchorUs) {
+    m_waveform.setAnchor(anchorUs);
+
+    // 启动前把开头的采样预载进 DMA，使能的那一刻就是第0个采样
+    size_t pending = 0;
+    const int16_t* pendingData = m_block;
+    while (true) {
+        m_waveform.render(timeline, m_block, BLOCK_SAMPLES);
+        size_t loaded = 0;
+        if (i2s_channel_preload_data(m_channel, m_block, sizeof(m_block), &loaded) != ESP_OK) {
+            return false;
+        }
+        if (loaded < sizeof(m_block)) {
+            pendingData = m_block + loaded / sizeof(int16_t);
+            pending = BLOCK_SAMPLES - loaded / sizeof(int16_t);
+            break;
+        }
+    }
+
+    // 自旋到锚点时刻再使能
+    while (TimeSync::wallTimeUs() < anchorUs) {
+    }
+    if (i2s_channel_enable(m_channel) != ESP_OK) {
+        return false;
+    }
+    m_running = true;
+    return pending == 0 || writeBlock(pendingData, pending);
+}
+
+void JJYI2sOutput::stopStream() {
+    if (m_running) {
+        i2s_channel_disable(m_channel);
+        m_running = false;
+    }
+}
+
+bool JJYI2sOutput::play(const JJYTimeline& timeline) {
+    if (timeline.size() == 0 || !begin()) {
+        return false;
+    }
+
+    // 流已经欠载（渲染位置落后于当前时间）时，之前的锚点不再有效
+    if (m_running && m_waveform.positionUs() < TimeSync::wallTimeUs()) {
+        hal::log("[JJYI2sOutput] Sample stream underrun, realigning\n");
+        stopStream();
+    }
+
+    if (!m_running) {
+        const int64_t anchorUs = timeline[0].timeUs - LEAD_US;
+        // cancel / requestStop 提前唤醒
+        int64_t remainingUs;
+        while ((remainingUs = anchorUs - LEAD_US - TimeSync::wallTimeUs()) > 1000) {
+            if (sleepMs((uint32_t)(remainingUs / 1000)) && (abortRequested() || stopBefore(timeline, 0))) {
+                break;
+            }
+        }
+        if (abortRequested() || stopBefore(timeline, 0)) {
+            return true;
+        }
+        if (deadlineMissed(0, TimeSync::wallTimeUs() + LEAD_US - timeline[0].timeUs)) {
+            // 第一个边沿已错过截止时间，整帧放弃，下一帧重新对齐
+            return true;
+        }
+        if (anchorUs <= TimeSync::wallTimeUs()) {
+            // 已经来不及对齐第一个边沿，从现在开始，已过去的边沿被跳过
+            if (!startStream(timeline, TimeSync::wallTimeUs() + LEAD_US)) {
+                stopStream();
+                return false;
+            }
+        } else if (!startStream(timeline, anchorUs)) {
+            stopStream();
+            return false;
+        }
+    }
+
+    // 一直渲染到最后一个边沿之后，i2s_channel_write 阻塞到 DMA 有空位，按采样时钟节流
+    const int lastIndex = timeline.size() - 1;
+    int64_t endSample = m_waveform.sampleAt(timeline[lastIndex].timeUs) + 1;
+    bool stopping = false;
+    while (m_waveform.position() < endSample) {
+        if (abortRequested() || stopMode() == STOP_NOW) {
+            // 中止或立即停止：停止采样流，下一帧重新对齐
+            stopIndexFrom(timeline, m_waveform.positionUs());
+            stopStream();
+            return true;
+        }
+        // 停止请求：只渲染到要停的边沿为止
+        if (!stopping) {
+            int stop = stopIndexFrom(timeline, m_waveform.positionUs());
+            if (stop >= 0) {
+                stopping = true;
+                endSample = m_waveform.sampleAt(timeline[stop].timeUs);
+                continue;
+            }
+        }
+        size_t count = (size_t)(endSample - m_waveform.position());
+        if (count > BLOCK_SAMPLES) {
+            count = BLOCK_SAMPLES;
+        }
+        m_waveform.render(timeline, m_block, count);
+        if (!writeBlock(m_block, count)) {
+            hal::log("[JJYI2sOutput] i2s_channel_write failed\n");
+            stopStream();
+            return false;
+        }
+    }
+
+    if (stopping) {
+        // 等 DMA 中已渲染的采样播完再停止采样流
+        int64_t remainingUs = m_waveform.positionUs() - TimeSync::wallTimeUs();
+        if (remainingUs > 1000) {
+            vTaskDelay(pdMS_TO_TICKS(remainingUs / 1000));
+        }
+        stopStream();
+        return true;
+    }
+
+    // 采样时钟决定边沿时刻，误差为采样量化误差
+    const int64_t firstUs = timeline[0].timeUs;
+    const int64_t lastUs = timeline[lastIndex].timeUs;
+    int64_t firstError = m_waveform.sampleTimeUs(m_waveform.sampleAt(firstUs)) - firstUs;
+    int64_t lastError = m_waveform.sampleTimeUs(m_waveform.sampleAt(lastUs)) - lastUs;
+    recordEdgeError(timeline, 0, firstError);
+    recordEdgeError(timeline, lastIndex, lastError);
+    return true;
+}
@@ -0,0 +1,51 @@
+/*
+ * Copyright (c) 2025 Tomosawa
+ * All rights reserved.
+ *
+ * This code is part of the WiFi2JJY project.
+ * GitHub: https://github.com/Tomosawa/WIFI2JJY
+ */
+#ifndef JJYI2SOUTPUT_H
+#define JJYI2SOUTPUT_H
+
+#include <Arduino.h>
+#include "driver/i2s_std.h"
+#include "JJYOutput.h"
+#include "JJYWaveform.h"
+
+// I2S 采样流输出：JJYWaveform 把调制后的信号渲染进 DMA 缓冲，
+// 输出时刻由 I2S 采样时钟决定。连续的帧共用同一条采样流，
+// 只有流中断（欠载或中止后）时才重新对齐挂钟。
+// 输出为 16 位单声道 I2S，需外接 I2S DAC / 功放。
+class JJYI2sOutput : public JJYOutput {
+public:
+    JJYI2sOutput(int bclkPin, int wsPin, int doutPin,
+                 const JJYWaveform::Config& config = JJYWaveform::Config());
+    ~JJYI2sOutput();
+
+    bool begin() override;
+    const char* name() const override { return "i2s"; }
+
+protected:
+    bool play(const JJYTimeline& timeline) override;
+
+private:
+    static constexpr size_t BLOCK_SAMPLES = 480;   // 每次写入 DMA 的采样数
+    static constexpr int64_t LEAD_US = 20000;      // 流启动前预先渲染并预载 DMA 的提前量
+    static constexpr uint32_t WRITE_TIMEOUT_MS = 1000;
+
+    int m_bclkPin;
+    int m_wsPin;
+    int m_doutPin;
+    i2s_chan_handle_t m_channel;
+    bool m_running;
+    JJYWaveform m_waveform;
+    int16_t m_block[BLOCK_SAMPLES];
+
+    // 在 anchorUs 时刻启动采样流，第0个采样对应 anchorUs
+    bool startStream(const JJYTimeline& timeline, int64_t anchorUs);
+    void stopStream();
+    bool writeBlock(const int16_t* samples, size_t count);
+};
+
+#endif // JJYI2SOUTPUT_H
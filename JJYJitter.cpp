@@ -0,0 +1,132 @@
+/*
+ * Copyright (c) 2025 Tomosawa
+ * All rights reserved.
+ *
+ * This code is part of the WiFi2JJY project.
+ * GitHub: https://github.com/Tomosawa/WIFI2JJY
+ */
+#include "JJYJitter.h"
+#include <stdio.h>
+#include "HAL.h"
+
+const int32_t JJYJitterHistogram::BIN_LIMITS_US[BIN_COUNT - 1] = {
+    10, 20, 50, 100, 200, 500, 1000, 2000, 5000, 10000, 20000, 50000};
+
+void JJYJitterHistogram::reset() {
+    for (int i = 0; i < BIN_COUNT; i++) {
+        bins[i] = 0;
+    }
+    count = 0;
+    early = 0;
+    minUs = 0;
+    maxUs = 0;
+    sumUs = 0;
+}
+
+void JJYJitterHistogram::add(int32_t valueUs) {
+    int32_t magnitude = valueUs < 0 ? -valueUs : valueUs;
+    int bin = 0;
+    while (bin < BIN_COUNT - 1 && magnitude > BIN_LIMITS_US[bin]) {
+        bin++;
+    }
+    bins[bin]++;
+    if (count == 0 || valueUs < minUs) {
+        minUs = valueUs;
+    }
+    if (count == 0 || valueUs > maxUs) {
+        maxUs = valueUs;
+    }
+    if (valueUs < 0) {
+        early++;
+    }
+    count++;
+    sumUs += valueUs;
+}
+
+int JJYJitterHistogram::format(char* buffer, size_t size) const {
+    int length = 0;
+    buffer[0] = '\0';
+    for (int i = 0; i < BIN_COUNT; i++) {
+        if (bins[i] == 0 || length >= (int)size) {
+            continue;
+        }
+        int written;
+        if (i < BIN_COUNT - 1) {
+            written = snprintf(buffer + length, size - length, "%s<=%ldus:%lu", length > 0 ? " " : "",
+                               (long)BIN_LIMITS_US[i], (unsigned long)bins[i]);
+        } else {
+            written = snprintf(buffer + length, size - length, "%s>%ldus:%lu", length > 0 ? " " : "",
+                               (long)BIN_LIMITS_US[i - 1], (unsigned long)bins[i]);
+        }
+        if (written < 0) {
+            break;
+        }
+        length += written;
+    }
+    return length < (int)size ? length : (int)size - 1;
+}
+
+void JJYJitterMonitor::beginSession(uint8_t idleLevel, int32_t toPulseUs, int32_t toIdleUs) {
+    // 丢弃上次发送残留的样本
+    JJYEdgeSample sample;
+    while (m_ring.pop(sample)) {
+    }
+    m_lateness.reset();
+    m_widthCount = 0;
+    m_idleLevel = idleLevel;
+    m_widthShiftUs = toIdleUs - toPulseUs;
+    m_hasPrevious = false;
+    m_droppedBase = m_ring.dropped();
+}
+
+size_t JJYJitterMonitor::drain() {
+    size_t count = 0;
+    JJYEdgeSample sample;
+    while (m_ring.pop(sample)) {
+        m_lateness.add(sample.errorUs);
+        // 同一帧内紧邻的前一个边沿开始了一个脉冲
+        if (m_hasPrevious && m_previous.level != m_idleLevel && sample.index == m_previous.index + 1 &&
+            sample.targetUs > m_previous.targetUs) {
+            addWidth(m_previous, sample);
+        }
+        m_previous = sample;
+        m_hasPrevious = true;
+        count++;
+    }
+    return count;
+}
+
+void JJYJitterMonitor::addWidth(const JJYEdgeSample& start, const JJYEdgeSample& end) {
+    uint32_t nominalMs = (uint32_t)((end.targetUs - start.targetUs + m_widthShiftUs + 500) / 1000);
+    int widthClass = 0;
+    while (widthClass < m_widthCount && m_widths[widthClass].nominalMs != nominalMs) {
+        widthClass++;
+    }
+    if (widthClass == m_widthCount) {
+        if (m_widthCount == WIDTH_CLASSES) {
+            return;
+        }
+        m_widths[widthClass].nominalMs = nominalMs;
+        m_widths[widthClass].error.reset();
+        m_widthCount++;
+    }
+    m_widths[widthClass].error.add(end.errorUs - start.errorUs);
+}
+
+void JJYJitterMonitor::log(const char* outputName) const {
+    char bins[160];
+    m_lateness.format(bins, sizeof(bins));
+    hal::log("[Jitter] %s: %lu edges, lateness mean %+ld us, min %+ld us, max %+ld us, early %lu, dropped %lu\n",
+             outputName, (unsigned long)m_lateness.count, (long)m_lateness.meanUs(), (long)m_lateness.minUs,
+             (long)m_lateness.maxUs, (unsigned long)m_lateness.early, (unsigned long)dropped());
+    if (m_lateness.count > 0) {
+        hal::log("[Jitter]   lateness |us| %s\n", bins);
+    }
+    for (int i = 0; i < m_widthCount; i++) {
+        const JJYJitterHistogram& error = m_widths[i].error;
+        error.format(bins, sizeof(bins));
+        hal::log("[Jitter]   %lums pulses: %lu, width error mean %+ld us, min %+ld us, max %+ld us, |us| %s\n",
+                 (unsigned long)m_widths[i].nominalMs, (unsigned long)error.count, (long)error.meanUs(),
+                 (long)error.minUs, (long)error.maxUs, bins);
+    }
+}
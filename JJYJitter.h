@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) 2025 Tomosawa
+ * All rights reserved.
+ *
+ * This code is part of the WiFi2JJY project.
+ * GitHub: https://github.com/Tomosawa/WIFI2JJY
+ */
+#ifndef JJYJITTER_H
+#define JJYJITTER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "JJYTimeline.h"
+#include "SpscRing.h"
+
+// 一个已输出边沿的计划时刻与实际误差
+struct JJYEdgeSample {
+    int64_t targetUs;  // 时间表中的挂钟时刻
+    int32_t errorUs;   // 实际 - 计划，正数为偏晚
+    uint16_t index;    // 帧内边沿序号
+    uint8_t level;     // 边沿之后的电平
+};
+
+// 误差直方图：按绝对值分为 1-2-5 档（10us 到 50ms，最后一档为更大），
+// 另记样本数、提前（负值）的次数、最小/最大值和总和
+struct JJYJitterHistogram {
+    static constexpr int BIN_COUNT = 13;
+    static const int32_t BIN_LIMITS_US[BIN_COUNT - 1];
+
+    uint32_t bins[BIN_COUNT];
+    uint32_t count;
+    uint32_t early;
+    int32_t minUs;
+    int32_t maxUs;
+    int64_t sumUs;
+
+    JJYJitterHistogram() { reset(); }
+    void reset();
+    void add(int32_t valueUs);
+    int32_t meanUs() const { return count > 0 ? (int32_t)(sumUs / (int64_t)count) : 0; }
+
+    // 把非空的档格式化为 "<=10us:3 <=20us:5 ..."，返回写入的长度
+    int format(char* buffer, size_t size) const;
+};
+
+// 边沿抖动统计：输出后端每输出一个边沿调用一次 record（播放任务或定时器中断中），
+// 只是一次无锁入队；发送任务在帧间调用 drain，把样本累计为本次发送的
+// 边沿迟到直方图和按标称宽度（JJY 为 200/500/800ms）分类的脉宽误差直方图。
+// 脉宽误差只对同一帧内相邻两个边沿都有时间戳的脉冲统计，
+// RMT/I2S 后端由硬件定时，只报告首尾两个边沿。
+class JJYJitterMonitor {
+public:
+    static constexpr size_t RING_CAPACITY = 256;  // 两帧多的边沿，发送任务每帧消费一次
+    static constexpr int WIDTH_CLASSES = 4;
+
+    // 生产者
+    void record(const JJYEdge& edge, int index, int64_t errorUs) {
+        if (errorUs > INT32_MAX) {
+            errorUs = INT32_MAX;
+        } else if (errorUs < INT32_MIN) {
+            errorUs = INT32_MIN;
+        }
+        m_ring.push({edge.timeUs, (int32_t)errorUs, (uint16_t)index, edge.level});
+    }
+
+    // 消费者：开始新一次发送，清空统计；idleLevel 以外的电平算作脉冲。
+    // 时间表按边沿延迟补偿提前过时给出补偿量，脉冲仍按标称宽度分类
+    void beginSession(uint8_t idleLevel, int32_t toPulseUs = 0, int32_t toIdleUs = 0);
+
+    // 消费者：取出所有样本并累计，返回取出的数量
+    size_t drain();
+
+    const JJYJitterHistogram& lateness() const { return m_lateness; }
+    int widthClassCount() const { return m_widthCount; }
+    uint32_t widthNominalMs(int widthClass) const { return m_widths[widthClass].nominalMs; }
+    const JJYJitterHistogram& widthError(int widthClass) const { return m_widths[widthClass].error; }
+
+    // 本次发送中因缓冲满丢弃的样本数
+    uint32_t dropped() const { return m_ring.dropped() - m_droppedBase; }
+
+    // 输出统计摘要到日志
+    void log(const char* outputName) const;
+
+private:
+    struct WidthClass {
+        uint32_t nominalMs;
+        JJYJitterHistogram error;
+    };
+
+    SpscRing<JJYEdgeSample, RING_CAPACITY> m_ring;
+    JJYJitterHistogram m_lateness;
+    WidthClass m_widths[WIDTH_CLASSES];
+    int m_widthCount = 0;
+    uint8_t m_idleLevel = 1;
+    int32_t m_widthShiftUs = 0;  // 补偿使时间表中的脉宽比标称宽度短了多少
+    bool m_hasPrevious = false;
+    JJYEdgeSample m_previous = {};
+    uint32_t m_droppedBase = 0;
+
+    void addWidth(const JJYEdgeSample& start, const JJYEdgeSample& end);
+};
+
+#endif // JJYJITTER_H
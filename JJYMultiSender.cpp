@@ -0,0 +1,232 @@
+/*
+ * Copyright (c) 2025 Tomosawa
+ * All rights reserved.
+ *
+ * This code is part of the WiFi2JJY project.
+ * GitHub: https://github.com/Tomosawa/WIFI2JJY
+ */
+#include "JJYMultiSender.h"
+#include "IOPin.h"
+#include "HAL.h"
+#include "JJYSoftwareScheduler.h"
+
+JJYMultiSender::Channel::Channel(const JJYChannelConfig& config)
+    : pin(config.pin), code(TimeCode::get(config.protocol)), utcOffset(config.utcOffset),
+      frameCache(code, config.utcOffset) {
+}
+
+JJYMultiSender::JJYMultiSender(const JJYChannelConfig* channels, int count, JJYSender::OutputBackend backend)
+    : m_count(0) {
+    if (count > MAX_CHANNELS) {
+        count = MAX_CHANNELS;
+    }
+    int pins[MAX_CHANNELS];
+    uint8_t idleHighMask = 0;
+    for (int i = 0; i < count; i++) {
+        Channel* channel = new Channel(channels[i]);
+        // 初始化DA引脚为协议的空闲电平
+        const bool idleHigh = channel->code.shapes->idleLevel != 0;
+        hal::pinOutput(channel->pin, idleHigh);
+        hal::log("[JJYMultiSender] Channel %d: %s on pin %d\n", i, channel->code.name, channel->pin);
+        pins[i] = channel->pin;
+        if (idleHigh) {
+            idleHighMask |= 1U << i;
+        }
+        m_channels[m_count++] = channel;
+    }
+    m_scheduler = createScheduler(pins, m_count, idleHighMask, backend);
+}
+
+JJYMultiSender::~JJYMultiSender() {
+    delete m_scheduler;
+    for (int i = 0; i < m_count; i++) {
+        delete m_channels[i];
+    }
+}
+
+bool JJYMultiSender::startScheduler() {
+  // 启动调度输出，定时器不可用（例如引脚超出 GPIO0-31）时退回软件调度
+  if (!m_scheduler->start()) {
+    hal::log("[JJYMultiSender] %s scheduler unavailable, falling back to software\n", m_scheduler->name());
+    int pins[MAX_CHANNELS];
+    uint8_t idleHighMask = 0;
+    for (int i = 0; i < m_count; i++) {
+      pins[i] = m_channels[i]->pin;
+      if (m_channels[i]->code.shapes->idleLevel != 0) {
+        idleHighMask |= 1U << i;
+      }
+    }
+    delete m_scheduler;
+    m_scheduler = new JJYSoftwareScheduler(pins, m_count, idleHighMask);
+    if (!m_scheduler->start()) {
+      return false;
+    }
+  }
+
+  m_scheduler->setDeadline(m_deadlineUs);
+
+  // 调度输出与同名的单路后端走同一条输出路径（GPTimer 中断或软件写引脚），
+  // 直接使用 JJYSender::calibrate 为该后端保存的补偿
+  JJYEdgeCompensation saved;
+  if (JJYEdgeCompensation::load(m_scheduler->name(), saved) && !saved.isZero()) {
+    hal::log("[JJYMultiSender] Edge compensation for %s: to pulse %+ld us, to idle %+ld us\n",
+             m_scheduler->name(), (long)saved.toPulseUs, (long)saved.toIdleUs);
+  }
+  m_compensation = saved;
+  return true;
+}
+
+bool JJYMultiSender::startAsyncSend(TimeSync* timeSync) {
+  if (m_taskRunning || m_count == 0) {
+    return false;
+  }
+  m_timeSync = timeSync;
+  m_taskDone = false;
+
+  if (!startScheduler()) {
+    return false;
+  }
+  hal::log("[JJYMultiSender] Using %s scheduler for %d channels\n", m_scheduler->name(), m_count);
+
+  // PON 一拉高就停止输出，不等当前帧结束
+  m_scheduler->clearStop();
+  if (m_ponStop != JJYSender::PON_STOP_FRAME_END && !hal::pinCapture(PIN_PON, onPonEdge, this)) {
+    hal::log("[JJYMultiSender] Cannot attach PON interrupt, checking PON after each frame\n");
+  }
+
+  m_taskRunning = true;
+  if (!hal::startTask(sendTask, "JJYMultiTask", 8192, this, 3)) {
+    m_taskRunning = false;
+    return false;
+  }
+  return true;
+}
+
+void JJYMultiSender::prefillFrames(time_t firstMinute) {
+  uint32_t generation = m_timeSync ? m_timeSync->clockGeneration() : 0;
+  for (int i = 0; i < m_count; i++) {
+    m_channels[i]->frameCache.prefill(firstMinute, generation);
+  }
+}
+
+int JJYMultiSender::prepareFrame(time_t minute) {
+  uint32_t generation = m_timeSync ? m_timeSync->clockGeneration() : 0;
+  const JJYTimeline* timelines[MAX_CHANNELS];
+  int misses = 0;
+
+  for (int i = 0; i < m_count; i++) {
+    Channel* channel = m_channels[i];
+    // 取出空闲时按本路时区预编码好的帧；未命中时现场编码
+    JJYFrame frame;
+    if (!channel->frameCache.lookup(minute, generation, frame)) {
+      channel->code.encode(frame, minute, channel->utcOffset);
+      misses++;
+    }
+    // 各路都锚定在同一个 UTC 整分上，补偿在归并前加上
+    channel->timeline.compile(frame, (int64_t)minute * 1000000LL, *channel->code.shapes);
+    if (!m_compensation.isZero()) {
+      channel->timeline.advanceEdges(m_compensation.toPulseUs, m_compensation.toIdleUs);
+    }
+    timelines[i] = &channel->timeline;
+  }
+
+  m_schedule.merge(timelines, m_count);
+  m_frameCacheMisses += misses;
+  return misses;
+}
+
+void JJYMultiSender::onPonEdge(void* arg, bool level, int64_t monoUs) {
+  (void)monoUs;
+  JJYMultiSender* self = static_cast<JJYMultiSender*>(arg);
+  if (level) {
+    self->m_scheduler->requestStop(self->m_ponStop == JJYSender::PON_STOP_IMMEDIATE ? JJYScheduler::STOP_NOW
+                                                                                     : JJYScheduler::STOP_AT_PULSE);
+  }
+}
+
+// 与 JJYSender::sendTask 相同的连续发送流程，只是每帧排入的是各路归并后的边沿队列
+void JJYMultiSender::sendTask(void* param) {
+  JJYMultiSender* self = static_cast<JJYMultiSender*>(param);
+  JJYScheduler* scheduler = self->m_scheduler;
+
+  // 第一帧从下一个整分钟开始
+  time_t minute = (time_t)(TimeSync::wallTimeUs() / 60000000LL + 1) * 60;
+  self->m_frameCacheMisses = 0;
+  self->prefillFrames(minute);
+  self->prepareFrame(minute);
+  scheduler->submit(self->m_schedule, FRAME_TIMEOUT_MS);
+  time_t playing = minute;
+
+  // 放弃已排队的帧，从下一个整分钟重新开始
+  auto restart = [&]() {
+    scheduler->cancel();
+    scheduler->waitIdle(FRAME_TIMEOUT_MS);
+    while (scheduler->waitFrameDone(0)) {
+    }
+    minute = (time_t)(TimeSync::wallTimeUs() / 60000000LL) * 60;
+    playing = minute + 60;
+  };
+
+  while (true) {
+    // 提前把下一帧放入待播槽，槽被占用时阻塞到当前帧开始输出
+    minute += 60;
+    int misses = self->prepareFrame(minute);
+    if (!scheduler->submit(self->m_schedule, FRAME_TIMEOUT_MS)) {
+      hal::log("[MultiLoop] Scheduler stalled, restarting at next minute\n");
+      restart();
+      continue;
+    }
+
+    // 两帧都已排队，当前帧输出期间预编码再往后的几分钟
+    self->prefillFrames(minute + 60);
+
+    // 等待正在输出的帧结束
+    if (!scheduler->waitFrameDone(FRAME_TIMEOUT_MS)) {
+      hal::log("[MultiLoop] Timed out waiting for frame to finish\n");
+    }
+
+    struct tm sent;
+    gmtime_r(&playing, &sent);
+    const JJYFrameReport& report = scheduler->report();
+    hal::log("[MultiLoop] Sent %d channels for %02d:%02d UTC (%s): start %+lld us, end %+lld us, max |%lld| us\n",
+             self->m_count, sent.tm_hour, sent.tm_min, scheduler->name(), (long long)report.startErrorUs,
+             (long long)report.endErrorUs, (long long)report.maxErrorUs);
+    if (report.missedIndex >= 0) {
+      hal::log("[MultiLoop] Deadline missed: %s at step %d (%+lld us), frame abandoned until next minute\n",
+               report.missedIndex == 0 ? "late start" : "overrun", report.missedIndex,
+               (long long)report.missedLateUs);
+    }
+    const bool stopped = report.stoppedIndex >= 0;
+    if (stopped) {
+      hal::log("[MultiLoop] PON raised, output stopped at step %d\n", report.stoppedIndex);
+    }
+    if (misses > 0) {
+      hal::log("[MultiLoop] Frame cache missed on %d channels, encoded before queuing\n", misses);
+    }
+    playing += 60;
+
+    // 发送一帧后主板可能立即关闭 PON（校时成功）
+    if (hal::pinRead(PIN_PON)) {
+      hal::log("[MultiLoop] PON is HIGH, Time synchronized, exiting loop to sleep\n");
+      hal::pinCapture(PIN_PON, nullptr, nullptr);
+      // 下一帧还在等待第一步，中止它
+      scheduler->cancel();
+      scheduler->waitIdle(FRAME_TIMEOUT_MS);
+      break;
+    }
+    // PON 中途拉高又回落：清除停止请求；待播槽中的下一帧已按停止请求丢弃，从下一分钟重新排队
+    scheduler->clearStop();
+    if (stopped) {
+      hal::log("[MultiLoop] PON fell again after stopping the output, restarting at next minute\n");
+      restart();
+    }
+  }
+
+  const JJYDeadlineStats& deadline = scheduler->deadlineStats();
+  hal::log("[Deadline] %lu frames, %lu late starts, %lu overruns, worst %+lld us\n",
+           (unsigned long)deadline.frames, (unsigned long)deadline.lateStarts,
+           (unsigned long)deadline.overruns, (long long)deadline.worstLateUs);
+
+  self->m_taskDone = true;
+  self->m_taskRunning = false;
+}
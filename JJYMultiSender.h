@@ -0,0 +1,108 @@
+/*
+ * Copyright (c) 2025 Tomosawa
+ * All rights reserved.
+ *
+ * This code is part of the WiFi2JJY project.
+ * GitHub: https://github.com/Tomosawa/WIFI2JJY
+ */
+#ifndef JJYMULTISENDER_H
+#define JJYMULTISENDER_H
+
+#include <time.h>
+#include "TimeSync.h"
+#include "TimeCode.h"
+#include "JJYFrameCache.h"
+#include "JJYTimeline.h"
+#include "JJYSchedule.h"
+#include "JJYScheduler.h"
+#include "JJYSender.h"
+#include "JJYCalibration.h"
+
+// 一路输出的配置
+struct JJYChannelConfig {
+    int pin;                                     // DA引脚号（定时器调度要求 GPIO0-31）
+    TimeCodeProtocol protocol;                   // 时间码协议
+    int32_t utcOffset = TIME_CODE_NATIVE_ZONE;   // 编码的时区（UTC偏移秒数）
+};
+
+// 多路发送：一块板同时驱动几路 DA，每路有自己的协议和时区。
+// 每分钟各路分别编码、编译成时间表，再归并成一条边沿队列交给 JJYScheduler，
+// 整个发送只有一个发送任务、一个播放任务和（定时器调度时）一个定时器。
+// PON 停止、边沿截止时间和边沿延迟补偿与 JJYSender 相同
+class JJYMultiSender {
+public:
+    static constexpr int MAX_CHANNELS = JJYSchedule::MAX_CHANNELS;
+
+    // 超过 MAX_CHANNELS 的通道被忽略。backend 只支持 BACKEND_TIMER（一个 GPTimer 中断输出所有通道）
+    // 和 BACKEND_SOFTWARE，其余按 BACKEND_TIMER；主机构建一律为软件调度
+    JJYMultiSender(const JJYChannelConfig* channels, int count,
+                   JJYSender::OutputBackend backend = JJYSender::BACKEND_TIMER);
+    ~JJYMultiSender();
+
+    int channelCount() const { return m_count; }
+
+    // 异步发送任务
+    bool startAsyncSend(TimeSync* timeSync);
+    bool isAsyncDone() const { return m_taskDone; }
+    bool isAsyncRunning() const { return m_taskRunning; }
+    void clearAsyncDone() { m_taskDone = false; }
+
+    // 同 JJYSender：PON 拉高后怎样结束发送、边沿截止时间，在 startAsyncSend 之前设置
+    void setPonStop(JJYSender::PonStop mode) { m_ponStop = mode; }
+    void setEdgeDeadline(int64_t deadlineUs) { m_deadlineUs = deadlineUs; }
+    const JJYDeadlineStats& deadlineStats() const { return m_scheduler->deadlineStats(); }
+
+    // 边沿延迟补偿：与 JJYSender 同一后端的校准结果（JJYSender::calibrate 存入 NVS），
+    // startAsyncSend 时读取，各路的时间表归并前都按它提前
+    const JJYEdgeCompensation& compensation() const { return m_compensation; }
+
+    // 本次发送中预编码缓存未命中、排队前现场编码的帧数（各路分别计数）
+    uint32_t frameCacheMisses() const { return m_frameCacheMisses; }
+
+private:
+    struct Channel {
+        explicit Channel(const JJYChannelConfig& config);
+
+        int pin;
+        const TimeCode& code;
+        int32_t utcOffset;
+        JJYFrameCache frameCache;  // 按本路时区预编码的后续分钟帧
+        JJYTimeline timeline;      // 本路待排队帧的边沿时间表
+    };
+
+    Channel* m_channels[MAX_CHANNELS];
+    int m_count;
+    JJYScheduler* m_scheduler;
+    JJYSchedule m_schedule;    // 待排队的合并边沿队列
+    JJYEdgeCompensation m_compensation;
+    int64_t m_deadlineUs = JJYScheduler::DEFAULT_DEADLINE_US;
+    JJYSender::PonStop m_ponStop = JJYSender::PON_STOP_NEXT_SECOND;
+    TimeSync* m_timeSync = nullptr;
+    volatile uint32_t m_frameCacheMisses = 0;
+
+    volatile bool m_taskRunning = false;
+    volatile bool m_taskDone = false;
+
+    static constexpr uint32_t FRAME_TIMEOUT_MS = 125000;  // 略大于两帧
+
+    // 按 backend 创建调度输出；固件实现在 JJYSenderOutputs.cpp，
+    // 主机构建（host/JJYSenderOutputsHost.cpp）一律返回软件调度
+    static JJYScheduler* createScheduler(const int pins[], int count, uint8_t idleHighMask,
+                                         JJYSender::OutputBackend backend);
+
+    // 启动调度输出（定时器不可用时退回软件调度）并读取它的边沿补偿
+    bool startScheduler();
+
+    // 在空闲时间里预编码各路从 firstMinute 开始的几分钟
+    void prefillFrames(time_t firstMinute);
+
+    // 准备 minute（整分的UTC秒数）各路的帧并归并到 m_schedule，返回未命中缓存的路数
+    int prepareFrame(time_t minute);
+
+    // PON 引脚中断：拉高时让调度输出停止
+    static void onPonEdge(void* arg, bool level, int64_t monoUs);
+
+    static void sendTask(void* param);
+};
+
+#endif // JJYMULTISENDER_H
@@ -0,0 +1,37 @@
+/*
+ * Copyright (c) 2025 Tomosawa
+ * All rights reserved.
+ *
+ * This code is part of the WiFi2JJY project.
+ * GitHub: https://github.com/Tomosawa/WIFI2JJY
+ */
+#include "JJYOutput.h"
+#include "TimeSync.h"
+
+JJYOutput::JJYOutput() : m_trace(nullptr), m_jitter(nullptr) {
+}
+
+void JJYOutput::framePlayed() {
+    if (m_trace == nullptr) {
+        return;
+    }
+    const JJYTimeline& timeline = playing();
+    const int64_t shiftUs = m_report.startErrorUs;
+    int count = timeline.size();
+    if (m_report.missedIndex >= 0) {
+        count = m_report.missedIndex;
+    } else if (m_report.stoppedIndex >= 0) {
+        count = m_report.stoppedIndex;
+    }
+    for (int i = 0; i < count; i++) {
+        m_trace->recordDa(timeline[i].level != 0, timeline[i].timeUs + shiftUs);
+    }
+    if (m_report.missedIndex >= 0) {
+        // 放弃的帧在错过的边沿处回到空闲电平
+        m_trace->recordDa(timeline.idleLevel() != 0,
+                          timeline[m_report.missedIndex].timeUs + m_report.missedLateUs);
+    } else if (count > 0 && count < timeline.size() && timeline[count - 1].level != timeline.idleLevel()) {
+        // STOP_NOW 在脉冲中途停止，刚刚回到空闲电平
+        m_trace->recordDa(timeline.idleLevel() != 0, TimeSync::wallTimeUs());
+    }
+}
@@ -0,0 +1,47 @@
+/*
+ * Copyright (c) 2025 Tomosawa
+ * All rights reserved.
+ *
+ * This code is part of the WiFi2JJY project.
+ * GitHub: https://github.com/Tomosawa/WIFI2JJY
+ */
+#ifndef JJYOUTPUT_H
+#define JJYOUTPUT_H
+
+#include <stdint.h>
+#include "JJYTimeline.h"
+#include "JJYPlayback.h"
+#include "JJYTrace.h"
+#include "JJYJitter.h"
+
+// DA 输出后端：按边沿时间表（挂钟微秒）输出帧。待播槽、播放任务、停止请求和截止时间
+// 由 JJYPlayback 处理，这里加上单路 DA 才有的波形记录和边沿抖动统计。
+class JJYOutput : public JJYPlayback<JJYTimeline> {
+public:
+    JJYOutput();
+
+    // 把输出的 DA 边沿记录到 trace（nullptr 关闭）。每帧输出结束后按时间表
+    // 加上该帧的起始误差记录，不在输出边沿的关键路径上
+    void setTrace(JJYTraceCapture* trace) { m_trace = trace; }
+
+    // 每个边沿的误差另外送入 jitter 统计（nullptr 关闭），在 start 之前设置
+    void setJitter(JJYJitterMonitor* jitter) { m_jitter = jitter; }
+
+protected:
+    // 记录 timeline 第 index 个边沿的误差并送入抖动统计；可在中断中调用
+    void recordEdgeError(const JJYTimeline& timeline, int index, int64_t errorUs) {
+        if (m_jitter != nullptr) {
+            m_jitter->record(timeline[index], index, errorUs);
+        }
+        JJYPlayback::recordEdgeError(timeline, index, errorUs);
+    }
+
+    // 把刚输出完的一帧的边沿记录到 trace
+    void framePlayed() override;
+
+private:
+    JJYTraceCapture* m_trace;
+    JJYJitterMonitor* m_jitter;
+};
+
+#endif // JJYOUTPUT_H
@@ -0,0 +1,300 @@
+/*
+ * Copyright (c) 2025 Tomosawa
+ * All rights reserved.
+ *
+ * This code is part of the WiFi2JJY project.
+ * GitHub: https://github.com/Tomosawa/WIFI2JJY
+ */
+#ifndef JJYPLAYBACK_H
+#define JJYPLAYBACK_H
+
+#include <stdint.h>
+#include "HAL.h"
+#include "TimeSync.h"
+
+// 一帧的输出时序报告：实际边沿相对挂钟（gettimeofday）目标时刻的误差
+struct JJYFrameReport {
+    int64_t startErrorUs = 0;  // 第一个边沿的误差，正数为偏晚
+    int64_t endErrorUs = 0;    // 最后一个边沿的误差，即整帧累积的误差
+    int64_t maxErrorUs = 0;    // 所有边沿中的最大绝对误差
+    int missedIndex = -1;      // 错过截止时间而放弃本帧的边沿序号，-1 为没有
+    int64_t missedLateUs = 0;  // 该边沿当时已经晚了多少
+    int stoppedIndex = -1;     // 因停止请求没有输出的第一个边沿序号，-1 为没有停止
+};
+
+// 截止时间统计：边沿晚于计划超过截止时间时不再输出，整帧放弃（回到空闲电平），
+// 待播槽里下一分钟的帧照常开始。第0个边沿错过记为迟到开始，之后的记为帧内超时
+struct JJYDeadlineStats {
+    uint32_t frames = 0;       // 播放任务处理的帧数（含放弃的）
+    uint32_t lateStarts = 0;
+    uint32_t overruns = 0;
+    int64_t worstLateUs = 0;   // 错过的边沿中最晚的一个
+
+    uint32_t missed() const { return lateStarts + overruns; }
+};
+
+// 按边沿表逐帧输出的播放引擎：一个高优先级播放任务和一帧深度的待播槽，生产者在第 N 帧
+// 输出期间就把第 N+1 帧放入待播槽，相邻两帧之间没有空隙。停止请求、截止时间和时序报告
+// 都在这里处理，单路输出（JJYOutput，帧为 JJYTimeline）和多路调度（JJYScheduler，
+// 帧为合并后的 JJYSchedule）共用。
+// Frame 须提供 size()、endUs()、timeUs(index) 和 startsPulse(index)（该边沿离开空闲电平）
+template<class Frame>
+class JJYPlayback {
+public:
+    JJYPlayback()
+        : m_slotFree(nullptr), m_slotFull(nullptr), m_frameDone(nullptr), m_stopped(nullptr), m_wake(nullptr),
+          m_deadlineUs(DEFAULT_DEADLINE_US), m_started(false), m_busy(false), m_abort(false), m_stopping(false),
+          m_stopMode(STOP_NONE) {
+    }
+
+    virtual ~JJYPlayback() {
+        // 让播放任务退出后再释放信号量
+        if (m_started) {
+            m_stopping = true;
+            m_abort = true;
+            m_slotFull->give();
+            m_stopped->take(hal::WAIT_FOREVER);
+        }
+        delete m_slotFree;
+        delete m_slotFull;
+        delete m_frameDone;
+        delete m_stopped;
+        delete m_wake;
+    }
+
+    // 初始化输出硬件，可重复调用
+    virtual bool begin() = 0;
+
+    // 后端名称，用于日志
+    virtual const char* name() const = 0;
+
+    // 初始化硬件并创建播放任务与待播槽
+    bool start() {
+        if (m_started) {
+            return true;
+        }
+        if (!begin()) {
+            return false;
+        }
+
+        if (m_slotFree == nullptr) {
+            m_slotFree = new hal::Semaphore(1, 1);
+            m_slotFull = new hal::Semaphore(1, 0);
+            m_frameDone = new hal::Semaphore(16, 0);
+            m_stopped = new hal::Semaphore(1, 0);
+            m_wake = new hal::Semaphore(1, 0);
+        }
+
+        m_stopping = false;
+        if (!hal::startTask(playbackTask, "JJYPlayTask", 4096, this, TASK_PRIORITY)) {
+            hal::log("[JJYOutput] Failed to create %s playback task\n", name());
+            return false;
+        }
+        m_started = true;
+        return true;
+    }
+
+    // 复制一帧放入待播槽，槽被占用时最多阻塞 timeoutMs
+    bool submit(const Frame& frame, uint32_t timeoutMs) {
+        if (!m_started) {
+            return false;
+        }
+        m_abort = false;
+        if (!m_slotFree->take(timeoutMs)) {
+            return false;
+        }
+        m_pending = frame;
+        m_slotFull->give();
+        return true;
+    }
+
+    // 等待下一帧输出结束（每输出完或丢弃一帧计数一次）
+    bool waitFrameDone(uint32_t timeoutMs) {
+        if (!m_started) {
+            return false;
+        }
+        return m_frameDone->take(timeoutMs);
+    }
+
+    // 丢弃待播槽中的帧，并中止尚未开始输出的帧
+    void cancel() {
+        m_abort = true;
+        if (m_wake != nullptr) {
+            m_wake->give();
+        }
+        // 播放任务还没取走的帧直接丢弃，槽归还给生产者
+        if (m_started && m_slotFull->take(0)) {
+            m_slotFree->give();
+        }
+    }
+
+    // 等待待播槽清空且没有帧在输出
+    bool waitIdle(uint32_t timeoutMs) {
+        uint32_t waitedMs = 0;
+        while (m_busy || (m_started && !m_slotFree->take(0))) {
+            if (waitedMs >= timeoutMs) {
+                return false;
+            }
+            hal::sleepMs(10);
+            waitedMs += 10;
+        }
+        // 上面探测时取到了空闲槽，还回去
+        if (m_started) {
+            m_slotFree->give();
+        }
+        return true;
+    }
+
+    // 上一帧的时序报告（帧结束时从 m_report 复制，下一帧开始输出不会覆盖）
+    const JJYFrameReport& report() const { return m_lastReport; }
+
+    // 停止正在输出的帧（例如钟表已拉高 PON）：STOP_AT_PULSE 不再开始新的脉冲
+    // （各协议每秒都以脉冲开始，即停在下一个整秒），当前脉冲照常结束；STOP_NOW 立即回到空闲电平。
+    // 请求一直有效，之后的帧也不再输出，直到 clearStop。只在中断（或主机构建的引脚回调）中调用
+    enum StopMode { STOP_NONE, STOP_AT_PULSE, STOP_NOW };
+    void requestStop(StopMode mode) {
+        // STOP_NOW 不会被之后的 STOP_AT_PULSE 降级
+        if (mode > m_stopMode) {
+            m_stopMode = mode;
+        }
+        if (m_wake != nullptr) {
+            m_wake->giveFromIsr();
+        }
+    }
+    void clearStop() { m_stopMode = STOP_NONE; }
+
+    // 边沿的截止时间（微秒），0 为不检查
+    static constexpr int64_t DEFAULT_DEADLINE_US = 20000;
+    void setDeadline(int64_t deadlineUs) { m_deadlineUs = deadlineUs; }
+    const JJYDeadlineStats& deadlineStats() const { return m_deadlineStats; }
+
+protected:
+    JJYFrameReport m_report;  // 正在输出的帧
+
+    // 输出一帧，最后一个边沿输出后返回，各引脚保持最后的电平直到下一帧
+    virtual bool play(const Frame& frame) = 0;
+
+    // 一帧完整输出（没有中止）后在播放任务中调用，不在输出边沿的关键路径上
+    virtual void framePlayed() {}
+
+    // 播放任务正在输出（或刚输出完）的帧
+    const Frame& playing() const { return m_playing; }
+
+    // 当前帧是否被要求中止
+    bool abortRequested() const { return m_abort; }
+
+    // 记录 frame 第 index 个边沿的误差；可在中断中调用
+    void recordEdgeError(const Frame& frame, int index, int64_t errorUs) {
+        if (index == 0) {
+            m_report.startErrorUs = errorUs;
+        }
+        if (index == frame.size() - 1) {
+            m_report.endErrorUs = errorUs;
+        }
+        int64_t magnitude = errorUs < 0 ? -errorUs : errorUs;
+        if (magnitude > m_report.maxErrorUs) {
+            m_report.maxErrorUs = magnitude;
+        }
+    }
+
+    // 第 index 个边沿输出时已晚 lateUs：超过截止时间时计数并返回 true，
+    // 调用者不再输出本帧剩余的边沿并回到空闲电平。可在中断中调用
+    bool deadlineMissed(int index, int64_t lateUs) {
+        if (m_deadlineUs <= 0 || lateUs <= m_deadlineUs) {
+            return false;
+        }
+        if (index == 0) {
+            m_deadlineStats.lateStarts++;
+        } else {
+            m_deadlineStats.overruns++;
+        }
+        if (lateUs > m_deadlineStats.worstLateUs) {
+            m_deadlineStats.worstLateUs = lateUs;
+        }
+        m_report.missedIndex = index;
+        m_report.missedLateUs = lateUs;
+        return true;
+    }
+
+    // 有停止请求时 frame 第 index 个边沿是否不再输出（是则记入报告），
+    // 调用者回到空闲电平结束本帧。可在中断中调用
+    bool stopBefore(const Frame& frame, int index) {
+        const StopMode mode = m_stopMode;
+        if (mode == STOP_NONE || (mode == STOP_AT_PULSE && !frame.startsPulse(index))) {
+            return false;
+        }
+        m_report.stoppedIndex = index;
+        return true;
+    }
+
+    // 硬件定时的后端用：挂钟 fromUs 之后第一个因停止请求不再输出的边沿，没有时为 -1
+    int stopIndexFrom(const Frame& frame, int64_t fromUs) {
+        for (int i = 0; i < frame.size(); i++) {
+            if (frame.timeUs(i) >= fromUs && stopBefore(frame, i)) {
+                return i;
+            }
+        }
+        return -1;
+    }
+
+    StopMode stopMode() const { return m_stopMode; }
+
+    // 阻塞等待 ms 毫秒，cancel 或 requestStop 时提前返回 true
+    bool sleepMs(uint32_t ms) { return m_wake->take(ms); }
+
+private:
+    static constexpr int TASK_PRIORITY = 4;  // 高于发送任务
+
+    hal::Semaphore* m_slotFree;   // 待播槽空闲
+    hal::Semaphore* m_slotFull;   // 待播槽有帧（或要求播放任务退出）
+    hal::Semaphore* m_frameDone;
+    hal::Semaphore* m_stopped;    // 播放任务已退出
+    hal::Semaphore* m_wake;       // 唤醒 sleepMs 中的播放任务
+    Frame m_pending;     // 待播槽：下一帧
+    Frame m_playing;     // 播放任务正在输出的帧
+    JJYFrameReport m_lastReport;
+    int64_t m_deadlineUs;
+    JJYDeadlineStats m_deadlineStats;
+    volatile bool m_started;
+    volatile bool m_busy;
+    volatile bool m_abort;
+    volatile bool m_stopping;
+    volatile StopMode m_stopMode;
+
+    static void playbackTask(void* param) {
+        JJYPlayback* self = static_cast<JJYPlayback*>(param);
+        while (true) {
+            self->m_slotFull->take(hal::WAIT_FOREVER);
+            if (self->m_stopping) {
+                break;
+            }
+            self->m_busy = true;
+            self->m_playing = self->m_pending;
+            self->m_slotFree->give();
+
+            // 整帧都已过去（生产者严重落后）时直接丢弃，不输出错乱的边沿；
+            // 第一个边沿已错过截止时间时整帧放弃，等下一分钟的帧（发送任务在帧间记录日志）
+            const Frame& frame = self->m_playing;
+            self->m_report = JJYFrameReport();
+            const int64_t nowUs = TimeSync::wallTimeUs();
+            if (frame.endUs() <= nowUs) {
+                hal::log("[JJYOutput] Dropped stale frame on %s output\n", self->name());
+            } else if (frame.size() > 0 && self->stopBefore(frame, 0)) {
+                // 停止请求之后的帧不再输出
+            } else if (frame.size() > 0 && self->deadlineMissed(0, nowUs - frame.timeUs(0))) {
+            } else if (!self->m_abort && !self->play(frame)) {
+                hal::log("[JJYOutput] %s output failed to play frame\n", self->name());
+            } else if (!self->m_abort) {
+                self->framePlayed();
+            }
+
+            self->m_deadlineStats.frames++;
+            self->m_lastReport = self->m_report;
+            self->m_busy = false;
+            self->m_frameDone->give();
+        }
+        self->m_stopped->give();
+    }
+};
+
+#endif // JJYPLAYBACK_H
@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) 2025 Tomosawa
+ * All rights reserved.
+ *
+ * This code is part of the WiFi2JJY project.
+ * GitHub: https://github.com/Tomosawa/WIFI2JJY
+ */
+#include "JJYPulseDecoder.h"
+#include <stdlib.h>
+#include "FrameLayout.h"
+
+JJYPulseDecoder::JJYPulseDecoder(Handler handler) : m_handler(handler) {
+    reset();
+}
+
+void JJYPulseDecoder::reset() {
+    m_lowStartUs = -1;
+    m_lastStartUs = -1;
+    m_lastSymbol = INVALID;
+    m_inFrame = false;
+    m_count = 0;
+}
+
+int JJYPulseDecoder::classify(int64_t widthUs) {
+    static const int64_t WIDTHS[] = {800000, 500000, 200000};  // ZERO, ONE, MARKER
+    for (int symbol = JJYFrame::ZERO; symbol <= JJYFrame::MARKER; symbol++) {
+        if (llabs(widthUs - WIDTHS[symbol]) <= WIDTH_TOLERANCE_US) {
+            return symbol;
+        }
+    }
+    return INVALID;
+}
+
+void JJYPulseDecoder::onLevel(bool level, int64_t timeUs) {
+    if (!level) {
+        if (m_lowStartUs < 0) {
+            m_lowStartUs = timeUs;
+        }
+        return;
+    }
+    if (m_lowStartUs < 0) {
+        return;
+    }
+    int64_t startUs = m_lowStartUs;
+    m_lowStartUs = -1;
+    onPulse(startUs, classify(timeUs - startUs));
+}
+
+void JJYPulseDecoder::onPulse(int64_t startUs, int symbol) {
+    bool consumed = false;
+    if (m_inFrame) {
+        int64_t expectedUs = m_event.startUs + m_count * SECOND_US;
+        if (symbol == INVALID || llabs(startUs - expectedUs) > START_TOLERANCE_US) {
+            m_inFrame = false;
+            m_event.type = FRAME_BROKEN;
+            m_handler(m_event);
+        } else {
+            consumed = true;
+            append(symbol);
+        }
+    }
+
+    // 帧起点：紧跟在标记（上一帧的 P0）后一秒的标记，或静默一段时间后的第一个标记
+    if (!consumed && symbol == JJYFrame::MARKER) {
+        bool afterMarker = m_lastSymbol == JJYFrame::MARKER &&
+                           llabs(startUs - m_lastStartUs - SECOND_US) <= START_TOLERANCE_US;
+        bool afterSilence = m_lastStartUs < 0 || startUs - m_lastStartUs > 3 * SECOND_US / 2;
+        if (afterMarker || afterSilence) {
+            m_inFrame = true;
+            m_count = 0;
+            m_event.type = FRAME_START;
+            m_event.startUs = startUs;
+            m_event.frame.data = 0;
+            m_event.frame.markers = 0;
+            m_handler(m_event);
+            append(symbol);
+        }
+    }
+    m_lastStartUs = startUs;
+    m_lastSymbol = symbol;
+}
+
+void JJYPulseDecoder::append(int symbol) {
+    if (symbol == JJYFrame::ONE) {
+        m_event.frame.data |= frameSecondBit(m_count);
+    } else if (symbol == JJYFrame::MARKER) {
+        m_event.frame.markers |= frameSecondBit(m_count);
+    }
+    if (++m_count == 60) {
+        m_inFrame = false;
+        m_event.type = FRAME_COMPLETE;
+        m_event.result = JJYDecoder::decode(m_event.frame, m_event.decoded);
+        m_handler(m_event);
+    }
+}
@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) 2025 Tomosawa
+ * All rights reserved.
+ *
+ * This code is part of the WiFi2JJY project.
+ * GitHub: https://github.com/Tomosawa/WIFI2JJY
+ */
+#ifndef JJYPULSEDECODER_H
+#define JJYPULSEDECODER_H
+
+#include <stdint.h>
+#include <functional>
+#include "JJYFrame.h"
+#include "JJYDecoder.h"
+
+// 从 DA 电平变化流式解码 JJY，像电波钟一样工作：按低电平宽度识别码元
+// （0.2/0.5/0.8 秒，±50ms），以“标记后紧跟标记”或静默后的第一个标记作为
+// 帧起点，收满60秒后交给 JJYDecoder 解码。只保存当前一帧的状态。
+// 用于整机模拟器的钟表模型和 VCD 记录的逐分钟注释。
+class JJYPulseDecoder {
+public:
+    enum EventType {
+        FRAME_START,     // 识别到分标记，开始接收一帧
+        FRAME_COMPLETE,  // 收满60秒并已解码（result/decoded 有效）
+        FRAME_BROKEN     // 帧中出现无法识别的脉冲或错位，放弃该帧
+    };
+
+    struct Event {
+        EventType type;
+        int64_t startUs;        // 该帧分标记下降沿的时刻
+        JJYFrame frame;         // 已收到的码元
+        JJYDecoder::Result result;
+        JJYDecoded decoded;
+    };
+
+    typedef std::function<void(const Event& event)> Handler;
+
+    explicit JJYPulseDecoder(Handler handler);
+
+    // 丢弃正在接收的帧（信号中断、设备重启）
+    void reset();
+
+    // DA 电平变化（JJY 为负逻辑：低电平为脉冲），timeUs 不减
+    void onLevel(bool level, int64_t timeUs);
+
+private:
+    static constexpr int INVALID = -1;
+    static constexpr int64_t SECOND_US = 1000000LL;
+    static constexpr int64_t WIDTH_TOLERANCE_US = 50000;
+    static constexpr int64_t START_TOLERANCE_US = 100000;
+
+    Handler m_handler;
+    int64_t m_lowStartUs;
+    int64_t m_lastStartUs;
+    int m_lastSymbol;
+    bool m_inFrame;
+    int m_count;
+    Event m_event;
+
+    static int classify(int64_t widthUs);
+    void onPulse(int64_t startUs, int symbol);
+    void append(int symbol);
+};
+
+#endif // JJYPULSEDECODER_H
@@ -0,0 +1,222 @@
+/*
+ * Copyright (c) 2025 Tomosawa
+ * All rights reserved.
+ *
+ * This code is part of the WiFi2JJY project.
+ * GitHub: https://github.com/Tomosawa/WIFI2JJY
+ */
+#include "JJYRmtOutput.h"
+#include "esp_timer.h"
+#include "TimeSync.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+JJYRmtOutput::JJYRmtOutput(int daPin, uint8_t idleLevel)
+    : m_daPin(daPin), m_invert(idleLevel != 0), m_channel(nullptr), m_encoder(nullptr), m_halfCount(0) {
+}
+
+JJYRmtOutput::~JJYRmtOutput() {
+    if (m_channel != nullptr) {
+        rmt_disable(m_channel);
+        rmt_del_channel(m_channel);
+    }
+    if (m_encoder != nullptr) {
+        rmt_del_encoder(m_encoder);
+    }
+}
+
+bool JJYRmtOutput::begin() {
+    if (m_channel != nullptr) {
+        return true;
+    }
+
+    rmt_tx_channel_config_t config = {};
+    config.gpio_num = (gpio_num_t)m_daPin;
+    config.clk_src = RMT_CLK_SRC_DEFAULT;
+    config.resolution_hz = RESOLUTION_HZ;
+    config.mem_block_symbols = 48;
+    config.trans_queue_depth = 2;
+    // RMT 通道在首次发送前和 rmt_disable 之后输出0：JJY 是负逻辑（空闲为高），反相输出后
+    // 即DA高电平；WWVB/DCF77/MSF 空闲为低（满幅），不反相
+    config.flags.invert_out = m_invert;
+
+    esp_err_t err = rmt_new_tx_channel(&config, &m_channel);
+    if (err != ESP_OK) {
+        hal::log("[JJYRmtOutput] rmt_new_tx_channel failed: %d\n", err);
+        m_channel = nullptr;
+        return false;
+    }
+
+    rmt_copy_encoder_config_t encoderConfig = {};
+    err = rmt_new_copy_encoder(&encoderConfig, &m_encoder);
+    if (err != ESP_OK) {
+        hal::log("[JJYRmtOutput] rmt_new_copy_encoder failed: %d\n", err);
+        rmt_del_channel(m_channel);
+        m_channel = nullptr;
+        m_encoder = nullptr;
+        return false;
+    }
+
+    err = rmt_enable(m_channel);
+    if (err != ESP_OK) {
+        hal::log("[JJYRmtOutput] rmt_enable failed: %d\n", err);
+        rmt_del_encoder(m_encoder);
+        rmt_del_channel(m_channel);
+        m_channel = nullptr;
+        m_encoder = nullptr;
+        return false;
+    }
+
+    hal::log("[JJYRmtOutput] RMT channel ready (Pin: %d)\n", m_daPin);
+    return true;
+}
+
+void JJYRmtOutput::setHalf(int index, uint32_t level, uint32_t ticks) {
+    rmt_symbol_word_t& symbol = m_symbols[index / 2];
+    if (index % 2 == 0) {
+        symbol.level0 = level;
+        symbol.duration0 = ticks;
+    } else {
+        symbol.level1 = level;
+        symbol.duration1 = ticks;
+    }
+}
+
+bool JJYRmtOutput::appendHalf(uint32_t level, uint32_t ticks) {
+    if (m_halfCount >= MAX_SYMBOLS * 2) {
+        return false;
+    }
+    setHalf(m_halfCount++, level, ticks);
+    return true;
+}
+
+bool JJYRmtOutput::appendLevel(uint8_t daLevel, int64_t durationUs) {
+    uint32_t level = rmtLevel(daLevel);
+    while (durationUs > 0) {
+        uint32_t ticks = durationUs > MAX_TICKS ? MAX_TICKS : (uint32_t)durationUs;
+        if (!appendHalf(level, ticks)) {
+            return false;
+        }
+        durationUs -= ticks;
+    }
+    return true;
+}
+
+bool JJYRmtOutput::play(const JJYTimeline& timeline) {
+    if (timeline.size() == 0 || !begin()) {
+        return false;
+    }
+
+    // 挂钟到单调时钟的对应关系；RMT 与 esp_timer 同源于晶振，帧内按同一关系换算
+    const int64_t offsetUs = TimeSync::wallToMonotonicUs(timeline[0].timeUs) - timeline[0].timeUs;
+    const int64_t firstMonoUs = timeline[0].timeUs + offsetUs;
+
+    // 在第一个边沿前 LEAD_US 醒来，其余时间任务阻塞（cancel / requestStop 提前唤醒）
+    int64_t remainingUs;
+    while ((remainingUs = firstMonoUs - LEAD_US - esp_timer_get_time()) > 1000) {
+        if (sleepMs((uint32_t)(remainingUs / 1000)) && (abortRequested() || stopBefore(timeline, 0))) {
+            break;
+        }
+    }
+    if (abortRequested() || stopBefore(timeline, 0)) {
+        return true;
+    }
+
+    // 已经错过的部分从 startMonoUs 处截断，之后的边沿仍落在原定时刻
+    int64_t startMonoUs = esp_timer_get_time() + BUILD_MARGIN_US;
+    if (startMonoUs < firstMonoUs) {
+        startMonoUs = firstMonoUs;
+    }
+    // 截断超过截止时间时整帧放弃，RMT 保持空闲电平到下一帧
+    if (deadlineMissed(0, startMonoUs - firstMonoUs)) {
+        return true;
+    }
+
+    // 第0个半符号留给起始等待，之后按相邻边沿的间隔填充；
+    // 最后一个边沿之后 RMT 回到时间表的空闲电平，传输在最后一个边沿处结束，
+    // 下一帧在剩余的时间里重新对齐挂钟，误差不会跨帧累积
+    m_halfCount = 1;
+    for (int i = 0; i < timeline.size(); i++) {
+        int64_t fromUs = timeline[i].timeUs + offsetUs;
+        int64_t untilUs = (i + 1 < timeline.size()) ? timeline[i + 1].timeUs + offsetUs : fromUs + 1;
+        if (untilUs <= startMonoUs) {
+            continue;
+        }
+        if (fromUs < startMonoUs) {
+            fromUs = startMonoUs;
+        }
+        if (!appendLevel(timeline[i].level, untilUs - fromUs)) {
+            hal::log("[JJYRmtOutput] Symbol buffer overflow\n");
+            return false;
+        }
+    }
+    // 空闲电平对应的 RMT 电平
+    const uint32_t idleLevel = rmtLevel(timeline.idleLevel());
+
+    // 符号由两个半符号组成，补齐最后一个（时长为0会被当作结束标记）
+    if (m_halfCount % 2 != 0) {
+        appendHalf(idleLevel, 1);
+    }
+
+    // 起始等待：从现在到第一个输出边沿保持空闲电平
+    int64_t callUs = esp_timer_get_time();
+    int64_t leadUs = startMonoUs - callUs - START_LATENCY_US;
+    if (leadUs < 1) {
+        leadUs = 1;
+    } else if (leadUs > MAX_TICKS) {
+        leadUs = MAX_TICKS;
+    }
+    setHalf(0, idleLevel, (uint32_t)leadUs);
+
+    rmt_transmit_config_t txConfig = {};
+    txConfig.loop_count = 0;
+    txConfig.flags.eot_level = idleLevel;  // 结束后保持DA空闲电平
+    esp_err_t err = rmt_transmit(m_channel, m_encoder, m_symbols,
+                                 (m_halfCount / 2) * sizeof(rmt_symbol_word_t), &txConfig);
+    if (err != ESP_OK) {
+        hal::log("[JJYRmtOutput] rmt_transmit failed: %d\n", err);
+        return false;
+    }
+
+    // 硬件实际开始输出的时刻相对计划的推迟量
+    const int64_t shiftUs = callUs + START_LATENCY_US + leadUs - startMonoUs;
+
+    // 传输期间任务阻塞；停止请求唤醒任务后，在要停的边沿前关闭通道（STOP_NOW 立即关闭），
+    // 关闭后 RMT 输出空闲电平，已编码的剩余符号不再输出
+    const int64_t lastMonoUs = timeline[timeline.size() - 1].timeUs + offsetUs;
+    while ((remainingUs = lastMonoUs - esp_timer_get_time()) > 1000) {
+        if (!sleepMs((uint32_t)(remainingUs / 1000))) {
+            continue;
+        }
+        int64_t stopMonoUs = esp_timer_get_time();
+        if (stopMode() != STOP_NOW) {
+            int stop = stopIndexFrom(timeline, stopMonoUs + STOP_MARGIN_US - offsetUs);
+            if (stop < 0) {
+                continue;
+            }
+            stopMonoUs = timeline[stop].timeUs + offsetUs - STOP_MARGIN_US;
+        } else {
+            stopIndexFrom(timeline, stopMonoUs - offsetUs);
+        }
+        remainingUs = stopMonoUs - esp_timer_get_time();
+        if (remainingUs > 1000) {
+            vTaskDelay(pdMS_TO_TICKS(remainingUs / 1000));
+        }
+        rmt_disable(m_channel);
+        rmt_enable(m_channel);
+        recordEdgeError(timeline, 0, startMonoUs + shiftUs - firstMonoUs);
+        return true;
+    }
+    err = rmt_tx_wait_all_done(m_channel, 2000);
+    if (err != ESP_OK) {
+        hal::log("[JJYRmtOutput] rmt_tx_wait_all_done failed: %d\n", err);
+        return false;
+    }
+
+    // 帧内挂钟相对单调时钟的移动量
+    const int64_t lastUs = timeline[timeline.size() - 1].timeUs;
+    const int64_t endOffsetUs = TimeSync::wallToMonotonicUs(lastUs) - lastUs;
+    recordEdgeError(timeline, 0, startMonoUs + shiftUs - firstMonoUs);
+    recordEdgeError(timeline, timeline.size() - 1, shiftUs + offsetUs - endOffsetUs);
+    return true;
+}
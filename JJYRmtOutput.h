@@ -0,0 +1,54 @@
+/*
+ * Copyright (c) 2025 Tomosawa
+ * All rights reserved.
+ *
+ * This code is part of the WiFi2JJY project.
+ * GitHub: https://github.com/Tomosawa/WIFI2JJY
+ */
+#ifndef JJYRMTOUTPUT_H
+#define JJYRMTOUTPUT_H
+
+#include <Arduino.h>
+#include "driver/rmt_tx.h"
+#include "JJYOutput.h"
+
+// RMT 硬件输出：把一帧的边沿时间表转换成 1MHz 的 RMT 符号，由外设按微秒精度
+// 输出整分钟的脉冲串，发送期间任务阻塞等待完成，CPU 空闲
+class JJYRmtOutput : public JJYOutput {
+public:
+    // idleLevel 为协议的空闲电平：通道按它决定是否反相，使 RMT 空闲（0）即DA空闲电平
+    JJYRmtOutput(int daPin, uint8_t idleLevel);
+    ~JJYRmtOutput();
+
+    bool begin() override;
+    const char* name() const override { return "rmt"; }
+
+protected:
+    bool play(const JJYTimeline& timeline) override;
+
+private:
+    static constexpr uint32_t RESOLUTION_HZ = 1000000;   // 1 tick = 1us
+    static constexpr uint32_t MAX_TICKS = 32767;         // 单个半符号的最大时长
+    // 一帧60秒切成不超过 MAX_TICKS 的片段，再加上每个边沿的零头
+    static constexpr int MAX_SYMBOLS = 1024;
+    static constexpr int64_t LEAD_US = 5000;             // 提前唤醒准备符号的时间
+    static constexpr int64_t BUILD_MARGIN_US = 1000;     // 填充符号所需的余量
+    static constexpr int64_t STOP_MARGIN_US = 2000;      // 停止请求：在要停的边沿之前多久关闭通道
+    // rmt_transmit 调用到引脚开始输出的固定延迟（按板子实测填写）
+    static constexpr int64_t START_LATENCY_US = 0;
+
+    int m_daPin;
+    bool m_invert;  // DA空闲电平为1时反相输出
+    rmt_channel_handle_t m_channel;
+    rmt_encoder_handle_t m_encoder;
+    rmt_symbol_word_t m_symbols[MAX_SYMBOLS];
+    int m_halfCount;  // 已填充的半符号数
+
+    bool appendHalf(uint32_t level, uint32_t ticks);
+    bool appendLevel(uint8_t daLevel, int64_t durationUs);
+    // DA电平对应的 RMT 电平
+    uint32_t rmtLevel(uint8_t daLevel) const { return (daLevel != 0) != m_invert ? 1 : 0; }
+    void setHalf(int index, uint32_t level, uint32_t ticks);
+};
+
+#endif // JJYRMTOUTPUT_H
@@ -0,0 +1,77 @@
+/*
+ * Copyright (c) 2025 Tomosawa
+ * All rights reserved.
+ *
+ * This code is part of the WiFi2JJY project.
+ * GitHub: https://github.com/Tomosawa/WIFI2JJY
+ */
+#include "JJYSchedule.h"
+
+JJYSchedule::JJYSchedule() : m_epochUs(0), m_count(0), m_channelMask(0), m_idleHighMask(0) {
+}
+
+void JJYSchedule::merge(const JJYTimeline* const timelines[], int count) {
+    m_count = 0;
+    m_channelMask = 0;
+    m_idleHighMask = 0;
+    if (count > MAX_CHANNELS) {
+        count = MAX_CHANNELS;
+    }
+    m_epochUs = count > 0 ? timelines[0]->epochUs() : 0;
+
+    int next[MAX_CHANNELS];
+    for (int c = 0; c < count; c++) {
+        next[c] = 0;
+        m_channelMask |= 1U << c;
+        if (timelines[c]->idleLevel()) {
+            m_idleHighMask |= 1U << c;
+        }
+    }
+
+    // 各时间表已按时间排序，每次取各通道队首中最早的边沿（通道数很少，线性比较即可）
+    while (true) {
+        int channel = -1;
+        int64_t earliest = 0;
+        for (int c = 0; c < count; c++) {
+            if (next[c] < timelines[c]->size()) {
+                int64_t t = timelines[c]->timeUs(next[c]);
+                if (channel < 0 || t < earliest) {
+                    channel = c;
+                    earliest = t;
+                }
+            }
+        }
+        if (channel < 0) {
+            break;
+        }
+
+        const JJYTimeline& timeline = *timelines[channel];
+        const int index = next[channel]++;
+        const int32_t offsetUs = (int32_t)(timeline.timeUs(index) - m_epochUs);
+        if (m_count == 0 || m_steps[m_count - 1].offsetUs != offsetUs) {
+            m_steps[m_count++] = {offsetUs, 0, 0, 0, 0};
+        }
+        JJYScheduleStep& step = m_steps[m_count - 1];
+        const uint8_t bit = (uint8_t)(1U << channel);
+        if (timeline[index].level) {
+            step.setMask |= bit;
+            step.clearMask &= (uint8_t)~bit;
+        } else {
+            step.clearMask |= bit;
+            step.setMask &= (uint8_t)~bit;
+        }
+        if (timeline.startsPulse(index)) {
+            step.pulseMask |= bit;
+        } else {
+            step.pulseMask &= (uint8_t)~bit;
+        }
+    }
+
+    // 从全部空闲开始，记下每一步之前哪些通道在脉冲中
+    uint8_t levels = m_idleHighMask;
+    for (int i = 0; i < m_count; i++) {
+        JJYScheduleStep& step = m_steps[i];
+        step.activeMask = (uint8_t)((levels ^ m_idleHighMask) & m_channelMask);
+        levels = (uint8_t)((levels | step.setMask) & ~step.clearMask);
+    }
+}
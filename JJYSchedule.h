@@ -0,0 +1,61 @@
+/*
+ * Copyright (c) 2025 Tomosawa
+ * All rights reserved.
+ *
+ * This code is part of the WiFi2JJY project.
+ * GitHub: https://github.com/Tomosawa/WIFI2JJY
+ */
+#ifndef JJYSCHEDULE_H
+#define JJYSCHEDULE_H
+
+#include <stdint.h>
+#include "JJYTimeline.h"
+
+// 一个输出步骤：在该时刻一次性置位/清零的通道（第 i 位为第 i 路）
+struct JJYScheduleStep {
+    int32_t offsetUs;    // 相对分钟起点的偏移
+    uint8_t setMask;     // 变为高电平的通道
+    uint8_t clearMask;   // 变为低电平的通道
+    uint8_t pulseMask;   // 其中离开空闲电平（开始脉冲）的通道
+    uint8_t activeMask;  // 这一步之前正处在脉冲中的通道
+};
+
+// 多路输出的合并边沿队列：把同一分钟里各通道的时间表归并成按时间排序的步骤，
+// 同一时刻的边沿（例如各协议的秒首）合并为一步，由一个播放任务（或一个定时器）按序输出。
+// 满足 JJYPlayback 对帧的要求，由 JJYScheduler 播放
+class JJYSchedule {
+public:
+    static constexpr int MAX_CHANNELS = 4;
+    static constexpr int MAX_STEPS = MAX_CHANNELS * JJYTimeline::MAX_EDGES;
+
+    JJYSchedule();
+
+    // 归并 count 个通道的时间表，第 i 个时间表输出到第 i 路。
+    // 各时间表须为同一分钟（epochUs 相同），边沿补偿在归并前各自加上
+    void merge(const JJYTimeline* const timelines[], int count);
+
+    int64_t epochUs() const { return m_epochUs; }
+    int64_t endUs() const { return m_epochUs + JJYTimeline::FRAME_US; }
+    int size() const { return m_count; }
+    const JJYScheduleStep& operator[](int index) const { return m_steps[index]; }
+
+    // 第 index 步的挂钟时间（微秒）
+    int64_t timeUs(int index) const { return m_epochUs + m_steps[index].offsetUs; }
+
+    // 第 index 步是否在所有通道都空闲时开始新的脉冲（各协议的秒首）。停止请求 STOP_AT_PULSE
+    // 停在这样的一步之前；别的通道还在脉冲中时（例如 MSF 的第二个脉冲）不停，让那个脉冲照常结束
+    bool startsPulse(int index) const { return m_steps[index].pulseMask != 0 && m_steps[index].activeMask == 0; }
+
+    // 参与归并的通道，以及空闲电平为高的通道
+    uint8_t channelMask() const { return m_channelMask; }
+    uint8_t idleHighMask() const { return m_idleHighMask; }
+
+private:
+    int64_t m_epochUs;
+    int m_count;
+    uint8_t m_channelMask;
+    uint8_t m_idleHighMask;
+    JJYScheduleStep m_steps[MAX_STEPS];
+};
+
+#endif // JJYSCHEDULE_H
@@ -0,0 +1,41 @@
+/*
+ * Copyright (c) 2025 Tomosawa
+ * All rights reserved.
+ *
+ * This code is part of the WiFi2JJY project.
+ * GitHub: https://github.com/Tomosawa/WIFI2JJY
+ */
+#ifndef JJYSCHEDULER_H
+#define JJYSCHEDULER_H
+
+#include <stdint.h>
+#include "JJYPlayback.h"
+#include "JJYSchedule.h"
+
+// 多路调度输出：按合并后的边沿队列（JJYSchedule）同时输出几路 DA。无论有几路输出，
+// 都只有一个播放任务（定时器后端再加一个 GPTimer），单核 ESP32-C3 上不会有多个任务争抢。
+// 待播槽、停止请求和截止时间与单路输出相同（JJYPlayback）。
+class JJYScheduler : public JJYPlayback<JJYSchedule> {
+public:
+    static constexpr int MAX_CHANNELS = JJYSchedule::MAX_CHANNELS;
+
+    // 第 i 路输出到 pins[i]，空闲电平为 idleHighMask 的第 i 位；超过 MAX_CHANNELS 的通道被忽略
+    JJYScheduler(const int pins[], int count, uint8_t idleHighMask)
+        : m_count(count > MAX_CHANNELS ? MAX_CHANNELS : count), m_idleHighMask(idleHighMask) {
+        for (int i = 0; i < m_count; i++) {
+            m_pins[i] = pins[i];
+        }
+    }
+
+    int channelCount() const { return m_count; }
+
+protected:
+    int m_pins[MAX_CHANNELS];
+    int m_count;
+    uint8_t m_idleHighMask;
+
+    // 所有通道
+    uint8_t channelMask() const { return (uint8_t)((1U << m_count) - 1); }
+};
+
+#endif // JJYSCHEDULER_H
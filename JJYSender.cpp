@@ -6,243 +6,310 @@
  * GitHub: https://github.com/Tomosawa/WIFI2JJY
  */
 #include "JJYSender.h"
+#include <stdio.h>
 #include "IOPin.h"
+#include "HAL.h"
+#include "JJYSoftwareOutput.h"
 
-JJYSender::JJYSender(int daPin) : m_daPin(daPin) {
-    // 初始化DA引脚
-    pinMode(m_daPin, OUTPUT);
-    digitalWrite(m_daPin, HIGH);
-    Serial.printf("[JJYSender] DA pin configured as OUTPUT, HIGH (Pin: %d)\n", m_daPin);
+JJYSender::JJYSender(int daPin, OutputBackend backend, TimeCodeProtocol protocol, uint32_t carrierHz)
+    : m_daPin(daPin), m_code(TimeCode::get(protocol)), m_backend(backend), m_frameCache(m_code) {
+    // 初始化DA引脚为协议的空闲电平
+    const bool idleHigh = m_code.shapes->idleLevel != 0;
+    hal::pinOutput(m_daPin, idleHigh);
+    hal::log("[JJYSender] DA pin configured as OUTPUT, %s (Pin: %d, %s)\n",
+             idleHigh ? "HIGH" : "LOW", m_daPin, m_code.name);
+
+    m_output = createOutput(m_daPin, backend, m_code, carrierHz);
+    m_output->setJitter(&m_jitter);
 }
 
-// 编码JJY时间格式
-void JJYSender::encodeJJY(int jjyBits[60], struct tm* timeinfo) {
-  // 位置标记（Marker，低电平0.2秒）
-  jjyBits[0] = 2;   // 分钟标记
-  jjyBits[9] = 2;   // 位置标记P1
-  jjyBits[19] = 2;  // 位置标记P2
-  jjyBits[29] = 2;  // 位置标记P3
-  jjyBits[39] = 2;  // 位置标记P4
-  jjyBits[49] = 2;  // 位置标记P5
-  jjyBits[59] = 2;  // 位置标记P0
-  
-  // 分钟（1-8位）：BCD编码
-  int minute = timeinfo->tm_min;
-  int min_tens = minute / 10;  // 十位（0-5）
-  int min_ones = minute % 10;  // 个位（0-9）
-  
-  // 十位分钟（1-3位）：最大值5，需要3位
-  jjyBits[1] = (min_tens & 0x04) ? 1 : 0;  // 40分
-  jjyBits[2] = (min_tens & 0x02) ? 1 : 0;  // 20分
-  jjyBits[3] = (min_tens & 0x01) ? 1 : 0;  // 10分
-  
-  // 第4位保留
-  jjyBits[4] = 0;
-  
-  // 个位分钟（5-8位）：0-9，需要4位
-  jjyBits[5] = (min_ones & 0x08) ? 1 : 0;  // 8分
-  jjyBits[6] = (min_ones & 0x04) ? 1 : 0;  // 4分
-  jjyBits[7] = (min_ones & 0x02) ? 1 : 0;  // 2分
-  jjyBits[8] = (min_ones & 0x01) ? 1 : 0;  // 1分
-  
-  // 小时（12-18位）：BCD编码
-  int hour = timeinfo->tm_hour;
-  int hour_tens = hour / 10;  // 十位（0-2）
-  int hour_ones = hour % 10;  // 个位（0-9）
-  
-  // 十位小时（12-13位）：最大值2，需要2位
-  jjyBits[12] = (hour_tens & 0x02) ? 1 : 0;  // 20时
-  jjyBits[13] = (hour_tens & 0x01) ? 1 : 0;  // 10时
-  
-  // 第14位保留
-  jjyBits[14] = 0;
-  
-  // 个位小时（15-18位）：0-9，需要4位
-  jjyBits[15] = (hour_ones & 0x08) ? 1 : 0;  // 8时
-  jjyBits[16] = (hour_ones & 0x04) ? 1 : 0;  // 4时
-  jjyBits[17] = (hour_ones & 0x02) ? 1 : 0;  // 2时
-  jjyBits[18] = (hour_ones & 0x01) ? 1 : 0;  // 1时
-  
-  // 当年第几天（22-33位）：1-366，需要9位（实际用12位）
-  int dayOfYear = timeinfo->tm_yday + 1;  // tm_yday从0开始
-  
-  // 百位天数（22-23位）：最大值3，需要2位
-  int day_hundreds = dayOfYear / 100;
-  jjyBits[22] = (day_hundreds & 0x02) ? 1 : 0;  // 200天
-  jjyBits[23] = (day_hundreds & 0x01) ? 1 : 0;  // 100天
-  
-  // 第24位保留
-  jjyBits[24] = 0;
-  
-  // 十位天数（25-28位）：0-9，需要4位
-  int day_tens = (dayOfYear % 100) / 10;
-  jjyBits[25] = (day_tens & 0x08) ? 1 : 0;  // 80天
-  jjyBits[26] = (day_tens & 0x04) ? 1 : 0;  // 40天
-  jjyBits[27] = (day_tens & 0x02) ? 1 : 0;  // 20天
-  jjyBits[28] = (day_tens & 0x01) ? 1 : 0;  // 10天
-  
-  // 个位天数（30-33位）：0-9，需要4位
-  int day_ones = dayOfYear % 10;
-  jjyBits[30] = (day_ones & 0x08) ? 1 : 0;  // 8天
-  jjyBits[31] = (day_ones & 0x04) ? 1 : 0;  // 4天
-  jjyBits[32] = (day_ones & 0x02) ? 1 : 0;  // 2天
-  jjyBits[33] = (day_ones & 0x01) ? 1 : 0;  // 1天
-  
-  // 奇偶校验位1（36位）：小时和分钟的奇偶校验
-  int parity1 = 0;
-  for (int i = 12; i <= 18; i++) {
-    if (jjyBits[i] == 1) parity1++;
-  }
-  for (int i = 1; i <= 8; i++) {
-    if (jjyBits[i] == 1) parity1++;
-  }
-  jjyBits[36] = (parity1 % 2 == 1) ? 1 : 0;
-  
-  // 奇偶校验位2（37位）：年积日的奇偶校验
-  int parity2 = 0;
-  for (int i = 22; i <= 33; i++) {
-    if (jjyBits[i] == 1) parity2++;
-  }
-  jjyBits[37] = (parity2 % 2 == 1) ? 1 : 0;
-  
-  // 年份（41-48位）：BCD编码，只编码后两位（00-99）
-  int year = (timeinfo->tm_year + 1900) % 100;
-  int year_tens = year / 10;
-  int year_ones = year % 10;
-  
-  // 十位年份（41-44位）：0-9，需要4位
-  jjyBits[41] = (year_tens & 0x08) ? 1 : 0;  // 80年
-  jjyBits[42] = (year_tens & 0x04) ? 1 : 0;  // 40年
-  jjyBits[43] = (year_tens & 0x02) ? 1 : 0;  // 20年
-  jjyBits[44] = (year_tens & 0x01) ? 1 : 0;  // 10年
-  
-  // 个位年份（45-48位）：0-9，需要4位
-  jjyBits[45] = (year_ones & 0x08) ? 1 : 0;  // 8年
-  jjyBits[46] = (year_ones & 0x04) ? 1 : 0;  // 4年
-  jjyBits[47] = (year_ones & 0x02) ? 1 : 0;  // 2年
-  jjyBits[48] = (year_ones & 0x01) ? 1 : 0;  // 1年
-  
-  // 星期（50-52位）：0=星期日，1=星期一，...，6=星期六
-  int dayOfWeek = timeinfo->tm_wday;
-  jjyBits[50] = (dayOfWeek & 0x04) ? 1 : 0;  // 4
-  jjyBits[51] = (dayOfWeek & 0x02) ? 1 : 0;  // 2
-  jjyBits[52] = (dayOfWeek & 0x01) ? 1 : 0;  // 1
-  
-  // 其他位保留为0或用于特殊功能
-  // 第10,11,20,21,34,35,38,40,53-58位保留
+JJYSender::~JJYSender() {
+    delete m_output;
+    delete m_trace;
+}
 
+void JJYSender::enableTrace() {
+  if (m_trace == nullptr) {
+    m_trace = new JJYTraceCapture();
+  }
+  m_output->setTrace(m_trace);
 }
 
-// 发送 JJY 信号
-void JJYSender::sendJJYSignal(int jjyBits[60]) {
-   unsigned long startMillis = millis();
-  
-  for (int second = 0; second < 60; second++) {
-    unsigned long targetMillis = startMillis + (second * 1000UL);
-    
-    // 先粗略等待
-    long delayTime = targetMillis - millis();
-    if (delayTime > 10) {
-      delay(delayTime - 10);
-    }
-    // 等待到准确的秒数
-    while (millis() < targetMillis) {
-      yield();
-    }
-    
-    // 发送脉冲（JJY是负逻辑：正常高电平，脉冲时低电平）
-    digitalWrite(m_daPin, LOW);  // 开始脉冲
-    
-    int pulseWidth;
-    if (jjyBits[second] == 2) {
-      // Marker: 低电平0.2秒
-      pulseWidth = 200;
-    } else if (jjyBits[second] == 1) {
-      // 数据位1: 低电平0.5秒
-      pulseWidth = 500;
-    } else {
-      // 数据位0: 低电平0.8秒
-      pulseWidth = 800;
-    }
-    
-    delay(pulseWidth);
-    digitalWrite(m_daPin, HIGH);  // 结束脉冲，回到高电平
-
-    // 保证剩余时间保持高电平直到下一秒
-    delayTime = targetMillis + 1000UL - millis();
-    if (delayTime > 10) {
-      delay(delayTime - 10);
-    }
-    while (millis() < targetMillis + 1000UL) {
-      yield();
-    }
+static void traceSink(void* context, const char* data, size_t length) {
+  (void)context;
+  hal::logWrite(data, length);
+}
+
+void JJYSender::dumpTrace() {
+  if (m_trace == nullptr) {
+    return;
+  }
+  // 复制下面的 VCD 部分保存为 .vcd，用 PulseView 或 GTKWave 打开
+  hal::log("[JJYSender] --- VCD trace begin ---\n");
+  // 时间0为第一条记录所在的整秒，注释里给出它的 UNIX 时间
+  m_trace->setMonotonicOffset(TimeSync::wallTimeUs() - hal::monotonicUs());
+  int64_t originUs = 0;
+  if (m_trace->oldestTime(originUs)) {
+    originUs -= originUs % 1000000LL;
+  }
+  JJYTraceWriter writer(traceSink, nullptr);
+  char comment[80];
+  snprintf(comment, sizeof(comment), "WiFi2JJY %s DA/PON, t=0 at unix %lld", m_code.name,
+           (long long)(originUs / 1000000LL));
+  writer.begin(originUs, comment);
+  m_trace->drainTo(writer);
+  if (m_trace->dropped() > 0) {
+    snprintf(comment, sizeof(comment), "%u transitions dropped (buffer full)", (unsigned)m_trace->dropped());
+    writer.comment(comment);
+  }
+  writer.end(TimeSync::wallTimeUs());
+  hal::log("[JJYSender] --- VCD trace end ---\n");
+}
+
+// 按边沿时间表发送一帧 JJY 信号，输出完毕后返回
+void JJYSender::sendJJYSignal(const JJYTimeline& timeline) {
+  if (!m_output->submit(timeline, FRAME_TIMEOUT_MS) || !m_output->waitIdle(FRAME_TIMEOUT_MS)) {
+    hal::log("[JJYSender] %s output failed to transmit frame\n", m_output->name());
   }
 }
 
 bool JJYSender::startAsyncSend(TimeSync* timeSync) {
-  if (m_taskHandle != nullptr) {
+  if (m_taskRunning) {
     return false; // 已有任务在跑
   }
   m_timeSync = timeSync;
   m_taskDone = false;
-  xTaskCreate(
-      sendTask,
-      "JJYSendTask",
-      8192,
-      this,
-      3,
-      &m_taskHandle);
-  return m_taskHandle != nullptr;
+
+  if (!startOutput()) {
+    return false;
+  }
+  hal::log("[JJYSender] Using %s output\n", m_output->name());
+
+  // PON 一拉高就停止输出，不等当前帧结束
+  m_output->clearStop();
+  if (m_trace != nullptr) {
+    m_trace->recordPon(hal::pinRead(PIN_PON), hal::monotonicUs());
+  }
+  m_ponCaptured = m_ponStop != PON_STOP_FRAME_END && hal::pinCapture(PIN_PON, onPonEdge, this);
+  if (m_ponStop != PON_STOP_FRAME_END && !m_ponCaptured) {
+    hal::log("[JJYSender] Cannot attach PON interrupt, checking PON after each frame\n");
+  }
+
+  m_taskRunning = true;
+  if (!hal::startTask(sendTask, "JJYSendTask", 8192, this, 3)) {
+    m_taskRunning = false;
+    return false;
+  }
+  return true;
+}
+
+// NVS 中区分各后端补偿的键
+static const char* backendKey(JJYSender::OutputBackend backend) {
+  static const char* const KEYS[] = {"software", "rmt", "timer", "carrier", "i2s"};
+  return KEYS[backend];
+}
+
+bool JJYSender::startOutput() {
+  // 启动输出后端，硬件后端不可用时退回软件输出
+  if (!m_output->start()) {
+    hal::log("[JJYSender] %s output unavailable, falling back to software\n", m_output->name());
+    delete m_output;
+    m_output = new JJYSoftwareOutput(m_daPin, m_code.shapes->idleLevel);
+    m_backend = BACKEND_SOFTWARE;
+    m_output->setTrace(m_trace);
+    m_output->setJitter(&m_jitter);
+    if (!m_output->start()) {
+      return false;
+    }
+  }
+
+  m_output->setDeadline(m_deadlineUs);
+
+  JJYEdgeCompensation saved;
+  if (JJYEdgeCompensation::load(backendKey(m_backend), saved) &&
+      (saved.toPulseUs != m_compensation.toPulseUs || saved.toIdleUs != m_compensation.toIdleUs)) {
+    hal::log("[JJYSender] Edge compensation for %s: to pulse %+ld us, to idle %+ld us\n", m_output->name(),
+             (long)saved.toPulseUs, (long)saved.toIdleUs);
+  }
+  m_compensation = saved;
+  return true;
+}
+
+bool JJYSender::calibrate(int capturePin, uint32_t toleranceUs, bool force) {
+  if (m_taskRunning || !startOutput()) {
+    return false;
+  }
+  if (!force && JJYEdgeCompensation::load(backendKey(m_backend), m_compensation)) {
+    return true;
+  }
+  if (m_backend == BACKEND_CARRIER || m_backend == BACKEND_I2S) {
+    hal::log("[JJYSender] %s backend has no digital DA edges to calibrate\n", backendKey(m_backend));
+    return false;
+  }
+
+  JJYCalibrator calibrator(*m_output, capturePin, m_code.shapes->idleLevel);
+  JJYCalibrator::Result result;
+  bool ok = calibrator.run(toleranceUs, result);
+  // 测试脉冲也计入了帧完成计数，不能留给发送任务
+  while (m_output->waitFrameDone(0)) {
+  }
+  if (!ok) {
+    return false;
+  }
+  m_compensation = result.compensation;
+  if (!m_compensation.save(backendKey(m_backend))) {
+    hal::log("[JJYSender] Failed to save edge compensation\n");
+  }
+  return true;
 }
 
+void JJYSender::prefillFrames(time_t firstMinute) {
+  uint32_t generation = m_timeSync ? m_timeSync->clockGeneration() : 0;
+  m_frameCache.prefill(firstMinute, generation);
+}
+
+bool JJYSender::prepareFrame(time_t minute) {
+  // 取出空闲时预编码好的帧；未命中（时钟被步进调整或输出停顿后重新起步）时现场编码
+  uint32_t generation = m_timeSync ? m_timeSync->clockGeneration() : 0;
+  JJYFrame frame;
+  bool cached = m_frameCache.lookup(minute, generation, frame);
+  if (!cached) {
+    m_code.encode(frame, minute, TIME_CODE_NATIVE_ZONE);
+    m_frameCacheMisses++;
+  }
+  // 整帧的边沿都锚定在该分钟的挂钟起点上
+  m_timeline.compile(frame, (int64_t)minute * 1000000LL, *m_code.shapes);
+  if (!m_compensation.isZero()) {
+    m_timeline.advanceEdges(m_compensation.toPulseUs, m_compensation.toIdleUs);
+  }
+  return cached;
+}
+
+void JJYSender::onPonEdge(void* arg, bool level, int64_t monoUs) {
+  JJYSender* self = static_cast<JJYSender*>(arg);
+  if (self->m_trace != nullptr) {
+    self->m_trace->recordPon(level, monoUs);
+  }
+  if (level) {
+    self->m_output->requestStop(self->m_ponStop == PON_STOP_IMMEDIATE ? JJYOutput::STOP_NOW
+                                                                       : JJYOutput::STOP_AT_PULSE);
+  }
+}
+
+// 连续发送：第 N 帧输出期间第 N+1 帧已经在待播槽中，
+// 日志和 PON 检查都在帧输出结束后的空闲时间里进行，不在关键路径上
 void JJYSender::sendTask(void* param) {
   JJYSender* self = static_cast<JJYSender*>(param);
+  JJYOutput* output = self->m_output;
+  self->m_jitter.beginSession(self->m_code.shapes->idleLevel, self->m_compensation.toPulseUs,
+                              self->m_compensation.toIdleUs);
+
+  // 第一帧从下一个整分钟开始
+  time_t minute = (time_t)(TimeSync::wallTimeUs() / 60000000LL + 1) * 60;
+  self->m_frameCacheMisses = 0;
+  self->prefillFrames(minute);
+  self->prepareFrame(minute);
+  output->submit(self->m_timeline, FRAME_TIMEOUT_MS);
+  time_t playing = minute;
+
+  // 放弃已排队的帧，从下一个整分钟重新开始
+  auto restart = [&]() {
+    output->cancel();
+    output->waitIdle(FRAME_TIMEOUT_MS);
+    while (output->waitFrameDone(0)) {
+    }
+    minute = (time_t)(TimeSync::wallTimeUs() / 60000000LL) * 60;
+    playing = minute + 60;
+  };
+
   int loopCount = 0;
   while (true) {
     loopCount++;
-    Serial.printf("\n--- Loop Iteration %d ---\n", loopCount);
-
-    // 检查当前PON状态
-    Serial.print("[Loop] Current PON status: ");
-    Serial.println(digitalRead(PIN_PON) ? "HIGH" : "LOW");
-
-    // 每循环一次发送 60 秒时间码
-    time_t now = time(nullptr);
-    struct tm *timeinfo = localtime(&now);
-
-    Serial.printf(
-        "\nStart SendTime: %04d-%02d-%02d %02d:%02d Week %d (JJY Encode)\n",
-        timeinfo->tm_year + 1900, timeinfo->tm_mon + 1, timeinfo->tm_mday,
-        timeinfo->tm_hour, timeinfo->tm_min, timeinfo->tm_wday);
-    // 使用精确时间同步等待到下一个整分钟
-    Serial.println(
-        "[Loop] Waiting for next minute with precise synchronization...");
-    if (self->m_timeSync) {
-      self->m_timeSync->waitUntilNextMinuteRTC();
+
+    // 提前把下一帧放入待播槽，槽被占用时阻塞到当前帧开始输出
+    minute += 60;
+    bool cached = self->prepareFrame(minute);
+    if (!output->submit(self->m_timeline, FRAME_TIMEOUT_MS)) {
+      hal::log("[Loop] Output stalled, restarting at next minute\n");
+      restart();
+      continue;
+    }
+
+    // 两帧都已排队，当前帧输出期间预编码再往后的几分钟
+    self->prefillFrames(minute + 60);
+
+    // 等待正在输出的帧结束
+    if (!output->waitFrameDone(FRAME_TIMEOUT_MS)) {
+      hal::log("[Loop] Timed out waiting for frame to finish\n");
     }
-    // 获取当前时间（刚到下一分钟）
-    now = time(nullptr);
-    timeinfo = localtime(&now);
+    self->m_jitter.drain();
 
-    int frame[60] = {0};
-    self->encodeJJY(frame, timeinfo);
-    self->sendJJYSignal(frame);
+    struct tm sent;
+    localtime_r(&playing, &sent);
+    hal::log("\n--- Loop Iteration %d ---\n", loopCount);
+    hal::log(
+        "[Loop] Sent: %04d-%02d-%02d %02d:%02d Week %d (%s Encode)\n",
+        sent.tm_year + 1900, sent.tm_mon + 1, sent.tm_mday,
+        sent.tm_hour, sent.tm_min, sent.tm_wday, self->m_code.name);
+    const JJYFrameReport& report = output->report();
+    hal::log("[Loop] Frame timing (%s): start %+lld us, end %+lld us, max |%lld| us\n",
+             output->name(), (long long)report.startErrorUs,
+             (long long)report.endErrorUs, (long long)report.maxErrorUs);
+    if (report.missedIndex >= 0) {
+      hal::log("[Loop] Deadline missed: %s at edge %d (%+lld us), frame abandoned until next minute\n",
+               report.missedIndex == 0 ? "late start" : "overrun", report.missedIndex,
+               (long long)report.missedLateUs);
+    }
+    const bool stopped = report.stoppedIndex >= 0;
+    if (stopped) {
+      hal::log("[Loop] PON raised, output stopped at edge %d\n", report.stoppedIndex);
+    }
+    if (!cached) {
+      hal::log("[Loop] Frame cache miss, encoded before queuing\n");
+    }
+    // 按本地时钟直接发送（free-run）的唤醒不开无线，/status 不可用，误差估计只在这里可见
+    if (self->m_timeSync != nullptr) {
+      hal::log("[Clock] Source %s, error <= %lld us\n", TimeSync::sourceName(self->m_timeSync->source()),
+               (long long)self->m_timeSync->estimatedErrorUs());
+    }
+    playing += 60;
 
     // 发送一帧后主板可能立即关闭 PON（校时成功）
-    Serial.print("[Loop] Checking PON status after transmission... ");
-    bool ponStatus = digitalRead(PIN_PON);
-    Serial.println(ponStatus ? "HIGH" : "LOW");
+    hal::log("[Loop] Checking PON status after transmission... ");
+    bool ponStatus = hal::pinRead(PIN_PON);
+    // 接了 PON 中断时由中断按真实边沿记录，这里只在没有中断时记录
+    if (self->m_trace != nullptr && !self->m_ponCaptured) {
+      self->m_trace->recordPon(ponStatus, hal::monotonicUs());
+    }
+    hal::log("%s\n", ponStatus ? "HIGH" : "LOW");
 
     if (ponStatus) {
-      Serial.println(
-          "[Loop] PON is HIGH, Time synchronized, exiting loop to sleep");
+      hal::log("[Loop] PON is HIGH, Time synchronized, exiting loop to sleep\n");
+      hal::pinCapture(PIN_PON, nullptr, nullptr);
+      // 下一帧还在等待第一个边沿，中止它
+      output->cancel();
+      output->waitIdle(FRAME_TIMEOUT_MS);
       break;
     } else {
-      Serial.println("[Loop] PON is still LOW, will continue sending");
+      hal::log("[Loop] PON is still LOW, will continue sending\n");
+      // PON 中途拉高又回落（抖动，或钟表的脉冲）：清除停止请求，否则之后的帧一开始就被丢弃，
+      // 发送任务不再等待输出而空转。待播槽中的下一帧已按停止请求丢弃，从下一分钟重新排队
+      output->clearStop();
+      if (stopped) {
+        hal::log("[Loop] PON fell again after stopping the output, restarting at next minute\n");
+        restart();
+      }
     }
   }
 
+  // 本次发送的边沿迟到和脉宽误差分布
+  self->m_jitter.drain();
+  self->m_jitter.log(output->name());
+  const JJYDeadlineStats& deadline = output->deadlineStats();
+  hal::log("[Deadline] %lu frames, %lu late starts, %lu overruns, worst %+lld us\n",
+           (unsigned long)deadline.frames, (unsigned long)deadline.lateStarts,
+           (unsigned long)deadline.overruns, (long long)deadline.worstLateUs);
+
   self->m_taskDone = true;
-  self->m_taskHandle = nullptr;
-  vTaskDelete(nullptr);
-}
\ No newline at end of file
+  self->m_taskRunning = false;
+}
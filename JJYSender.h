@@ -8,33 +8,112 @@
 #ifndef JJYSENDER_H
 #define JJYSENDER_H
 
-#include <Arduino.h>
 #include <time.h>
 #include "TimeSync.h"
-#include "freertos/FreeRTOS.h"
-#include "freertos/task.h"
+#include "JJYFrame.h"
+#include "TimeCode.h"
+#include "JJYFrameCache.h"
+#include "JJYTimeline.h"
+#include "JJYOutput.h"
+#include "JJYCalibration.h"
 
 class JJYSender {
 public:
   
-    explicit JJYSender(int daPin);
+    // DA 输出后端
+    enum OutputBackend {
+        BACKEND_SOFTWARE,  // 任务内粗等 + 精确等待，hal::pinWrite 翻转（主机构建只有它）
+        BACKEND_RMT,       // RMT 外设硬件定时输出
+        BACKEND_TIMER,     // GPTimer 报警中断直接写 GPIO 寄存器
+        BACKEND_CARRIER,   // 引脚直接输出 LEDC 载波，按脉冲切换满幅/10%幅度（接环形天线）
+        BACKEND_I2S        // I2S 采样流输出调制波形（40000/3 Hz 音频，外接 I2S DAC）
+    };
 
-    void encodeJJY(int jjyBits[60], struct tm* timeinfo);
-    void sendJJYSignal(int jjyBits[60]);
+    // protocol 选择发送的时间码；carrierHz 用于 BACKEND_CARRIER / BACKEND_I2S，
+    // 为0时取协议的标准载波（JJY 可改为 60000 对应西日本）
+    explicit JJYSender(int daPin, OutputBackend backend = BACKEND_RMT,
+                       TimeCodeProtocol protocol = PROTOCOL_JJY, uint32_t carrierHz = 0);
+    ~JJYSender();
+
+    const TimeCode& timeCode() const { return m_code; }
+    void sendJJYSignal(const JJYTimeline& timeline);
 
     // 异步发送任务
     bool startAsyncSend(TimeSync* timeSync);
     bool isAsyncDone() const { return m_taskDone; }
-    TaskHandle_t getTaskHandle() const { return m_taskHandle; }
+    bool isAsyncRunning() const { return m_taskRunning; }
     void clearAsyncDone() { m_taskDone = false; }
+
+    // 记录 DA/PON 的电平变化（无锁缓冲，发送时不输出任何东西）
+    void enableTrace();
+    // 把记录以 VCD 格式原样输出到串口；在发送任务结束后调用，不影响发送时序
+    void dumpTrace();
+
+    // 边沿抖动统计：发送任务每帧累计一次，发送结束时输出到日志
+    const JJYJitterMonitor& jitter() const { return m_jitter; }
+
+    // 边沿延迟校准（DA 接回 capturePin）：测得的补偿存入 NVS，之后每次发送自动应用。
+    // 当前后端已有保存的补偿且 force 为 false 时直接使用；载波/I2S 后端不能校准。
+    // 在 startAsyncSend 之前调用，阻塞约十几秒
+    bool calibrate(int capturePin, uint32_t toleranceUs, bool force = false);
+    const JJYEdgeCompensation& compensation() const { return m_compensation; }
+
+    // 钟表拉高 PON（校时完成）时怎样结束发送：PON 引脚中断让输出后端停在
+    // 下一个整秒（默认，当前脉冲照常结束）或立即回到空闲电平，发送任务随即进入睡眠流程；
+    // PON_STOP_FRAME_END 为不用中断，每帧结束后才检查 PON。在 startAsyncSend 之前设置
+    enum PonStop {
+        PON_STOP_FRAME_END,
+        PON_STOP_NEXT_SECOND,
+        PON_STOP_IMMEDIATE
+    };
+    void setPonStop(PonStop mode) { m_ponStop = mode; }
+
+    // 边沿截止时间（默认20ms，0 为不检查）：发送任务被抢占导致边沿晚于此值时，
+    // 本帧不再输出，从下一分钟重新开始，不发送错乱的帧
+    void setEdgeDeadline(int64_t deadlineUs) { m_deadlineUs = deadlineUs; }
+    const JJYDeadlineStats& deadlineStats() const { return m_output->deadlineStats(); }
+
+    // 本次发送中预编码缓存未命中、排队前现场编码的帧数
+    uint32_t frameCacheMisses() const { return m_frameCacheMisses; }
     
 private:
     int m_daPin;  // DA引脚号
+    const TimeCode& m_code;  // 发送的时间码协议
+    OutputBackend m_backend;  // 实际使用的后端（退回软件输出后为 BACKEND_SOFTWARE）
+    JJYOutput* m_output;  // DA 输出后端
+    JJYEdgeCompensation m_compensation;  // 当前后端的边沿延迟补偿
+    int64_t m_deadlineUs = JJYOutput::DEFAULT_DEADLINE_US;
+    PonStop m_ponStop = PON_STOP_NEXT_SECOND;
+    bool m_ponCaptured = false;  // PON 中断是否已接上
     TimeSync* m_timeSync = nullptr;
+    JJYFrameCache m_frameCache;  // 预编码的后续分钟帧
+    volatile uint32_t m_frameCacheMisses = 0;
+    JJYTimeline m_timeline;      // 待排队帧的边沿时间表
+    JJYTraceCapture* m_trace = nullptr;  // DA/PON 记录，未启用时为 nullptr
+    JJYJitterMonitor m_jitter;           // 边沿迟到与脉宽误差统计
  
-    TaskHandle_t m_taskHandle = nullptr;
+    volatile bool m_taskRunning = false;
     volatile bool m_taskDone = false;
 
+    static constexpr uint32_t FRAME_TIMEOUT_MS = 125000;  // 略大于两帧
+
+    // 按 backend 创建输出后端；固件实现在 JJYSenderOutputs.cpp，
+    // 主机构建（host/JJYSenderOutputsHost.cpp）一律返回软件输出
+    static JJYOutput* createOutput(int daPin, OutputBackend backend, const TimeCode& code,
+                                   uint32_t carrierHz);
+
+    // 启动输出后端（不可用时退回软件输出）并读取它的边沿补偿
+    bool startOutput();
+
+    // 在空闲时间里预编码从 firstMinute 开始的几分钟
+    void prefillFrames(time_t firstMinute);
+
+    // 从缓存取 minute（整分的UTC秒数）的帧并编译到 m_timeline，返回是否命中缓存
+    bool prepareFrame(time_t minute);
+
+    // PON 引脚中断：拉高时让输出后端停止
+    static void onPonEdge(void* arg, bool level, int64_t monoUs);
+
     static void sendTask(void* param);
 };
 
@@ -0,0 +1,56 @@
+/*
+ * Copyright (c) 2025 Tomosawa
+ * All rights reserved.
+ *
+ * This code is part of the WiFi2JJY project.
+ * GitHub: https://github.com/Tomosawa/WIFI2JJY
+ */
+#include "JJYSender.h"
+#include "JJYMultiSender.h"
+#include "IOPin.h"
+#include "JJYSoftwareOutput.h"
+#include "JJYSoftwareScheduler.h"
+#include "JJYTimerScheduler.h"
+#include "JJYRmtOutput.h"
+#include "JJYTimerOutput.h"
+#include "FastPin.h"
+#include "CarrierPin.h"
+#include "JJYI2sOutput.h"
+
+// 固件的输出后端工厂：这些后端依赖 ESP32 外设，主机构建不编译本文件
+JJYOutput* JJYSender::createOutput(int daPin, OutputBackend backend, const TimeCode& code,
+                                   uint32_t carrierHz) {
+    if (carrierHz == 0) {
+        carrierHz = code.carrierHz;
+    }
+    const uint8_t idleLevel = code.shapes->idleLevel;
+
+    if (backend == BACKEND_RMT) {
+        return new JJYRmtOutput(daPin, idleLevel);
+    } else if (backend == BACKEND_TIMER) {
+        // DA 为默认引脚时用编译期引脚，中断里只剩一条寄存器写
+        if (daPin == PIN_DA) {
+            return new JJYTimerOutput<FastPin<(gpio_num_t)PIN_DA>>(idleLevel);
+        }
+        return new JJYTimerOutput<RuntimePin>(idleLevel, RuntimePin(daPin));
+    } else if (backend == BACKEND_CARRIER) {
+        return new JJYTimerOutput<CarrierPin>(idleLevel, CarrierPin(daPin, carrierHz, code.reducedPercent));
+    } else if (backend == BACKEND_I2S) {
+        // 音频载波取协议载波的分谐波，降幅按协议的调制深度
+        JJYWaveform::Config config;
+        config.carrierNum = carrierHz;
+        config.carrierDen = code.audioDivisor;
+        config.reducedAmplitude = (int16_t)(config.fullAmplitude * code.reducedPercent / 100);
+        return new JJYI2sOutput(PIN_I2S_BCLK, PIN_I2S_WS, daPin, config);
+    }
+    return new JJYSoftwareOutput(daPin, idleLevel);
+}
+
+// 多路调度只有软件和 GPTimer 两种输出，其余后端按定时器调度
+JJYScheduler* JJYMultiSender::createScheduler(const int pins[], int count, uint8_t idleHighMask,
+                                              JJYSender::OutputBackend backend) {
+    if (backend == JJYSender::BACKEND_SOFTWARE) {
+        return new JJYSoftwareScheduler(pins, count, idleHighMask);
+    }
+    return new JJYTimerScheduler(pins, count, idleHighMask);
+}
@@ -0,0 +1,52 @@
+/*
+ * Copyright (c) 2025 Tomosawa
+ * All rights reserved.
+ *
+ * This code is part of the WiFi2JJY project.
+ * GitHub: https://github.com/Tomosawa/WIFI2JJY
+ */
+#include "JJYSoftwareOutput.h"
+#include "HAL.h"
+#include "TimeSync.h"
+
+JJYSoftwareOutput::JJYSoftwareOutput(int daPin, uint8_t idleLevel) : m_daPin(daPin), m_idleLevel(idleLevel) {
+}
+
+bool JJYSoftwareOutput::begin() {
+    hal::pinOutput(m_daPin, m_idleLevel != 0);
+    return true;
+}
+
+bool JJYSoftwareOutput::waitUntilEdge(const JJYTimeline& timeline, int index) {
+    const int64_t targetWallUs = timeline[index].timeUs;
+    // 先粗略等待，cancel / requestStop 会提前唤醒
+    int64_t remainingUs;
+    while ((remainingUs = targetWallUs - TimeSync::wallTimeUs()) > 11000) {
+        if (sleepMs((uint32_t)((remainingUs - 10000) / 1000)) && (abortRequested() || stopBefore(timeline, index))) {
+            return false;
+        }
+    }
+    // 粗等之后按当前挂钟重新换算，再精确等到准确时刻
+    hal::waitUntilUs(TimeSync::wallToMonotonicUs(targetWallUs));
+    return true;
+}
+
+bool JJYSoftwareOutput::play(const JJYTimeline& timeline) {
+    // 每个边沿都单独对齐到挂钟，误差不会在帧内累积
+    for (int i = 0; i < timeline.size(); i++) {
+        // 中止，或有停止请求（钟表已校时）：回到空闲电平结束本帧
+        if (stopBefore(timeline, i) || !waitUntilEdge(timeline, i) || abortRequested()) {
+            hal::pinWrite(m_daPin, timeline.idleLevel() != 0);
+            return true;
+        }
+        // 被抢占得太久：不输出错位的边沿，回到空闲电平放弃本帧
+        if (deadlineMissed(i, TimeSync::wallTimeUs() - timeline[i].timeUs)) {
+            hal::pinWrite(m_daPin, timeline.idleLevel() != 0);
+            return true;
+        }
+        // JJY是负逻辑：正常高电平，脉冲时低电平
+        hal::pinWrite(m_daPin, timeline[i].level != 0);
+        recordEdgeError(timeline, i, TimeSync::wallTimeUs() - timeline[i].timeUs);
+    }
+    return true;
+}
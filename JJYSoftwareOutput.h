@@ -0,0 +1,35 @@
+/*
+ * Copyright (c) 2025 Tomosawa
+ * All rights reserved.
+ *
+ * This code is part of the WiFi2JJY project.
+ * GitHub: https://github.com/Tomosawa/WIFI2JJY
+ */
+#ifndef JJYSOFTWAREOUTPUT_H
+#define JJYSOFTWAREOUTPUT_H
+
+#include "JJYOutput.h"
+
+// 软件输出：在播放任务中粗等加自旋精等（hal::waitUntilUs），hal::pinWrite 翻转DA
+// 边沿精度受调度节拍、任务抢占和串口日志影响，保留用于对比
+class JJYSoftwareOutput : public JJYOutput {
+public:
+    // idleLevel 为协议的空闲电平（JJY 为1，WWVB/DCF77/MSF 为0），begin 时 DA 置于该电平
+    JJYSoftwareOutput(int daPin, uint8_t idleLevel);
+
+    bool begin() override;
+    const char* name() const override { return "software"; }
+
+protected:
+    bool play(const JJYTimeline& timeline) override;
+
+private:
+    int m_daPin;
+    uint8_t m_idleLevel;
+
+    // 等待到 timeline 第 index 个边沿的挂钟时刻；等待中被 cancel 或
+    // 停止请求打断（该边沿不再输出）时返回 false
+    bool waitUntilEdge(const JJYTimeline& timeline, int index);
+};
+
+#endif // JJYSOFTWAREOUTPUT_H
@@ -0,0 +1,64 @@
+/*
+ * Copyright (c) 2025 Tomosawa
+ * All rights reserved.
+ *
+ * This code is part of the WiFi2JJY project.
+ * GitHub: https://github.com/Tomosawa/WIFI2JJY
+ */
+#include "JJYSoftwareScheduler.h"
+#include "HAL.h"
+#include "TimeSync.h"
+
+JJYSoftwareScheduler::JJYSoftwareScheduler(const int pins[], int count, uint8_t idleHighMask)
+    : JJYScheduler(pins, count, idleHighMask) {
+}
+
+bool JJYSoftwareScheduler::begin() {
+    for (int i = 0; i < m_count; i++) {
+        hal::pinOutput(m_pins[i], (m_idleHighMask >> i) & 1);
+    }
+    return true;
+}
+
+void JJYSoftwareScheduler::writeChannels(uint8_t setMask, uint8_t clearMask) {
+    for (int i = 0; i < m_count; i++) {
+        if (setMask & (1U << i)) {
+            hal::pinWrite(m_pins[i], true);
+        } else if (clearMask & (1U << i)) {
+            hal::pinWrite(m_pins[i], false);
+        }
+    }
+}
+
+bool JJYSoftwareScheduler::waitUntilStep(const JJYSchedule& schedule, int index) {
+    const int64_t targetWallUs = schedule.timeUs(index);
+    // 先粗略等待，cancel / requestStop 会提前唤醒
+    int64_t remainingUs;
+    while ((remainingUs = targetWallUs - TimeSync::wallTimeUs()) > 11000) {
+        if (sleepMs((uint32_t)((remainingUs - 10000) / 1000)) && (abortRequested() || stopBefore(schedule, index))) {
+            return false;
+        }
+    }
+    // 粗等之后按当前挂钟重新换算，再精确等到准确时刻
+    hal::waitUntilUs(TimeSync::wallToMonotonicUs(targetWallUs));
+    return true;
+}
+
+bool JJYSoftwareScheduler::play(const JJYSchedule& schedule) {
+    // 每一步都单独对齐到挂钟，误差不会在帧内累积
+    for (int i = 0; i < schedule.size(); i++) {
+        // 中止，或有停止请求（钟表已校时）：所有通道回到空闲电平结束本帧
+        if (stopBefore(schedule, i) || !waitUntilStep(schedule, i) || abortRequested()) {
+            writeIdle();
+            return true;
+        }
+        // 被抢占得太久：不输出错位的边沿，回到空闲电平放弃本帧
+        if (deadlineMissed(i, TimeSync::wallTimeUs() - schedule.timeUs(i))) {
+            writeIdle();
+            return true;
+        }
+        writeChannels(schedule[i].setMask, schedule[i].clearMask);
+        recordEdgeError(schedule, i, TimeSync::wallTimeUs() - schedule.timeUs(i));
+    }
+    return true;
+}
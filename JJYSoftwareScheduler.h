@@ -0,0 +1,37 @@
+/*
+ * Copyright (c) 2025 Tomosawa
+ * All rights reserved.
+ *
+ * This code is part of the WiFi2JJY project.
+ * GitHub: https://github.com/Tomosawa/WIFI2JJY
+ */
+#ifndef JJYSOFTWARESCHEDULER_H
+#define JJYSOFTWARESCHEDULER_H
+
+#include "JJYScheduler.h"
+
+// 软件多路调度：与 JJYSoftwareOutput 相同，在播放任务中粗等加自旋精等，
+// 每一步用 hal::pinWrite 依次写该步跳变的引脚。主机构建和模拟只有它，固件中保留用于对比
+class JJYSoftwareScheduler : public JJYScheduler {
+public:
+    JJYSoftwareScheduler(const int pins[], int count, uint8_t idleHighMask);
+
+    bool begin() override;
+    const char* name() const override { return "software"; }
+
+protected:
+    bool play(const JJYSchedule& schedule) override;
+
+private:
+    // 把 setMask 中的通道置高、clearMask 中的通道置低
+    void writeChannels(uint8_t setMask, uint8_t clearMask);
+
+    // 所有通道回到空闲电平
+    void writeIdle() { writeChannels(m_idleHighMask, (uint8_t)(channelMask() & ~m_idleHighMask)); }
+
+    // 等待到 schedule 第 index 步的挂钟时刻；等待中被 cancel 或
+    // 停止请求打断（该步不再输出）时返回 false
+    bool waitUntilStep(const JJYSchedule& schedule, int index);
+};
+
+#endif // JJYSOFTWARESCHEDULER_H
@@ -0,0 +1,51 @@
+/*
+ * Copyright (c) 2025 Tomosawa
+ * All rights reserved.
+ *
+ * This code is part of the WiFi2JJY project.
+ * GitHub: https://github.com/Tomosawa/WIFI2JJY
+ */
+#include "JJYTimeline.h"
+
+JJYTimeline::JJYTimeline() : m_epochUs(0), m_count(0), m_idleLevel(1) {
+}
+
+void JJYTimeline::clear(int64_t epochUs, uint8_t idleLevel) {
+    m_epochUs = epochUs;
+    m_count = 0;
+    m_idleLevel = idleLevel;
+}
+
+bool JJYTimeline::append(int64_t timeUs, uint8_t level) {
+    if (m_count >= MAX_EDGES) {
+        return false;
+    }
+    m_edges[m_count++] = {timeUs, level};
+    return true;
+}
+
+void JJYTimeline::advanceEdges(int64_t toPulseUs, int64_t toIdleUs) {
+    for (int i = 0; i < m_count; i++) {
+        m_edges[i].timeUs -= m_edges[i].level != m_idleLevel ? toPulseUs : toIdleUs;
+    }
+}
+
+void JJYTimeline::compile(const JJYFrame& frame, int64_t epochUs, const TimeCodeShapes& shapes) {
+    m_epochUs = epochUs;
+    m_count = 0;
+    m_idleLevel = shapes.idleLevel;
+
+    // 每秒按码元查形状表，形状给出相对该秒开始的跳变
+    for (int second = 0; second < 60; second++) {
+        const TimeCodePulse& pulse = (shapes.specialMask & frameSecondBit(second))
+                                         ? shapes.special
+                                         : shapes.symbols[frame.symbol(second)];
+        if (m_count + pulse.count > MAX_EDGES) {
+            break;
+        }
+        int64_t startUs = epochUs + second * SECOND_US;
+        for (int i = 0; i < pulse.count; i++) {
+            m_edges[m_count++] = {startUs + pulse.edges[i].offsetUs, pulse.edges[i].level};
+        }
+    }
+}
@@ -0,0 +1,63 @@
+/*
+ * Copyright (c) 2025 Tomosawa
+ * All rights reserved.
+ *
+ * This code is part of the WiFi2JJY project.
+ * GitHub: https://github.com/Tomosawa/WIFI2JJY
+ */
+#ifndef JJYTIMELINE_H
+#define JJYTIMELINE_H
+
+#include <stdint.h>
+#include "JJYFrame.h"
+#include "TimeCode.h"
+
+// 一次电平跳变：绝对时间（挂钟微秒，UTC）与跳变后的DA电平
+struct JJYEdge {
+    int64_t timeUs;
+    uint8_t level;
+};
+
+// 帧的边沿时间表：把一帧编译成锚定在分钟起点的绝对跳变序列。
+// 输出后端（定时器中断、RMT、仿真、波形导出）只需按序消费跳变，
+// 输出时序与编码解耦，也可以在主机上直接检查边沿时间。
+class JJYTimeline {
+public:
+    // 每秒一个脉冲的两个边沿；MSF 仅 DUT1 所在的第1-16秒可能出现 A=0、B=1 的双脉冲
+    static constexpr int MAX_EDGES = 2 * 60 + 2 * 16;
+    static constexpr int64_t SECOND_US = 1000000;
+    static constexpr int64_t FRAME_US = 60 * SECOND_US;
+
+    JJYTimeline();
+
+    // 按协议的脉冲形状表编译 frame，epochUs 为该分钟第0秒开始的挂钟时间（微秒）
+    void compile(const JJYFrame& frame, int64_t epochUs, const TimeCodeShapes& shapes = JJYCode::SHAPES);
+
+    // 手工构造时间表（例如校准用的测试脉冲）：清空后按时间顺序逐个追加边沿
+    void clear(int64_t epochUs, uint8_t idleLevel);
+    bool append(int64_t timeUs, uint8_t level);
+
+    // 补偿输出延迟：进入脉冲（离开空闲电平）的边沿提前 toPulseUs，
+    // 回到空闲电平的边沿提前 toIdleUs
+    void advanceEdges(int64_t toPulseUs, int64_t toIdleUs);
+
+    int64_t epochUs() const { return m_epochUs; }
+    int64_t endUs() const { return m_epochUs + FRAME_US; }
+    int size() const { return m_count; }
+    const JJYEdge& operator[](int index) const { return m_edges[index]; }
+    int64_t timeUs(int index) const { return m_edges[index].timeUs; }
+
+    // 第 index 个边沿是否离开空闲电平（开始一个脉冲）
+    bool startsPulse(int index) const { return m_edges[index].level != m_idleLevel; }
+
+    // 帧与帧之间的DA电平（JJY为高电平，其余协议为满幅的低电平）
+    uint8_t idleLevel() const { return m_idleLevel; }
+
+private:
+    int64_t m_epochUs;
+    int m_count;
+    uint8_t m_idleLevel;
+    JJYEdge m_edges[MAX_EDGES];
+};
+
+#endif // JJYTIMELINE_H
@@ -0,0 +1,190 @@
+/*
+ * Copyright (c) 2025 Tomosawa
+ * All rights reserved.
+ *
+ * This code is part of the WiFi2JJY project.
+ * GitHub: https://github.com/Tomosawa/WIFI2JJY
+ */
+#ifndef JJYTIMEROUTPUT_H
+#define JJYTIMEROUTPUT_H
+
+#include <Arduino.h>
+#include "driver/gptimer.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "JJYOutput.h"
+#include "TimeSync.h"
+
+// 定时器中断输出：GPTimer 在每个边沿的时刻触发报警中断，中断里用 Pin 策略
+// 直接写 GPIO 寄存器并装入下一个边沿的报警值。发送期间播放任务阻塞，
+// 边沿时刻不受任务调度和串口日志影响。
+// Pin 为编译期引脚（FastPin）时每个边沿只有一条寄存器写。
+template<class Pin>
+class JJYTimerOutput : public JJYOutput {
+public:
+    // idleLevel 为协议的空闲电平，begin 时引脚置于该电平
+    explicit JJYTimerOutput(uint8_t idleLevel, const Pin& pin = Pin())
+        : m_pin(pin), m_idleLevel(idleLevel), m_timer(nullptr), m_done(nullptr), m_timeline(nullptr),
+          m_index(0), m_offsetUs(0), m_monoOffsetUs(0) {
+    }
+
+    ~JJYTimerOutput() {
+        if (m_timer != nullptr) {
+            gptimer_stop(m_timer);
+            gptimer_disable(m_timer);
+            gptimer_del_timer(m_timer);
+        }
+        if (m_done != nullptr) {
+            vSemaphoreDelete(m_done);
+        }
+    }
+
+    bool begin() override {
+        if (m_timer != nullptr) {
+            return true;
+        }
+        if (!m_pin.begin(m_idleLevel)) {
+            return false;
+        }
+
+        m_done = xSemaphoreCreateBinary();
+        if (m_done == nullptr) {
+            return false;
+        }
+
+        gptimer_config_t config = {};
+        config.clk_src = GPTIMER_CLK_SRC_DEFAULT;
+        config.direction = GPTIMER_COUNT_UP;
+        config.resolution_hz = 1000000;  // 1 tick = 1us
+        esp_err_t err = gptimer_new_timer(&config, &m_timer);
+        if (err != ESP_OK) {
+            hal::log("[JJYTimerOutput] gptimer_new_timer failed: %d\n", err);
+            m_timer = nullptr;
+            return false;
+        }
+
+        gptimer_event_callbacks_t callbacks = {};
+        callbacks.on_alarm = &JJYTimerOutput::onAlarm;
+        gptimer_register_event_callbacks(m_timer, &callbacks, this);
+        gptimer_enable(m_timer);
+        gptimer_start(m_timer);
+        return true;
+    }
+
+    const char* name() const override { return "timer"; }
+
+protected:
+    bool play(const JJYTimeline& timeline) override {
+        if (timeline.size() == 0 || !begin()) {
+            return false;
+        }
+
+        // 在第一个边沿前醒来，其余时间任务阻塞（cancel / requestStop 提前唤醒）
+        int64_t firstMonoUs = TimeSync::wallToMonotonicUs(timeline[0].timeUs);
+        int64_t remainingUs;
+        while ((remainingUs = firstMonoUs - LEAD_US - esp_timer_get_time()) > 1000) {
+            if (sleepMs((uint32_t)(remainingUs / 1000)) && (abortRequested() || stopBefore(timeline, 0))) {
+                break;
+            }
+        }
+        if (abortRequested() || stopBefore(timeline, 0)) {
+            return true;
+        }
+
+        // 挂钟 -> 单调时钟 -> 定时器计数的对应关系，GPTimer 与 esp_timer 同源于晶振
+        uint64_t count = 0;
+        gptimer_get_raw_count(m_timer, &count);
+        int64_t monoUs = esp_timer_get_time();
+        m_monoOffsetUs = TimeSync::wallToMonotonicUs(timeline[0].timeUs) - timeline[0].timeUs;
+        m_offsetUs = m_monoOffsetUs + ((int64_t)count - monoUs);
+
+        // 已经错过的边沿直接取其最后的电平，从第一个未到的边沿开始
+        int index = 0;
+        while (index < timeline.size() && timeline[index].timeUs + m_monoOffsetUs <= monoUs + MIN_ALARM_LEAD_US) {
+            index++;
+        }
+        if (index > 0) {
+            m_pin.write(timeline[index - 1].level);
+        }
+        if (index >= timeline.size()) {
+            return true;
+        }
+
+        m_report = JJYFrameReport();
+        m_timeline = &timeline;
+        m_index = index;
+        xSemaphoreTake(m_done, 0);
+
+        gptimer_alarm_config_t alarm = {};
+        alarm.alarm_count = (uint64_t)(timeline[index].timeUs + m_offsetUs);
+        gptimer_set_alarm_action(m_timer, &alarm);
+
+        // 等待中断输出完最后一个边沿。停止请求由中断在下一个边沿处理
+        // （STOP_NOW 也要到下一个边沿才回到空闲电平）
+        int64_t lastMonoUs = timeline[timeline.size() - 1].timeUs + m_monoOffsetUs;
+        uint32_t timeoutMs = (uint32_t)((lastMonoUs - esp_timer_get_time()) / 1000) + 2000;
+        bool done = xSemaphoreTake(m_done, pdMS_TO_TICKS(timeoutMs)) == pdTRUE;
+        gptimer_set_alarm_action(m_timer, nullptr);
+        m_timeline = nullptr;
+        return done;
+    }
+
+private:
+    static constexpr int64_t LEAD_US = 5000;           // 提前唤醒装入第一个报警的时间
+    static constexpr int64_t MIN_ALARM_LEAD_US = 50;   // 报警值至少领先当前计数的时间
+
+    Pin m_pin;
+    uint8_t m_idleLevel;
+    gptimer_handle_t m_timer;
+    SemaphoreHandle_t m_done;
+    const JJYTimeline* volatile m_timeline;
+    volatile int m_index;
+    int64_t m_offsetUs;      // 挂钟 -> 定时器计数
+    int64_t m_monoOffsetUs;  // 挂钟 -> esp_timer
+
+    static bool onAlarm(gptimer_handle_t timer, const gptimer_alarm_event_data_t* edata, void* ctx) {
+        (void)edata;
+        JJYTimerOutput* self = static_cast<JJYTimerOutput*>(ctx);
+        const JJYTimeline* timeline = self->m_timeline;
+        if (timeline == nullptr) {
+            return false;
+        }
+
+        int index = self->m_index;
+        if (self->abortRequested()) {
+            // 中止：回到空闲电平
+            self->m_pin.write(timeline->idleLevel());
+            index = timeline->size();
+        } else if (self->stopBefore(*timeline, index)) {
+            // 停止请求：不再输出之后的边沿
+            self->m_pin.write(timeline->idleLevel());
+            index = timeline->size();
+        } else {
+            const JJYEdge& edge = (*timeline)[index];
+            if (self->deadlineMissed(index, esp_timer_get_time() - (edge.timeUs + self->m_monoOffsetUs))) {
+                // 报警来得太晚（中断被屏蔽过久）：回到空闲电平，放弃本帧
+                self->m_pin.write(timeline->idleLevel());
+                index = timeline->size();
+            } else {
+                self->m_pin.write(edge.level);
+                self->recordEdgeError(*timeline, index,
+                                      esp_timer_get_time() - (edge.timeUs + self->m_monoOffsetUs));
+                index++;
+            }
+        }
+        self->m_index = index;
+
+        BaseType_t woken = pdFALSE;
+        if (index < timeline->size()) {
+            gptimer_alarm_config_t alarm = {};
+            alarm.alarm_count = (uint64_t)((*timeline)[index].timeUs + self->m_offsetUs);
+            gptimer_set_alarm_action(timer, &alarm);
+        } else {
+            xSemaphoreGiveFromISR(self->m_done, &woken);
+        }
+        return woken == pdTRUE;
+    }
+};
+
+#endif // JJYTIMEROUTPUT_H
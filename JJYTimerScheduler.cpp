@@ -0,0 +1,174 @@
+/*
+ * Copyright (c) 2025 Tomosawa
+ * All rights reserved.
+ *
+ * This code is part of the WiFi2JJY project.
+ * GitHub: https://github.com/Tomosawa/WIFI2JJY
+ */
+#include "JJYTimerScheduler.h"
+#include "esp_timer.h"
+#include "soc/gpio_reg.h"
+#include "soc/soc.h"
+#include "HAL.h"
+#include "TimeSync.h"
+
+JJYTimerScheduler::JJYTimerScheduler(const int pins[], int count, uint8_t idleHighMask)
+    : JJYScheduler(pins, count, idleHighMask), m_timer(nullptr), m_done(nullptr), m_schedule(nullptr),
+      m_index(0), m_offsetUs(0), m_monoOffsetUs(0) {
+    // 预先算好每种通道组合对应的 GPIO 掩码，中断里查表即可
+    for (int mask = 0; mask < (1 << MAX_CHANNELS); mask++) {
+        m_gpioMasks[mask] = 0;
+        for (int i = 0; i < m_count; i++) {
+            if ((mask & (1 << i)) && m_pins[i] >= 0 && m_pins[i] < 32) {
+                m_gpioMasks[mask] |= 1UL << m_pins[i];
+            }
+        }
+    }
+}
+
+JJYTimerScheduler::~JJYTimerScheduler() {
+    if (m_timer != nullptr) {
+        gptimer_stop(m_timer);
+        gptimer_disable(m_timer);
+        gptimer_del_timer(m_timer);
+    }
+    if (m_done != nullptr) {
+        vSemaphoreDelete(m_done);
+    }
+}
+
+bool JJYTimerScheduler::begin() {
+    if (m_timer != nullptr) {
+        return true;
+    }
+    for (int i = 0; i < m_count; i++) {
+        if (m_pins[i] < 0 || m_pins[i] >= 32) {
+            hal::log("[JJYTimerScheduler] GPIO%d is outside the W1TS/W1TC register\n", m_pins[i]);
+            return false;
+        }
+        hal::pinOutput(m_pins[i], (m_idleHighMask >> i) & 1);
+    }
+
+    if (m_done == nullptr) {
+        m_done = xSemaphoreCreateBinary();
+        if (m_done == nullptr) {
+            return false;
+        }
+    }
+
+    gptimer_config_t config = {};
+    config.clk_src = GPTIMER_CLK_SRC_DEFAULT;
+    config.direction = GPTIMER_COUNT_UP;
+    config.resolution_hz = 1000000;  // 1 tick = 1us
+    esp_err_t err = gptimer_new_timer(&config, &m_timer);
+    if (err != ESP_OK) {
+        hal::log("[JJYTimerScheduler] gptimer_new_timer failed: %d\n", err);
+        m_timer = nullptr;
+        return false;
+    }
+
+    gptimer_event_callbacks_t callbacks = {};
+    callbacks.on_alarm = &JJYTimerScheduler::onAlarm;
+    gptimer_register_event_callbacks(m_timer, &callbacks, this);
+    gptimer_enable(m_timer);
+    gptimer_start(m_timer);
+    return true;
+}
+
+void JJYTimerScheduler::writeStep(uint8_t setMask, uint8_t clearMask) const {
+    REG_WRITE(GPIO_OUT_W1TS_REG, m_gpioMasks[setMask]);
+    REG_WRITE(GPIO_OUT_W1TC_REG, m_gpioMasks[clearMask]);
+}
+
+bool JJYTimerScheduler::play(const JJYSchedule& schedule) {
+    if (schedule.size() == 0 || !begin()) {
+        return false;
+    }
+
+    // 在第一步前醒来，其余时间任务阻塞（cancel / requestStop 提前唤醒）
+    int64_t firstMonoUs = TimeSync::wallToMonotonicUs(schedule.timeUs(0));
+    int64_t remainingUs;
+    while ((remainingUs = firstMonoUs - LEAD_US - esp_timer_get_time()) > 1000) {
+        if (sleepMs((uint32_t)(remainingUs / 1000)) && (abortRequested() || stopBefore(schedule, 0))) {
+            break;
+        }
+    }
+    if (abortRequested() || stopBefore(schedule, 0)) {
+        return true;
+    }
+
+    // 挂钟 -> 单调时钟 -> 定时器计数的对应关系，GPTimer 与 esp_timer 同源于晶振
+    uint64_t count = 0;
+    gptimer_get_raw_count(m_timer, &count);
+    int64_t monoUs = esp_timer_get_time();
+    m_monoOffsetUs = TimeSync::wallToMonotonicUs(schedule.timeUs(0)) - schedule.timeUs(0);
+    m_offsetUs = m_monoOffsetUs + ((int64_t)count - monoUs);
+
+    // 已经错过的步骤按顺序补写，得到各通道的当前电平
+    int index = 0;
+    while (index < schedule.size() && schedule.timeUs(index) + m_monoOffsetUs <= monoUs + MIN_ALARM_LEAD_US) {
+        writeStep(schedule[index].setMask, schedule[index].clearMask);
+        index++;
+    }
+    if (index >= schedule.size()) {
+        return true;
+    }
+
+    m_report = JJYFrameReport();
+    m_schedule = &schedule;
+    m_index = index;
+    xSemaphoreTake(m_done, 0);
+
+    gptimer_alarm_config_t alarm = {};
+    alarm.alarm_count = (uint64_t)(schedule.timeUs(index) + m_offsetUs);
+    gptimer_set_alarm_action(m_timer, &alarm);
+
+    // 等待中断输出完最后一步。停止请求由中断在下一步处理
+    // （STOP_NOW 也要到下一步才回到空闲电平）
+    int64_t lastMonoUs = schedule.timeUs(schedule.size() - 1) + m_monoOffsetUs;
+    uint32_t timeoutMs = (uint32_t)((lastMonoUs - esp_timer_get_time()) / 1000) + 2000;
+    bool done = xSemaphoreTake(m_done, pdMS_TO_TICKS(timeoutMs)) == pdTRUE;
+    gptimer_set_alarm_action(m_timer, nullptr);
+    m_schedule = nullptr;
+    return done;
+}
+
+bool JJYTimerScheduler::onAlarm(gptimer_handle_t timer, const gptimer_alarm_event_data_t* edata, void* ctx) {
+    (void)edata;
+    JJYTimerScheduler* self = static_cast<JJYTimerScheduler*>(ctx);
+    const JJYSchedule* schedule = self->m_schedule;
+    if (schedule == nullptr) {
+        return false;
+    }
+
+    int index = self->m_index;
+    if (self->abortRequested() || self->stopBefore(*schedule, index)) {
+        // 中止或停止请求：所有通道回到空闲电平，不再输出之后的步骤
+        self->writeIdle();
+        index = schedule->size();
+    } else {
+        const int64_t lateUs = esp_timer_get_time() - (schedule->timeUs(index) + self->m_monoOffsetUs);
+        if (self->deadlineMissed(index, lateUs)) {
+            // 报警来得太晚（中断被屏蔽过久）：回到空闲电平，放弃本帧
+            self->writeIdle();
+            index = schedule->size();
+        } else {
+            const JJYScheduleStep& step = (*schedule)[index];
+            self->writeStep(step.setMask, step.clearMask);
+            self->recordEdgeError(*schedule, index,
+                                  esp_timer_get_time() - (schedule->timeUs(index) + self->m_monoOffsetUs));
+            index++;
+        }
+    }
+    self->m_index = index;
+
+    BaseType_t woken = pdFALSE;
+    if (index < schedule->size()) {
+        gptimer_alarm_config_t alarm = {};
+        alarm.alarm_count = (uint64_t)(schedule->timeUs(index) + self->m_offsetUs);
+        gptimer_set_alarm_action(timer, &alarm);
+    } else {
+        xSemaphoreGiveFromISR(self->m_done, &woken);
+    }
+    return woken == pdTRUE;
+}
@@ -0,0 +1,50 @@
+/*
+ * Copyright (c) 2025 Tomosawa
+ * All rights reserved.
+ *
+ * This code is part of the WiFi2JJY project.
+ * GitHub: https://github.com/Tomosawa/WIFI2JJY
+ */
+#ifndef JJYTIMERSCHEDULER_H
+#define JJYTIMERSCHEDULER_H
+
+#include <Arduino.h>
+#include "driver/gptimer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "JJYScheduler.h"
+
+// 定时器中断多路调度：一个 GPTimer 按合并后的边沿队列在每一步的时刻触发报警中断，
+// 中断里对所有通道一次写 W1TS/W1TC 寄存器，再装入下一步的报警值。
+// 播放任务在发送期间阻塞，边沿时刻不受任务调度和串口日志影响。引脚须为 GPIO0-31
+class JJYTimerScheduler : public JJYScheduler {
+public:
+    JJYTimerScheduler(const int pins[], int count, uint8_t idleHighMask);
+    ~JJYTimerScheduler();
+
+    bool begin() override;
+    const char* name() const override { return "timer"; }
+
+protected:
+    bool play(const JJYSchedule& schedule) override;
+
+private:
+    static constexpr int64_t LEAD_US = 5000;           // 提前唤醒装入第一个报警的时间
+    static constexpr int64_t MIN_ALARM_LEAD_US = 50;   // 报警值至少领先当前计数的时间
+
+    uint32_t m_gpioMasks[1 << MAX_CHANNELS];  // 通道掩码 -> GPIO 寄存器掩码
+    gptimer_handle_t m_timer;
+    SemaphoreHandle_t m_done;
+    const JJYSchedule* volatile m_schedule;
+    volatile int m_index;
+    int64_t m_offsetUs;      // 挂钟 -> 定时器计数
+    int64_t m_monoOffsetUs;  // 挂钟 -> esp_timer
+
+    // 一步输出：先置位再清零，两条寄存器写
+    void writeStep(uint8_t setMask, uint8_t clearMask) const;
+    void writeIdle() const { writeStep(m_idleHighMask, (uint8_t)(channelMask() & ~m_idleHighMask)); }
+
+    static bool onAlarm(gptimer_handle_t timer, const gptimer_alarm_event_data_t* edata, void* ctx);
+};
+
+#endif // JJYTIMERSCHEDULER_H
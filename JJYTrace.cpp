@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) 2025 Tomosawa
+ * All rights reserved.
+ *
+ * This code is part of the WiFi2JJY project.
+ * GitHub: https://github.com/Tomosawa/WIFI2JJY
+ */
+#include "JJYTrace.h"
+#include <stdio.h>
+
+JJYTraceWriter::JJYTraceWriter(VcdWriter::Sink sink, void* context)
+    : m_vcd(sink, context),
+      m_decoder([this](const JJYPulseDecoder::Event& event) { onFrame(event); }),
+      m_nowUs(0) {
+    m_ids[SIGNAL_DA] = m_vcd.addWire("DA");
+    m_ids[SIGNAL_PON] = m_vcd.addWire("PON");
+    m_frameId = m_vcd.addString("frame");
+    m_lastLevel[SIGNAL_DA] = -1;
+    m_lastLevel[SIGNAL_PON] = -1;
+}
+
+void JJYTraceWriter::begin(int64_t originUs, const char* comment) {
+    m_vcd.begin(originUs, comment);
+    m_decoder.reset();
+    m_lastLevel[SIGNAL_DA] = -1;
+    m_lastLevel[SIGNAL_PON] = -1;
+}
+
+void JJYTraceWriter::record(Signal signal, bool level, int64_t timeUs) {
+    if (m_lastLevel[signal] == (int)level) {
+        return;
+    }
+    m_lastLevel[signal] = level;
+    m_nowUs = timeUs;
+    m_vcd.change(m_ids[signal], level, timeUs);
+    if (signal == SIGNAL_DA) {
+        m_decoder.onLevel(level, timeUs);
+    }
+}
+
+void JJYTraceWriter::onFrame(const JJYPulseDecoder::Event& event) {
+    char text[48];
+    if (event.type == JJYPulseDecoder::FRAME_START) {
+        snprintf(text, sizeof(text), "receiving");
+    } else if (event.type == JJYPulseDecoder::FRAME_BROKEN) {
+        snprintf(text, sizeof(text), "broken");
+    } else if (event.result != JJYDecoder::OK) {
+        snprintf(text, sizeof(text), "%s", JJYDecoder::resultName(event.result));
+    } else {
+        const JJYDecoded& decoded = event.decoded;
+        snprintf(text, sizeof(text), "%02d/%03d %02d:%02d w%d", decoded.year2, decoded.dayOfYear,
+                 decoded.hour, decoded.minute, decoded.weekDay);
+    }
+    m_vcd.annotate(m_frameId, text, m_nowUs);
+}
+
+bool JJYTraceCapture::oldestTime(int64_t& timeUs) {
+    JJYTraceEvent da = {};
+    JJYTraceEvent pon = {};
+    bool hasDa = m_da.peek(da);
+    bool hasPon = m_pon.peek(pon);
+    pon.timeUs += m_monoToWallUs;
+    if (!hasDa && !hasPon) {
+        return false;
+    }
+    timeUs = hasDa && (!hasPon || da.timeUs <= pon.timeUs) ? da.timeUs : pon.timeUs;
+    return true;
+}
+
+size_t JJYTraceCapture::drainTo(JJYTraceWriter& writer) {
+    size_t count = 0;
+    JJYTraceEvent da = {};
+    JJYTraceEvent pon = {};
+    bool hasDa = m_da.peek(da);
+    bool hasPon = m_pon.peek(pon);
+    pon.timeUs += m_monoToWallUs;
+    while (hasDa || hasPon) {
+        // 两个环各自有序，取较早的一个
+        if (hasDa && (!hasPon || da.timeUs <= pon.timeUs)) {
+            writer.record(JJYTraceWriter::SIGNAL_DA, da.level != 0, da.timeUs);
+            m_da.pop(da);
+            hasDa = m_da.peek(da);
+        } else {
+            writer.record(JJYTraceWriter::SIGNAL_PON, pon.level != 0, pon.timeUs);
+            m_pon.pop(pon);
+            hasPon = m_pon.peek(pon);
+            pon.timeUs += m_monoToWallUs;
+        }
+        count++;
+    }
+    return count;
+}
@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2025 Tomosawa
+ * All rights reserved.
+ *
+ * This code is part of the WiFi2JJY project.
+ * GitHub: https://github.com/Tomosawa/WIFI2JJY
+ */
+#ifndef JJYTRACE_H
+#define JJYTRACE_H
+
+#include <stdint.h>
+#include "VcdWriter.h"
+#include "JJYPulseDecoder.h"
+#include "SpscRing.h"
+
+// 被记录的一次电平变化
+struct JJYTraceEvent {
+    int64_t timeUs;
+    uint8_t signal;
+    uint8_t level;
+};
+
+// DA/PON 波形记录：把电平变化流式写成 VCD，并把 DA 解码出的每一帧
+// 作为字符串信号 frame 注释在该帧结束处（接收中为 "receiving"）。
+// 同一信号连续相同的电平只记录一次。
+class JJYTraceWriter {
+public:
+    enum Signal {
+        SIGNAL_DA,
+        SIGNAL_PON
+    };
+
+    JJYTraceWriter(VcdWriter::Sink sink, void* context);
+
+    void begin(int64_t originUs, const char* comment);
+    void record(Signal signal, bool level, int64_t timeUs);
+    void comment(const char* text) { m_vcd.comment(text); }
+    void end(int64_t timeUs) { m_vcd.end(timeUs); }
+
+private:
+    VcdWriter m_vcd;
+    JJYPulseDecoder m_decoder;
+    int m_ids[2];
+    int m_frameId;
+    int m_lastLevel[2];
+    int64_t m_nowUs;
+
+    void onFrame(const JJYPulseDecoder::Event& event);
+};
+
+// 设备上的记录缓冲：播放任务记录 DA、PON 中断（没有中断时为发送任务）记录 PON，
+// 各用一个无锁单生产者环，记录时不加锁也不输出；发送结束后由 drainTo 按时间合并写出，
+// 串口输出不会干扰被观察的时序。
+class JJYTraceCapture {
+public:
+    static constexpr size_t DA_CAPACITY = 1024;  // JJY 每分钟120个边沿，约8.5分钟
+    static constexpr size_t PON_CAPACITY = 16;
+
+    bool recordDa(bool level, int64_t timeUs) {
+        return m_da.push({timeUs, JJYTraceWriter::SIGNAL_DA, (uint8_t)level});
+    }
+    // PON 只在电平变化时记录；时刻为单调时钟（中断里只有 monoUs），写出时按 setMonotonicOffset 换算成挂钟
+    bool recordPon(bool level, int64_t monoUs) {
+        if ((int)level == m_ponLevel) {
+            return true;
+        }
+        if (!m_pon.push({monoUs, JJYTraceWriter::SIGNAL_PON, (uint8_t)level})) {
+            return false;
+        }
+        m_ponLevel = level;
+        return true;
+    }
+
+    // 消费者：挂钟 - 单调时钟，在 oldestTime/drainTo 之前设置
+    void setMonotonicOffset(int64_t offsetUs) { m_monoToWallUs = offsetUs; }
+
+    // 消费者：最早一条尚未写出的记录的时刻，没有记录时返回 false
+    bool oldestTime(int64_t& timeUs);
+
+    // 消费者：按时间顺序写出所有已记录的变化，返回写出的数量
+    size_t drainTo(JJYTraceWriter& writer);
+
+    // 缓冲满而丢弃的变化数
+    uint32_t dropped() const { return m_da.dropped() + m_pon.dropped(); }
+
+private:
+    SpscRing<JJYTraceEvent, DA_CAPACITY> m_da;
+    SpscRing<JJYTraceEvent, PON_CAPACITY> m_pon;
+    int m_ponLevel = -1;         // 生产者：最近记录的 PON 电平，-1 为尚未记录
+    int64_t m_monoToWallUs = 0;  // 消费者：PON 时刻的换算偏移
+};
+
+#endif // JJYTRACE_H
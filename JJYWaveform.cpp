@@ -0,0 +1,175 @@
+/*
+ * Copyright (c) 2025 Tomosawa
+ * All rights reserved.
+ *
+ * This code is part of the WiFi2JJY project.
+ * GitHub: https://github.com/Tomosawa/WIFI2JJY
+ */
+#include "JJYWaveform.h"
+#include <math.h>
+#include <string.h>
+
+static uint64_t gcd64(uint64_t a, uint64_t b) {
+    while (b != 0) {
+        uint64_t r = a % b;
+        a = b;
+        b = r;
+    }
+    return a;
+}
+
+// 向下取整的整数除法（被除数可能为负）
+static int64_t floorDiv(int64_t a, int64_t b) {
+    int64_t q = a / b;
+    return (a % b != 0 && (a < 0) != (b < 0)) ? q - 1 : q;
+}
+
+JJYWaveform::JJYWaveform() : m_tableSamples(0), m_anchorUs(0), m_position(0) {
+}
+
+bool JJYWaveform::configure(const Config& config) {
+    if (config.sampleRate == 0 || config.carrierNum == 0 || config.carrierDen == 0) {
+        return false;
+    }
+
+    // tableSamples 个采样恰好容纳 cycles 个整载波周期
+    uint64_t rate = (uint64_t)config.sampleRate * config.carrierDen;
+    uint64_t g = gcd64(rate, config.carrierNum);
+    uint64_t tableSamples = rate / g;
+    uint64_t cycles = config.carrierNum / g;
+    if (tableSamples > MAX_TABLE_SAMPLES) {
+        return false;
+    }
+
+    m_config = config;
+    m_tableSamples = (size_t)tableSamples;
+    for (size_t i = 0; i < m_tableSamples; i++) {
+        double s = sin(2.0 * M_PI * (double)((cycles * i) % tableSamples) / (double)tableSamples);
+        m_full[i] = (int16_t)lround(s * config.fullAmplitude);
+        m_reduced[i] = (int16_t)lround(s * config.reducedAmplitude);
+    }
+    m_position = 0;
+    return true;
+}
+
+void JJYWaveform::setAnchor(int64_t anchorUs) {
+    m_anchorUs = anchorUs;
+    m_position = 0;
+}
+
+int64_t JJYWaveform::positionUs() const {
+    return sampleTimeUs(m_position);
+}
+
+int64_t JJYWaveform::sampleTimeUs(int64_t sample) const {
+    return m_anchorUs + floorDiv(sample * JJYTimeline::SECOND_US, m_config.sampleRate);
+}
+
+int64_t JJYWaveform::sampleAt(int64_t wallUs) const {
+    return floorDiv((wallUs - m_anchorUs) * m_config.sampleRate + JJYTimeline::SECOND_US / 2,
+                    JJYTimeline::SECOND_US);
+}
+
+void JJYWaveform::fill(const int16_t* table, int16_t* out, size_t count) {
+    size_t phase = (size_t)(m_position % (int64_t)m_tableSamples);
+    m_position += count;
+    while (count > 0) {
+        size_t n = m_tableSamples - phase;
+        if (n > count) {
+            n = count;
+        }
+        memcpy(out, table + phase, n * sizeof(int16_t));
+        out += n;
+        count -= n;
+        phase = 0;
+    }
+}
+
+void JJYWaveform::renderLevel(uint8_t level, int16_t* out, size_t count) {
+    // 负逻辑：DA低电平为满幅
+    fill(level ? m_reduced : m_full, out, count);
+}
+
+void JJYWaveform::render(const JJYTimeline& timeline, int16_t* out, size_t count) {
+    const int64_t end = m_position + (int64_t)count;
+
+    // 找到当前位置之后的第一个边沿，之前的边沿决定当前电平
+    int index = 0;
+    while (index < timeline.size() && sampleAt(timeline[index].timeUs) <= m_position) {
+        index++;
+    }
+    uint8_t level = index > 0 ? timeline[index - 1].level : timeline.idleLevel();
+
+    while (m_position < end) {
+        int64_t until = end;
+        if (index < timeline.size()) {
+            int64_t edgeSample = sampleAt(timeline[index].timeUs);
+            if (edgeSample < until) {
+                until = edgeSample;
+            }
+        }
+        size_t n = (size_t)(until - m_position);
+        renderLevel(level, out, n);
+        out += n;
+        if (until < end) {
+            level = timeline[index].level;
+            index++;
+        }
+    }
+}
+
+static void putLE(FILE* file, uint32_t value, int bytes) {
+    for (int i = 0; i < bytes; i++) {
+        fputc((int)((value >> (8 * i)) & 0xFF), file);
+    }
+}
+
+bool JJYWaveform::writeWav(FILE* file, const JJYTimeline& timeline) {
+    if (file == nullptr || m_tableSamples == 0) {
+        return false;
+    }
+
+    setAnchor(timeline.epochUs());
+    const int64_t total = sampleAt(timeline.endUs());
+    const uint32_t dataBytes = (uint32_t)(total * sizeof(int16_t));
+
+    // RIFF/WAVE 头：PCM，单声道，16 位
+    fwrite("RIFF", 1, 4, file);
+    putLE(file, 36 + dataBytes, 4);
+    fwrite("WAVEfmt ", 1, 8, file);
+    putLE(file, 16, 4);
+    putLE(file, 1, 2);
+    putLE(file, 1, 2);
+    putLE(file, m_config.sampleRate, 4);
+    putLE(file, m_config.sampleRate * sizeof(int16_t), 4);
+    putLE(file, sizeof(int16_t), 2);
+    putLE(file, 16, 2);
+    fwrite("data", 1, 4, file);
+    putLE(file, dataBytes, 4);
+
+    int16_t block[1024];
+    uint8_t bytes[sizeof(block)];
+    while (m_position < total) {
+        size_t n = (size_t)(total - m_position);
+        if (n > 1024) {
+            n = 1024;
+        }
+        render(timeline, block, n);
+        for (size_t i = 0; i < n; i++) {
+            bytes[2 * i] = (uint8_t)(block[i] & 0xFF);
+            bytes[2 * i + 1] = (uint8_t)((uint16_t)block[i] >> 8);
+        }
+        if (fwrite(bytes, 1, n * 2, file) != n * 2) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool JJYWaveform::writeWav(FILE* file, time_t minute, const TimeCode& code) {
+    JJYFrame frame;
+    code.encode(frame, minute, TIME_CODE_NATIVE_ZONE);
+    JJYTimeline timeline;
+    timeline.compile(frame, (int64_t)minute * JJYTimeline::SECOND_US, *code.shapes);
+    return writeWav(file, timeline);
+}
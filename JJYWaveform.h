@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) 2025 Tomosawa
+ * All rights reserved.
+ *
+ * This code is part of the WiFi2JJY project.
+ * GitHub: https://github.com/Tomosawa/WIFI2JJY
+ */
+#ifndef JJYWAVEFORM_H
+#define JJYWAVEFORM_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <time.h>
+#include "JJYTimeline.h"
+
+// 调制波形生成：把边沿时间表渲染成 16 位 PCM 采样流（I2S DMA 缓冲或 WAV 文件）。
+// 载波与采样率之比化为最简分数后，整数个载波周期恰好占整数个采样，
+// 满幅和 10% 幅度各预先算好一张这样的周期表，渲染时按段整块复制，
+// 每个采样不做任何三角运算。不依赖 Arduino，可在主机上编译。
+class JJYWaveform {
+public:
+    static constexpr size_t MAX_TABLE_SAMPLES = 4800;  // 周期表上限（采样数）
+
+    struct Config {
+        uint32_t sampleRate = 48000;
+        // 载波频率 = carrierNum / carrierDen Hz，默认 40000/3 Hz：
+        // 扬声器或音频线播放时其 3 次谐波落在 40kHz 上
+        uint32_t carrierNum = 40000;
+        uint32_t carrierDen = 3;
+        int16_t fullAmplitude = 30000;
+        int16_t reducedAmplitude = 3000;  // 满幅的 10%
+    };
+
+    JJYWaveform();
+
+    // 按配置生成周期表，载波周期与采样无法在 MAX_TABLE_SAMPLES 内对齐时返回 false
+    bool configure(const Config& config);
+
+    // 设置流的起点：第0个采样对应挂钟时间 anchorUs
+    void setAnchor(int64_t anchorUs);
+
+    // 从当前位置渲染 count 个采样，电平按 timeline 的边沿切换；
+    // 第一个边沿之前保持时间表的空闲电平，最后一个边沿之后保持其电平
+    void render(const JJYTimeline& timeline, int16_t* out, size_t count);
+
+    // 直接按固定电平渲染 count 个采样
+    void renderLevel(uint8_t level, int16_t* out, size_t count);
+
+    // 第0个采样的挂钟时间
+    int64_t anchorUs() const { return m_anchorUs; }
+
+    // 当前位置（下一个采样的序号）及其对应的挂钟时间
+    int64_t position() const { return m_position; }
+    int64_t positionUs() const;
+
+    // 挂钟时间对应的采样序号（向最近的采样取整）
+    int64_t sampleAt(int64_t wallUs) const;
+
+    // 第 sample 个采样的挂钟时间
+    int64_t sampleTimeUs(int64_t sample) const;
+
+    // 把一帧从第0秒到帧尾写成单声道 16 位 WAV 文件
+    bool writeWav(FILE* file, const JJYTimeline& timeline);
+
+    // 按 code 编码从 minute（整分的UTC秒数）开始发送的帧并写成 WAV
+    bool writeWav(FILE* file, time_t minute, const TimeCode& code = TimeCode::get(PROTOCOL_JJY));
+
+    const Config& config() const { return m_config; }
+    size_t tableSamples() const { return m_tableSamples; }
+
+private:
+    Config m_config;
+    size_t m_tableSamples;
+    int64_t m_anchorUs;
+    int64_t m_position;
+    int16_t m_full[MAX_TABLE_SAMPLES];
+    int16_t m_reduced[MAX_TABLE_SAMPLES];
+
+    // 从 table 的当前相位整块复制 count 个采样
+    void fill(const int16_t* table, int16_t* out, size_t count);
+};
+
+#endif // JJYWAVEFORM_H
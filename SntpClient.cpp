@@ -0,0 +1,229 @@
+/*
+ * Copyright (c) 2025 Tomosawa
+ * All rights reserved.
+ *
+ * This code is part of the WiFi2JJY project.
+ * GitHub: https://github.com/Tomosawa/WIFI2JJY
+ */
+#include "SntpClient.h"
+#include <stdlib.h>
+#include <string.h>
+#include "HAL.h"
+
+// 1900-01-01 到 1970-01-01 的秒数
+static const int64_t NTP_UNIX_OFFSET_S = 2208988800LL;
+
+static uint32_t readU32(const uint8_t* field) {
+    return ((uint32_t)field[0] << 24) | ((uint32_t)field[1] << 16) | ((uint32_t)field[2] << 8) | field[3];
+}
+
+static void writeU32(uint8_t* field, uint32_t value) {
+    field[0] = (uint8_t)(value >> 24);
+    field[1] = (uint8_t)(value >> 16);
+    field[2] = (uint8_t)(value >> 8);
+    field[3] = (uint8_t)value;
+}
+
+// 16.16 定点秒（根时延、根离散度）换算成微秒
+static int64_t shortToUs(const uint8_t* field) {
+    return ((int64_t)readU32(field) * 1000000LL) >> 16;
+}
+
+void SntpClient::writeTimestamp(uint8_t* field, int64_t unixUs) {
+    int64_t seconds = unixUs / 1000000LL;
+    int64_t micros = unixUs % 1000000LL;
+    if (micros < 0) {
+        seconds -= 1;
+        micros += 1000000LL;
+    }
+    writeU32(field, (uint32_t)(seconds + NTP_UNIX_OFFSET_S));
+    writeU32(field + 4, (uint32_t)(((uint64_t)micros << 32) / 1000000ULL));
+}
+
+int64_t SntpClient::readTimestamp(const uint8_t* field) {
+    int64_t seconds = readU32(field);
+    if (seconds < 0x80000000LL) {
+        seconds += 0x100000000LL;
+    }
+    const uint64_t fraction = readU32(field + 4);
+    const int64_t micros = (int64_t)((fraction * 1000000ULL + 0x80000000ULL) >> 32);
+    return (seconds - NTP_UNIX_OFFSET_S) * 1000000LL + micros;
+}
+
+void SntpClient::buildRequest(uint8_t* packet, int64_t t1Us) {
+    memset(packet, 0, PACKET_SIZE);
+    packet[0] = (0 << 6) | (4 << 3) | 3;  // LI=0，版本4，客户端
+    writeTimestamp(packet + 40, t1Us);
+}
+
+bool SntpClient::parseResponse(const uint8_t* packet, size_t length, int64_t t1Us, int64_t t4Us, NtpSample& sample) {
+    if (length < PACKET_SIZE) {
+        return false;
+    }
+    const uint8_t leap = packet[0] >> 6;
+    const uint8_t mode = packet[0] & 0x07;
+    const uint8_t stratum = packet[1];
+    // 层级0是 Kiss-o'-Death，LI=3 表示服务器自己还没同步
+    if (mode != 4 || leap == 3 || stratum == 0 || stratum > 15) {
+        return false;
+    }
+    // Originate 必须原样带回我们的 Transmit，否则是迟到的旧应答或伪造的
+    uint8_t expected[8];
+    writeTimestamp(expected, t1Us);
+    if (memcmp(packet + 24, expected, sizeof(expected)) != 0) {
+        return false;
+    }
+    if (readU32(packet + 40) == 0 && readU32(packet + 44) == 0) {
+        return false;
+    }
+
+    const int64_t t2Us = readTimestamp(packet + 32);  // 服务器收到请求
+    const int64_t t3Us = readTimestamp(packet + 40);  // 服务器发出应答
+    int64_t delayUs = (t4Us - t1Us) - (t3Us - t2Us);
+    if (delayUs < 0) {
+        delayUs = 0;
+    }
+    sample.offsetUs = ((t2Us - t1Us) + (t3Us - t4Us)) / 2;
+    sample.delayUs = delayUs;
+    sample.errorUs = delayUs / 2 + shortToUs(packet + 4) / 2 + shortToUs(packet + 8);
+    sample.stratum = stratum;
+    return true;
+}
+
+bool SntpClient::query(const char* server, uint32_t timeoutMs, NtpSample& sample) {
+    return queryAll(&server, 1, timeoutMs, 0, &sample) == 1;
+}
+
+int SntpClient::queryAll(const char* const* servers, int count, uint32_t timeoutMs, uint32_t graceMs,
+                         NtpSample* samples) {
+    struct Request {
+        const char* name;
+        uint32_t address;
+        int64_t sendMonoUs;
+        int64_t t1Us;
+        bool answered;
+    };
+    Request requests[MAX_SERVERS];
+    int pending = 0;
+
+    hal::UdpSocket socket;
+    if (!socket.open()) {
+        hal::log("[NTP] Cannot open UDP socket\n");
+        return 0;
+    }
+    // 逐个发出，每个请求带自己的 T1，应答的 Originate 也就各不相同
+    uint8_t packet[PACKET_SIZE];
+    for (int i = 0; i < count && pending < MAX_SERVERS; i++) {
+        Request& request = requests[pending];
+        request.name = servers[i];
+        request.answered = false;
+        if (!hal::netResolve(servers[i], request.address)) {
+            hal::log("[NTP] Cannot resolve %s\n", servers[i]);
+            continue;
+        }
+        request.sendMonoUs = hal::monotonicUs();
+        request.t1Us = hal::wallTimeUs();
+        buildRequest(packet, request.t1Us);
+        if (!socket.sendTo(request.address, NTP_PORT, packet, sizeof(packet))) {
+            hal::log("[NTP] Send to %s failed\n", servers[i]);
+            continue;
+        }
+        pending++;
+    }
+    if (pending == 0) {
+        return 0;
+    }
+
+    // 不合格或重复的数据报丢弃，在剩余时间内继续等
+    int64_t deadlineUs = requests[0].sendMonoUs + (int64_t)timeoutMs * 1000;
+    int received = 0;
+    uint8_t reply[PACKET_SIZE + 16];
+    int64_t receiveMonoUs;
+    while (received < pending && (receiveMonoUs = hal::monotonicUs()) < deadlineUs) {
+        uint32_t from = 0;
+        const uint32_t waitMs = (uint32_t)((deadlineUs - receiveMonoUs + 999) / 1000);
+        const int length = socket.receive(reply, sizeof(reply), waitMs, receiveMonoUs, from);
+        if (length < 0) {
+            break;
+        }
+        for (int i = 0; i < pending; i++) {
+            Request& request = requests[i];
+            if (request.answered || request.address != from) {
+                continue;
+            }
+            NtpSample& sample = samples[received];
+            const int64_t t4Us = request.t1Us + (receiveMonoUs - request.sendMonoUs);
+            if (!parseResponse(reply, (size_t)length, request.t1Us, t4Us, sample)) {
+                continue;
+            }
+            sample.localMonoUs = receiveMonoUs;
+            sample.server = request.address;
+            request.answered = true;
+            hal::log("[NTP] %s (stratum %u): offset %+lld us, delay %lld us, error <= %lld us\n", request.name,
+                     (unsigned)sample.stratum, (long long)sample.offsetUs, (long long)sample.delayUs,
+                     (long long)sample.errorUs);
+            if (received++ == 0 && receiveMonoUs + (int64_t)graceMs * 1000 < deadlineUs) {
+                deadlineUs = receiveMonoUs + (int64_t)graceMs * 1000;
+            }
+            break;
+        }
+    }
+    for (int i = 0; i < pending; i++) {
+        if (!requests[i].answered) {
+            hal::log("[NTP] No valid reply from %s\n", requests[i].name);
+        }
+    }
+    return received;
+}
+
+int SntpClient::selectBest(const NtpSample* samples, int count, NtpSample& best) {
+    if (count <= 0) {
+        return 0;
+    }
+    // 区间端点按值排序，同值时起点在前；扫描找出同时落在最多区间内的点
+    struct Endpoint {
+        int64_t valueUs;
+        int type;  // -1 起点，+1 终点
+    };
+    Endpoint endpoints[2 * MAX_SERVERS];
+    int endpointCount = 0;
+    for (int i = 0; i < count && i < MAX_SERVERS; i++) {
+        endpoints[endpointCount++] = {samples[i].offsetUs - samples[i].errorUs, -1};
+        endpoints[endpointCount++] = {samples[i].offsetUs + samples[i].errorUs, +1};
+    }
+    for (int i = 1; i < endpointCount; i++) {
+        Endpoint endpoint = endpoints[i];
+        int j = i;
+        while (j > 0 && (endpoints[j - 1].valueUs > endpoint.valueUs ||
+                         (endpoints[j - 1].valueUs == endpoint.valueUs && endpoints[j - 1].type > endpoint.type))) {
+            endpoints[j] = endpoints[j - 1];
+            j--;
+        }
+        endpoints[j] = endpoint;
+    }
+    int overlap = 0;
+    int maxOverlap = 0;
+    int64_t pointUs = 0;
+    for (int i = 0; i < endpointCount; i++) {
+        overlap -= endpoints[i].type;
+        if (overlap > maxOverlap) {
+            maxOverlap = overlap;
+            pointUs = endpoints[i].valueUs;
+        }
+    }
+
+    const int considered = endpointCount / 2;
+    const bool majority = 2 * maxOverlap > considered;
+    int chosen = -1;
+    for (int i = 0; i < considered; i++) {
+        const bool truechimer = llabs(samples[i].offsetUs - pointUs) <= samples[i].errorUs;
+        if ((!majority || truechimer) && (chosen < 0 || samples[i].delayUs < samples[chosen].delayUs)) {
+            chosen = i;
+        }
+    }
+    best = samples[chosen];
+    if (!majority) {
+        return 1;
+    }
+    return maxOverlap;
+}
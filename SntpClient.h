@@ -0,0 +1,60 @@
+/*
+ * Copyright (c) 2025 Tomosawa
+ * All rights reserved.
+ *
+ * This code is part of the WiFi2JJY project.
+ * GitHub: https://github.com/Tomosawa/WIFI2JJY
+ */
+#ifndef SNTPCLIENT_H
+#define SNTPCLIENT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// 一次 NTP 测量（RFC 5905 的 on-wire 计算）
+struct NtpSample {
+    int64_t offsetUs = 0;     // 服务器时间 - 本地挂钟（θ）
+    int64_t delayUs = 0;      // 往返时延，已扣除服务器处理时间（δ）
+    int64_t errorUs = 0;      // 偏移的误差上界：δ/2 + 根时延/2 + 根离散度
+    int64_t localMonoUs = 0;  // 收到应答时的单调时钟
+    uint8_t stratum = 0;
+    uint32_t server = 0;      // 服务器 IPv4 地址
+};
+
+// 最简 SNTP 客户端：每台服务器发一个请求、收一个应答。发送和接收时刻都取单调时钟，
+// 接收时刻的挂钟 T4 = T1 + 单调时钟经过的时间，不受查询期间挂钟调整的影响。
+class SntpClient {
+public:
+    static constexpr uint16_t NTP_PORT = 123;
+    static constexpr size_t PACKET_SIZE = 48;
+    static constexpr int MAX_SERVERS = 4;
+
+    // 查询一台服务器，timeoutMs 内没有合格的应答返回 false
+    bool query(const char* server, uint32_t timeoutMs, NtpSample& sample);
+
+    // 同时向各服务器（最多 MAX_SERVERS 台）发请求，从一个套接字收应答：
+    // 全部到齐、首个应答后又过了 graceMs、或发出后过了 timeoutMs 时结束。
+    // 样本按到达顺序写入 samples，返回收到的个数
+    int queryAll(const char* const* servers, int count, uint32_t timeoutMs, uint32_t graceMs, NtpSample* samples);
+
+    // 从一组样本中选出用于校时的一个：按 偏移±误差上界 的区间求交集（Marzullo），
+    // 区间与最大交集不相交的是假报者；多数一致时在一致的样本中取时延最小的，
+    // 否则无法判断谁对，退回所有样本中时延最小的。返回与选出样本一致的样本数，没有样本为0
+    static int selectBest(const NtpSample* samples, int count, NtpSample& best);
+
+    // ---- 报文 ----
+
+    // Unix 微秒与 64 位 NTP 时间戳（1900 年起的秒 + 2^-32 秒的小数，大端）互换；
+    // 秒数小于 2^31 的按 2036 年之后的下一纪元解释
+    static void writeTimestamp(uint8_t* field, int64_t unixUs);
+    static int64_t readTimestamp(const uint8_t* field);
+
+    // 客户端请求（版本4，模式3），发送时刻 t1Us 写入 Transmit Timestamp
+    static void buildRequest(uint8_t* packet, int64_t t1Us);
+
+    // 校验应答（模式4、已同步、层级 1..15、Originate 与请求的 t1Us 一致）并计算样本，
+    // t4Us 为收到应答时的本地挂钟；不合格返回 false
+    static bool parseResponse(const uint8_t* packet, size_t length, int64_t t1Us, int64_t t4Us, NtpSample& sample);
+};
+
+#endif // SNTPCLIENT_H
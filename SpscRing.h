@@ -0,0 +1,72 @@
+/*
+ * Copyright (c) 2025 Tomosawa
+ * All rights reserved.
+ *
+ * This code is part of the WiFi2JJY project.
+ * GitHub: https://github.com/Tomosawa/WIFI2JJY
+ */
+#ifndef SPSCRING_H
+#define SPSCRING_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+
+// 无锁单生产者单消费者环形缓冲：生产者（播放任务、中断）只写 m_head，
+// 消费者只写 m_tail，两边都不加锁也不关中断。满时丢弃新元素并计数。
+// N 必须是2的幂，下标用掩码回绕。
+template<class T, size_t N>
+class SpscRing {
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "SpscRing capacity must be a power of two");
+
+public:
+    static constexpr size_t CAPACITY = N;
+
+    // 生产者：放入一个元素，满时返回 false
+    bool push(const T& item) {
+        const uint32_t head = m_head.load(std::memory_order_relaxed);
+        if (head - m_tail.load(std::memory_order_acquire) >= N) {
+            m_dropped.store(m_dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            return false;
+        }
+        m_items[head & (N - 1)] = item;
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // 消费者：取出最早的元素，空时返回 false
+    bool pop(T& item) {
+        const uint32_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail == m_head.load(std::memory_order_acquire)) {
+            return false;
+        }
+        item = m_items[tail & (N - 1)];
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // 消费者：查看最早的元素但不取出
+    bool peek(T& item) const {
+        const uint32_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail == m_head.load(std::memory_order_acquire)) {
+            return false;
+        }
+        item = m_items[tail & (N - 1)];
+        return true;
+    }
+
+    size_t size() const {
+        return m_head.load(std::memory_order_acquire) - m_tail.load(std::memory_order_acquire);
+    }
+
+    // 因为满而丢弃的元素数
+    uint32_t dropped() const { return m_dropped.load(std::memory_order_relaxed); }
+
+private:
+    T m_items[N];
+    std::atomic<uint32_t> m_head{0};
+    std::atomic<uint32_t> m_tail{0};
+    std::atomic<uint32_t> m_dropped{0};
+};
+
+#endif // SPSCRING_H
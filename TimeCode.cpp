@@ -0,0 +1,131 @@
+/*
+ * Copyright (c) 2025 Tomosawa
+ * All rights reserved.
+ *
+ * This code is part of the WiFi2JJY project.
+ * GitHub: https://github.com/Tomosawa/WIFI2JJY
+ */
+#include "TimeCode.h"
+
+// 欧盟/英国夏令时：3月最后一个星期日 01:00 UTC 至 10月最后一个星期日 01:00 UTC
+static bool euSummerTime(time_t utc) {
+    struct tm t;
+    gmtime_r(&utc, &t);
+    if (t.tm_mon < 2 || t.tm_mon > 9) {
+        return false;
+    }
+    if (t.tm_mon > 2 && t.tm_mon < 9) {
+        return true;
+    }
+    // 3月和10月都有31天
+    int lastSunday = 31 - (t.tm_wday + 31 - t.tm_mday) % 7;
+    bool changed = t.tm_mday > lastSunday || (t.tm_mday == lastSunday && t.tm_hour >= 1);
+    return t.tm_mon == 2 ? changed : !changed;
+}
+
+// 美国夏令时按日期判断：3月第二个星期日起，至11月第一个星期日前
+static bool usDstDate(const struct tm& t) {
+    if (t.tm_mon < 2 || t.tm_mon > 10) {
+        return false;
+    }
+    if (t.tm_mon > 2 && t.tm_mon < 10) {
+        return true;
+    }
+    int firstSunday = 1 + (7 - (t.tm_wday - (t.tm_mday - 1) % 7 + 7) % 7) % 7;
+    return t.tm_mon == 2 ? t.tm_mday >= firstSunday + 7 : t.tm_mday < firstSunday;
+}
+
+static bool isLeapYear(int year) {
+    return (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+}
+
+// 固定 UTC 偏移的时区时间
+static void zoneTime(time_t utc, int32_t utcOffset, struct tm& timeinfo) {
+    time_t local = utc + utcOffset;
+    gmtime_r(&local, &timeinfo);
+}
+
+void JJYCode::encode(JJYFrame& frame, time_t minute, int32_t utcOffset) {
+    struct tm timeinfo;
+    if (utcOffset == TIME_CODE_NATIVE_ZONE) {
+        localtime_r(&minute, &timeinfo);
+    } else {
+        zoneTime(minute, utcOffset, timeinfo);
+    }
+    encodeTime(frame, &timeinfo);
+}
+
+void JJYCode::encodeTime(JJYFrame& frame, const struct tm* timeinfo) {
+    // 字段位置由 JJYLayout 描述，编码器在编译期展开为固定的移位和校验
+    frame.data = FrameEncoder<JJYLayout>::encode(timeinfo);
+    frame.markers = JJYFrame::MARKER_MASK;
+}
+
+void WWVBCode::encode(JJYFrame& frame, time_t minute, int32_t utcOffset) {
+    struct tm timeinfo;
+    zoneTime(minute, utcOffset == TIME_CODE_NATIVE_ZONE ? 0 : utcOffset, timeinfo);
+    uint64_t data = FrameEncoder<WWVBLayout>::encode(&timeinfo) | WWVBLayout::Constants::MASK;
+    if (isLeapYear(timeinfo.tm_year + 1900)) {
+        data |= WWVBLayout::LeapYear::MASK;
+    }
+    // 夏令时位始终按 UTC 日期给出，由钟表自行换算
+    gmtime_r(&minute, &timeinfo);
+    if (usDstDate(timeinfo)) {
+        data |= WWVBLayout::DstToday::MASK;
+    }
+    time_t yesterday = minute - 86400;
+    gmtime_r(&yesterday, &timeinfo);
+    if (usDstDate(timeinfo)) {
+        data |= WWVBLayout::DstYesterday::MASK;
+    }
+    frame.data = data;
+    frame.markers = WWVBLayout::Markers::MASK;
+}
+
+void DCF77Code::encode(JJYFrame& frame, time_t minute, int32_t utcOffset) {
+    // 本帧发送的是下一分钟的中欧时间
+    const bool native = utcOffset == TIME_CODE_NATIVE_ZONE;
+    time_t utc = minute + 60;
+    bool summer = native && euSummerTime(utc);
+    struct tm timeinfo;
+    zoneTime(utc, native ? (summer ? 7200 : 3600) : utcOffset, timeinfo);
+
+    uint64_t data = FrameEncoder<DCF77Layout>::encode(&timeinfo) | DCF77Layout::Constants::MASK;
+    data |= summer ? DCF77Layout::Cest::MASK : DCF77Layout::Cet::MASK;
+    if (native && euSummerTime(minute) != euSummerTime(minute + 3600)) {
+        data |= DCF77Layout::Announce::MASK;
+    }
+    frame.data = data;
+    frame.markers = 0;
+}
+
+void MSFCode::encode(JJYFrame& frame, time_t minute, int32_t utcOffset) {
+    // 本帧发送的是下一分钟的英国时间
+    const bool native = utcOffset == TIME_CODE_NATIVE_ZONE;
+    time_t utc = minute + 60;
+    bool summer = native && euSummerTime(utc);
+    struct tm timeinfo;
+    zoneTime(utc, native ? (summer ? 3600 : 0) : utcOffset, timeinfo);
+
+    uint64_t a = FrameEncoder<MSFLayout>::encode(&timeinfo);
+    uint64_t b = encodeParities(MSFLayout::BParities{}, a);
+    if (summer) {
+        b |= MSFLayout::Summer::MASK;
+    }
+    if (native && euSummerTime(minute) != euSummerTime(minute + 61 * 60)) {
+        b |= MSFLayout::SummerSoon::MASK;
+    }
+    frame.data = a | MSFLayout::Constants::MASK;
+    frame.markers = b;
+}
+
+static constexpr TimeCode TIME_CODES[PROTOCOL_COUNT] = {
+    TimeCode::of<JJYCode>(),
+    TimeCode::of<WWVBCode>(),
+    TimeCode::of<DCF77Code>(),
+    TimeCode::of<MSFCode>(),
+};
+
+const TimeCode& TimeCode::get(TimeCodeProtocol protocol) {
+    return protocol < PROTOCOL_COUNT ? TIME_CODES[protocol] : TIME_CODES[PROTOCOL_JJY];
+}
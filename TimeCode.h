@@ -0,0 +1,242 @@
+/*
+ * Copyright (c) 2025 Tomosawa
+ * All rights reserved.
+ *
+ * This code is part of the WiFi2JJY project.
+ * GitHub: https://github.com/Tomosawa/WIFI2JJY
+ */
+#ifndef TIMECODE_H
+#define TIMECODE_H
+
+#include <stdint.h>
+#include <time.h>
+#include "FrameLayout.h"
+#include "JJYFrame.h"
+
+// 多协议时间码：每个协议由一个编码结构描述（帧布局 + 编码函数 + 脉冲形状表），
+// 都编码到同一种 JJYFrame 位平面表示，再由 JJYTimeline 按形状表编译成边沿，
+// 因此所有协议共用同一套时间表、帧缓存和输出后端。
+// 编译期可直接使用 JJYCode / WWVBCode / DCF77Code / MSFCode，
+// 运行时按 TimeCodeProtocol 取得对应的 TimeCode 描述。
+// 编码的时区 utcOffset 为 TIME_CODE_NATIVE_ZONE 时按协议自身的规则（JJY 为系统时区，
+// WWVB 为 UTC，DCF77/MSF 为带夏令时的中欧/英国时间）；否则按固定的 UTC 偏移（秒）编码，
+// 不使用夏令时，用于让钟表显示其他时区的时间。
+
+static constexpr int32_t TIME_CODE_NATIVE_ZONE = INT32_MIN;
+
+enum TimeCodeProtocol : uint8_t {
+    PROTOCOL_JJY,    // 日本 40/60kHz，本地时间（系统时区）
+    PROTOCOL_WWVB,   // 美国 60kHz，UTC
+    PROTOCOL_DCF77,  // 德国 77.5kHz，中欧时间，发送下一分钟
+    PROTOCOL_MSF,    // 英国 60kHz，英国时间，发送下一分钟
+    PROTOCOL_COUNT
+};
+
+// 一次电平跳变：相对该秒开始的偏移与跳变后的DA电平（低电平为满幅载波）
+struct TimeCodeEdge {
+    int32_t offsetUs;
+    uint8_t level;
+};
+
+// 一秒内的跳变序列，最多两个脉冲
+struct TimeCodePulse {
+    uint8_t count;
+    TimeCodeEdge edges[4];
+};
+
+// 协议的脉冲形状表
+struct TimeCodeShapes {
+    TimeCodePulse symbols[4];  // 按 JJYFrame::Symbol 下标
+    uint64_t specialMask;      // 不按码元、改用 special 的秒（DCF77 第59秒、MSF 第0秒）
+    TimeCodePulse special;
+    uint8_t idleLevel;         // 脉冲之间及帧与帧之间的DA电平
+};
+
+// JJY：每秒开始满幅，脉冲宽度后降到10%
+struct JJYCode {
+    static constexpr TimeCodeProtocol PROTOCOL = PROTOCOL_JJY;
+    static constexpr const char* NAME = "JJY";
+    static constexpr uint32_t CARRIER_HZ = 40000;
+    static constexpr uint8_t REDUCED_PERCENT = 10;
+    static constexpr uint8_t AUDIO_DIVISOR = 3;
+    static constexpr TimeCodeShapes SHAPES = {
+        {{2, {{0, 0}, {800000, 1}}},
+         {2, {{0, 0}, {500000, 1}}},
+         {2, {{0, 0}, {200000, 1}}},
+         {2, {{0, 0}, {200000, 1}}}},
+        0, {0, {}}, 1};
+
+    static void encode(JJYFrame& frame, time_t minute, int32_t utcOffset);
+
+    // 直接按 timeinfo 的字段编码
+    static void encodeTime(JJYFrame& frame, const struct tm* timeinfo);
+};
+
+// WWVB 帧布局（UTC，发送本分钟）
+struct WWVBLayout {
+    // 分钟、小时、年积日与 JJY 位置相同
+    using Minute = Field<BcdField<BitGroup<1, 3>, BitGroup<5, 4>>, TmMinute>;
+    using Hour = Field<BcdField<BitGroup<12, 2>, BitGroup<15, 4>>, TmHour>;
+    using DayOfYear = Field<BcdField<BitGroup<22, 2>, BitGroup<25, 4>, BitGroup<30, 4>>, TmDayOfYear>;
+    // 年份（45-53位）：十位45-48位，第49位为标记，个位50-53位
+    using Year = Field<BcdField<BitGroup<45, 4>, BitGroup<50, 4>>, TmYear2>;
+
+    using Fields = FieldList<Minute, Hour, DayOfYear, Year>;
+    using Parities = ParityList<>;
+    using Markers = MarkerList<0, 9, 19, 29, 39, 49, 59>;
+
+    // DUT1 符号（36-38位）固定为 "+"（101），DUT1 值（40-43位）为0
+    using Constants = SecondList<36, 38>;
+    using LeapYear = SecondList<55>;
+    using DstToday = SecondList<57>;      // 当天（UTC）为夏令时日
+    using DstYesterday = SecondList<58>;  // 前一天为夏令时日
+};
+
+static_assert(masksDisjoint({WWVBLayout::Minute::MASK, WWVBLayout::Hour::MASK, WWVBLayout::DayOfYear::MASK,
+                             WWVBLayout::Year::MASK, WWVBLayout::Markers::MASK, WWVBLayout::Constants::MASK,
+                             WWVBLayout::LeapYear::MASK, WWVBLayout::DstToday::MASK,
+                             WWVBLayout::DstYesterday::MASK}),
+              "WWVB layout fields overlap");
+
+// WWVB：每秒开始降功率，数据位0/1/标记分别 0.2/0.5/0.8 秒后恢复满幅
+struct WWVBCode {
+    static constexpr TimeCodeProtocol PROTOCOL = PROTOCOL_WWVB;
+    static constexpr const char* NAME = "WWVB";
+    static constexpr uint32_t CARRIER_HZ = 60000;
+    static constexpr uint8_t REDUCED_PERCENT = 14;  // -17dB
+    static constexpr uint8_t AUDIO_DIVISOR = 3;
+    static constexpr TimeCodeShapes SHAPES = {
+        {{2, {{0, 1}, {200000, 0}}},
+         {2, {{0, 1}, {500000, 0}}},
+         {2, {{0, 1}, {800000, 0}}},
+         {2, {{0, 1}, {800000, 0}}}},
+        0, {0, {}}, 0};
+
+    static void encode(JJYFrame& frame, time_t minute, int32_t utcOffset);
+};
+
+// DCF77 帧布局（中欧时间，发送下一分钟），各字段低位在前
+struct DCF77Layout {
+    // 分钟（21-27位）：个位21-24位，十位25-27位
+    using Minute = Field<BcdField<LsbFirstBitGroup<25, 3>, LsbFirstBitGroup<21, 4>>, TmMinute>;
+    // 小时（29-34位）
+    using Hour = Field<BcdField<LsbFirstBitGroup<33, 2>, LsbFirstBitGroup<29, 4>>, TmHour>;
+    // 日（36-41位）
+    using Day = Field<BcdField<LsbFirstBitGroup<40, 2>, LsbFirstBitGroup<36, 4>>, TmMonthDay>;
+    // 星期（42-44位）：1=星期一 ... 7=星期日
+    using WeekDay = Field<BinaryField<LsbFirstBitGroup<42, 3>>, TmIsoWeekDay>;
+    // 月（45-49位）
+    using Month = Field<BcdField<LsbFirstBitGroup<49, 1>, LsbFirstBitGroup<45, 4>>, TmMonth>;
+    // 年（50-57位）：只编码后两位
+    using Year = Field<BcdField<LsbFirstBitGroup<54, 4>, LsbFirstBitGroup<50, 4>>, TmYear2>;
+
+    using Fields = FieldList<Minute, Hour, Day, WeekDay, Month, Year>;
+    using Parities = ParityList<EvenParity<28, Minute>, EvenParity<35, Hour>,
+                                EvenParity<58, Day, WeekDay, Month, Year>>;
+    using Markers = MarkerList<>;  // 分钟标记为第59秒不降幅，由形状表处理
+
+    using Constants = SecondList<20>;  // 时间信息开始
+    using Announce = SecondList<16>;   // 一小时内切换夏令时
+    using Cest = SecondList<17>;
+    using Cet = SecondList<18>;
+};
+
+static_assert(masksDisjoint({DCF77Layout::Minute::MASK | DCF77Layout::Hour::MASK | DCF77Layout::Day::MASK |
+                                 DCF77Layout::WeekDay::MASK | DCF77Layout::Month::MASK | DCF77Layout::Year::MASK,
+                             DCF77Layout::Constants::MASK, DCF77Layout::Announce::MASK,
+                             DCF77Layout::Cest::MASK, DCF77Layout::Cet::MASK}),
+              "DCF77 layout fields overlap");
+
+// DCF77：每秒开始降幅，数据位0/1分别 0.1/0.2 秒，第59秒不降幅
+struct DCF77Code {
+    static constexpr TimeCodeProtocol PROTOCOL = PROTOCOL_DCF77;
+    static constexpr const char* NAME = "DCF77";
+    static constexpr uint32_t CARRIER_HZ = 77500;
+    static constexpr uint8_t REDUCED_PERCENT = 15;
+    static constexpr uint8_t AUDIO_DIVISOR = 5;  // 15.5kHz 的5次谐波
+    static constexpr TimeCodeShapes SHAPES = {
+        {{2, {{0, 1}, {100000, 0}}},
+         {2, {{0, 1}, {200000, 0}}},
+         {2, {{0, 1}, {100000, 0}}},
+         {2, {{0, 1}, {200000, 0}}}},
+        frameSecondBit(59), {0, {}}, 0};
+
+    static void encode(JJYFrame& frame, time_t minute, int32_t utcOffset);
+};
+
+// MSF 帧布局（英国时间，发送下一分钟）：字段在 A 位平面，奇校验在 B 位平面
+struct MSFLayout {
+    // 年（17-24位）：只编码后两位
+    using Year = Field<BcdField<BitGroup<17, 4>, BitGroup<21, 4>>, TmYear2>;
+    // 月（25-29位）
+    using Month = Field<BcdField<BitGroup<25, 1>, BitGroup<26, 4>>, TmMonth>;
+    // 日（30-35位）
+    using Day = Field<BcdField<BitGroup<30, 2>, BitGroup<32, 4>>, TmMonthDay>;
+    // 星期（36-38位）：0=星期日 ... 6=星期六
+    using WeekDay = Field<BinaryField<BitGroup<36, 3>>, TmWeekDay>;
+    // 小时（39-44位）
+    using Hour = Field<BcdField<BitGroup<39, 2>, BitGroup<41, 4>>, TmHour>;
+    // 分钟（45-51位）
+    using Minute = Field<BcdField<BitGroup<45, 3>, BitGroup<48, 4>>, TmMinute>;
+
+    using Fields = FieldList<Year, Month, Day, WeekDay, Hour, Minute>;
+    using Parities = ParityList<>;
+    using Markers = MarkerList<>;  // 第0秒的分钟标记由形状表处理
+
+    // A 位 52-59 为固定的 01111110
+    using Constants = SecondList<53, 54, 55, 56, 57, 58>;
+    // B 位平面
+    using BParities = ParityList<OddParity<54, Year>, OddParity<55, Month, Day>,
+                                 OddParity<56, WeekDay>, OddParity<57, Hour, Minute>>;
+    using SummerSoon = SecondList<53>;  // 61分钟内切换夏令时
+    using Summer = SecondList<58>;      // 夏令时（BST）
+};
+
+static_assert(masksDisjoint({MSFLayout::Year::MASK | MSFLayout::Month::MASK | MSFLayout::Day::MASK |
+                                 MSFLayout::WeekDay::MASK | MSFLayout::Hour::MASK | MSFLayout::Minute::MASK,
+                             MSFLayout::Constants::MASK}),
+              "MSF A bits overlap");
+static_assert(masksDisjoint({SecondList<54, 55, 56, 57>::MASK,
+                             MSFLayout::SummerSoon::MASK, MSFLayout::Summer::MASK}),
+              "MSF B bits overlap");
+
+// MSF：每秒开始断载波 0.1 秒，随后 A 位、B 位各占 0.1 秒；第0秒断 0.5 秒
+struct MSFCode {
+    static constexpr TimeCodeProtocol PROTOCOL = PROTOCOL_MSF;
+    static constexpr const char* NAME = "MSF";
+    static constexpr uint32_t CARRIER_HZ = 60000;
+    static constexpr uint8_t REDUCED_PERCENT = 0;  // 断载波
+    static constexpr uint8_t AUDIO_DIVISOR = 3;
+    static constexpr TimeCodeShapes SHAPES = {
+        {{2, {{0, 1}, {100000, 0}}},                                   // A=0 B=0
+         {2, {{0, 1}, {200000, 0}}},                                   // A=1 B=0
+         {4, {{0, 1}, {100000, 0}, {200000, 1}, {300000, 0}}},         // A=0 B=1
+         {2, {{0, 1}, {300000, 0}}}},                                  // A=1 B=1
+        frameSecondBit(0), {2, {{0, 1}, {500000, 0}}}, 0};
+
+    static void encode(JJYFrame& frame, time_t minute, int32_t utcOffset);
+};
+
+// 运行时的协议描述
+struct TimeCode {
+    // 按 utcOffset 时区编码从 minute（整分的UTC秒数）开始发送的一帧
+    using EncodeFn = void (*)(JJYFrame& frame, time_t minute, int32_t utcOffset);
+
+    TimeCodeProtocol protocol;
+    const char* name;
+    uint32_t carrierHz;       // 标准载波频率
+    uint8_t reducedPercent;   // 降幅时的载波幅度（满幅的百分比）
+    uint8_t audioDivisor;     // 音频输出时载波的分频比，扬声器的该次谐波落在载波上
+    const TimeCodeShapes* shapes;
+    EncodeFn encode;
+
+    template<class Code>
+    static constexpr TimeCode of() {
+        return {Code::PROTOCOL, Code::NAME, Code::CARRIER_HZ, Code::REDUCED_PERCENT,
+                Code::AUDIO_DIVISOR, &Code::SHAPES, &Code::encode};
+    }
+
+    static const TimeCode& get(TimeCodeProtocol protocol);
+};
+
+#endif // TIMECODE_H
@@ -8,34 +8,91 @@
 #ifndef TIMESYNC_H
 #define TIMESYNC_H
 
-#include <sys/time.h>
-#include "freertos/FreeRTOS.h"
-#include "freertos/task.h"
+#include <stdint.h>
+#include <time.h>
+#include "ClockDiscipline.h"
+#include "SntpClient.h"
 
 class TimeSync {
 public:
+    // 当前时间的来源
+    enum Source {
+        SOURCE_NONE,      // 还没有可用的时间
+        SOURCE_NTP,       // 本次唤醒已 NTP 校时
+        SOURCE_FREE_RUN,  // 还没到校时间隔，按驯服后的本地时钟
+        SOURCE_HOLDOVER   // 该校时但网络不可用，误差估计在上限内，按本地时钟守时
+    };
+
     TimeSync();
     
-    // 使用硬件 RTC 定时器，在不睡眠的情况下等到下一整分 0 秒
-    void waitUntilNextMinuteRTC();
+    // 设置时区并从 NVS 载入时钟驯服状态（setup 时调用一次）
+    void begin();
 
     //网络更新同步NTP系统时间
     void syncNTPTime();
 
+    // 是否需要 NTP 校时（到了校时间隔，或误差估计超过守时上限）；
+    // 不需要时调用 freeRun 按学到的频率修正挂钟，直接视为已同步
+    bool syncDue() const;
+    void freeRun();
+
+    // WiFi 或 NTP 不可用时调用：误差估计不超过上限就按本地时钟守时并视为已同步，否则返回 false
+    bool holdover();
+    // 守时允许的误差上限（微秒，默认 100ms）
+    void setHoldoverLimit(uint32_t limitUs) { m_holdoverLimitUs = limitUs; }
+    uint32_t holdoverLimitUs() const { return m_holdoverLimitUs; }
+
+    // 当前挂钟的误差上界估计（微秒），从没校时过为 INT64_MAX
+    int64_t estimatedErrorUs() const;
+    Source source() const { return m_source; }
+    static const char* sourceName(Source source);
+
+    // 最近一次 syncNTPTime 是否因没有服务器应答而失败
+    bool syncFailed() const { return m_syncFailed; }
+
+    // 已同步后周期调用（内部限频）：把频率修正渐进加到挂钟上
+    void tickDiscipline();
+    // 深度睡眠前调用：应用到当前为止的修正并保存
+    void saveDiscipline();
+
+    const ClockDiscipline& discipline() const { return m_discipline; }
+
     //启动NTP同步任务
     bool startNTPSyncTask();
 
+    // 当前挂钟时间（UTC 微秒）
+    static int64_t wallTimeUs();
+
+    // 把挂钟时间换算成单调时钟（hal::monotonicUs）时间，每次调用都按当前的对应关系重新换算
+    static int64_t wallToMonotonicUs(int64_t wallUs);
+
+    // 时钟代数：每次系统时间被NTP步进调整后加一，用于失效预编码的帧
+    uint32_t clockGeneration() const;
+
+    // 最近一次成功校时的测量（偏移、时延、误差上界），未校时前全为0
+    const NtpSample& lastSample() const { return m_lastSample; }
+
     // 时间是否已同步
     bool timeSynced = false;
 private:
-    // NTP同步任务句柄
-    TaskHandle_t m_ntpSyncTaskHandle;
+    static constexpr uint32_t NTP_TIMEOUT_MS = 1500;  // 发出请求后最多等多久
+    static constexpr uint32_t NTP_GRACE_MS = 250;     // 首个应答后再等其余服务器多久
+    static constexpr uint32_t NTP_RETRY_MS = 500;     // 一轮都失败后的间隔
+    static constexpr int NTP_ROUNDS = 3;
+    static constexpr int64_t NTP_STEP_THRESHOLD_US = 128000;  // 偏差不小于此值时步进（同 ntpd）
+    static constexpr int64_t UNSET_BEFORE_US = 1000000000LL * 1000000LL;  // 2001年之前视为挂钟未设置
 
-    // 静态任务函数，用于FreeRTOS任务
+    NtpSample m_lastSample;
+    ClockDiscipline m_discipline;
+    uint32_t m_holdoverLimitUs = 100000;
+    volatile Source m_source = SOURCE_NONE;
+    volatile bool m_syncFailed = false;
+
+    // NTP同步任务是否在运行
+    volatile bool m_ntpSyncRunning = false;
+
+    // 静态任务函数，用于后台任务
     static void ntpSyncTask(void *pvParameters);
-    
-    //重新同步时间，避免系统时间和微秒时钟差异过大
-    bool resyncTime(time_t now_s, int64_t cur_us, time_t& next_min_s, int64_t& target_us, int seconds_to_next_minute) const;
 };
 
 #endif // TIMESYNC_H
\ No newline at end of file
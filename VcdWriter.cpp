@@ -0,0 +1,120 @@
+/*
+ * Copyright (c) 2025 Tomosawa
+ * All rights reserved.
+ *
+ * This code is part of the WiFi2JJY project.
+ * GitHub: https://github.com/Tomosawa/WIFI2JJY
+ */
+#include "VcdWriter.h"
+#include <stdio.h>
+#include <string.h>
+
+VcdWriter::VcdWriter(Sink sink, void* context)
+    : m_sink(sink), m_context(context), m_count(0), m_originUs(0), m_lastTime(-1) {
+}
+
+int VcdWriter::addWire(const char* name) {
+    if (m_count >= MAX_SIGNALS) {
+        return -1;
+    }
+    m_signals[m_count] = {name, false};
+    return m_count++;
+}
+
+int VcdWriter::addString(const char* name) {
+    if (m_count >= MAX_SIGNALS) {
+        return -1;
+    }
+    m_signals[m_count] = {name, true};
+    return m_count++;
+}
+
+void VcdWriter::write(const char* text) {
+    m_sink(m_context, text, strlen(text));
+}
+
+void VcdWriter::begin(int64_t originUs, const char* comment) {
+    m_originUs = originUs;
+    m_lastTime = -1;
+
+    char line[96];
+    write("$comment ");
+    write(comment);
+    write(" $end\n$timescale 1us $end\n$scope module wifi2jjy $end\n");
+    for (int i = 0; i < m_count; i++) {
+        snprintf(line, sizeof(line), "$var %s 1 %c %s $end\n",
+                 m_signals[i].isString ? "string" : "wire", idOf(i), m_signals[i].name);
+        write(line);
+    }
+    write("$upscope $end\n$enddefinitions $end\n");
+
+    // 初始值未知
+    write("$dumpvars\n");
+    for (int i = 0; i < m_count; i++) {
+        snprintf(line, sizeof(line), m_signals[i].isString ? "s- %c\n" : "x%c\n", idOf(i));
+        write(line);
+    }
+    write("$end\n");
+}
+
+void VcdWriter::writeTime(int64_t timeUs) {
+    int64_t time = timeUs - m_originUs;
+    if (time < 0) {
+        time = 0;
+    }
+    if (time <= m_lastTime) {
+        return;
+    }
+    char line[32];
+    snprintf(line, sizeof(line), "#%lld\n", (long long)time);
+    write(line);
+    m_lastTime = time;
+}
+
+void VcdWriter::change(int signal, bool level, int64_t timeUs) {
+    if (signal < 0 || signal >= m_count) {
+        return;
+    }
+    writeTime(timeUs);
+    char line[4] = {level ? '1' : '0', idOf(signal), '\n', '\0'};
+    write(line);
+}
+
+void VcdWriter::annotate(int signal, const char* text, int64_t timeUs) {
+    if (signal < 0 || signal >= m_count) {
+        return;
+    }
+    writeTime(timeUs);
+    char line[80];
+    int length = snprintf(line, sizeof(line) - 4, "s%s", text);
+    if (length < 0) {
+        return;
+    }
+    if (length > (int)sizeof(line) - 5) {
+        length = sizeof(line) - 5;
+    }
+    for (int i = 1; i < length; i++) {
+        if (line[i] == ' ' || line[i] == '\t' || line[i] == '\n' || line[i] == '\r') {
+            line[i] = '_';
+        }
+    }
+    line[length++] = ' ';
+    line[length++] = idOf(signal);
+    line[length++] = '\n';
+    line[length] = '\0';
+    write(line);
+}
+
+void VcdWriter::comment(const char* text) {
+    write("$comment ");
+    write(text);
+    write(" $end\n");
+}
+
+void VcdWriter::end(int64_t timeUs) {
+    writeTime(timeUs);
+}
+
+void VcdWriter::fileSink(void* context, const char* data, size_t length) {
+    fwrite(data, 1, length, static_cast<FILE*>(context));
+}
@@ -0,0 +1,67 @@
+/*
+ * Copyright (c) 2025 Tomosawa
+ * All rights reserved.
+ *
+ * This code is part of the WiFi2JJY project.
+ * GitHub: https://github.com/Tomosawa/WIFI2JJY
+ */
+#ifndef VCDWRITER_H
+#define VCDWRITER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// 流式 VCD（Value Change Dump）写出器：每个电平变化立即格式化并交给 sink，
+// 内部只有固定大小的行缓冲，任意长的记录也不会占用更多内存。
+// 时间单位为微秒（$timescale 1us），可用 PulseView（sigrok）或 GTKWave 打开。
+// 字符串信号（帧注释）使用 GTKWave 的 string 扩展，PulseView 会忽略它。
+class VcdWriter {
+public:
+    typedef void (*Sink)(void* context, const char* data, size_t length);
+
+    static constexpr int MAX_SIGNALS = 8;
+
+    VcdWriter(Sink sink, void* context);
+
+    // 在 begin 之前声明信号，返回信号编号（超出 MAX_SIGNALS 时为 -1）
+    int addWire(const char* name);
+    int addString(const char* name);
+
+    // 写文件头；originUs 为时间0对应的时刻，之后的时间都用同一时钟
+    void begin(int64_t originUs, const char* comment);
+
+    // 信号变化；时间早于已写出的时间时按已写出的时间记录（VCD 要求时间不减）
+    void change(int signal, bool level, int64_t timeUs);
+    // 字符串信号变化，空白字符替换为 '_'
+    void annotate(int signal, const char* text, int64_t timeUs);
+
+    // 在当前位置插入一段注释（例如丢弃的事件数）
+    void comment(const char* text);
+
+    // 写出最后的时间戳，让查看器显示到 timeUs 为止
+    void end(int64_t timeUs);
+
+    // 写到 stdio 文件（context 为 FILE*）
+    static void fileSink(void* context, const char* data, size_t length);
+
+private:
+    struct Signal {
+        const char* name;
+        bool isString;
+    };
+
+    Sink m_sink;
+    void* m_context;
+    Signal m_signals[MAX_SIGNALS];
+    int m_count;
+    int64_t m_originUs;
+    int64_t m_lastTime;  // 已写出的最后一个时间戳（相对 originUs），-1 为尚未写出
+
+    void write(const char* text);
+    void writeTime(int64_t timeUs);
+
+    // 信号的 VCD 标识符：'!' 起的可打印字符
+    static char idOf(int signal) { return (char)('!' + signal); }
+};
+
+#endif // VCDWRITER_H
@@ -6,10 +6,12 @@
  * GitHub: https://github.com/Tomosawa/WIFI2JJY
  */
 #include "WebService.h"
-#include <WebServer.h>
+#include <stdio.h>
+#include <string.h>
+#include "TimeSync.h"
 
-WebService::WebService(WiFiManager* wifiManager) : m_wifiManager(wifiManager), m_running(false) {
-    m_server = new WebServer(m_port);
+WebService::WebService(WiFiManager* wifiManager, int port) : m_wifiManager(wifiManager), m_running(false) {
+    m_server = new hal::HttpServer(port);
     m_wifiConfigPage = new WiFiConfigPage();
 }
 
@@ -28,12 +30,12 @@ void WebService::begin() {
     }
     
     // 设置路由处理函数
-    m_server->on("/", [this]() { handleRoot(); });
-    m_server->on("/scan", HTTP_GET, [this]() { handleScan(); });
-    m_server->on("/connect", HTTP_POST, [this]() { handleConnect(); });
-    m_server->on("/status", HTTP_GET, [this]() { handleStatus(); });
-    m_server->on("/reset", HTTP_POST, [this]() { handleReset(); });
-    m_server->on("/reboot", HTTP_POST, [this]() { handleReboot(); });
+    m_server->on("/", hal::HTTP_METHOD_ANY, [this]() { handleRoot(); });
+    m_server->on("/scan", hal::HTTP_METHOD_GET, [this]() { handleScan(); });
+    m_server->on("/connect", hal::HTTP_METHOD_POST, [this]() { handleConnect(); });
+    m_server->on("/status", hal::HTTP_METHOD_GET, [this]() { handleStatus(); });
+    m_server->on("/reset", hal::HTTP_METHOD_POST, [this]() { handleReset(); });
+    m_server->on("/reboot", hal::HTTP_METHOD_POST, [this]() { handleReboot(); });
     
     // 404处理
     m_server->onNotFound([this]() { handleNotFound(); });
@@ -42,7 +44,7 @@ void WebService::begin() {
     m_server->begin();
     m_running = true;
     
-    Serial.printf("[WebService] Server started on port %d\n", m_port);
+    hal::log("[WebService] Server started on port %d\n", m_server->port());
 }
 
 void WebService::handleClient() {
@@ -56,7 +58,7 @@ bool WebService::isRunning() {
 }
 
 void WebService::handleRoot() {
-    m_wifiConfigPage->sendPage(&m_server->client());
+    m_wifiConfigPage->sendPage(m_server);
 }
 
 void WebService::handleScan() {
@@ -68,38 +70,20 @@ void WebService::handleScan() {
         return;
     }
 
-    String json = "{\"status\":\"success\",\"networks\":[";
-    
-    bool first = true;
-    for (int i = 0; i < networkCount; i++) {
-        String ssid = m_wifiManager->getScannedSSID(i);
-        if (ssid.length() == 0) continue; // 跳过无效的网络
-        
-        if (!first) json += ",";
-        first = false;
-        
-        json += "{";
-        json += "\"ssid\":\"" + escapeJSON(ssid) + "\",";
-        json += "\"rssi\":" + String(m_wifiManager->getScannedRSSI(i)) + ",";
-        json += "\"encryption\":\"" + m_wifiManager->getScannedEncryptionType(i) + "\"";
-        json += "}";
-    }
-    
-    json += "],\"count\":" + String(networkCount) + "}";
-    sendResponse(200, "application/json", json);
+    sendResponse(200, "application/json", getScanJSON(networkCount));
 }
 
 void WebService::handleConnect() {
-    String ssid = m_server->arg("ssid");
-    String password = m_server->arg("password");
-    Serial.println("ssid = " + ssid);
-    Serial.println("password = " + password);
+    std::string ssid = m_server->arg("ssid");
+    std::string password = m_server->arg("password");
+    hal::log("ssid = %s\n", ssid.c_str());
+    hal::log("password = %s\n", password.c_str());
     if (ssid.length() == 0) {
         sendResponse(400, "application/json", "{\"status\":\"error\",\"message\":\"SSID is required\"}");
         return;
     }
     
-    Serial.printf("[WebService] Connecting to WiFi (async): %s\n", ssid.c_str());
+    hal::log("[WebService] Connecting to WiFi (async): %s\n", ssid.c_str());
     m_wifiManager->startAsyncConnect(ssid, password);
     
     // 立即返回，前端可轮询 /status
@@ -107,7 +91,7 @@ void WebService::handleConnect() {
 }
 
 void WebService::handleStatus() {
-    String json = getStatusJSON();
+    std::string json = getStatusJSON();
     sendResponse(200, "application/json", json);
 }
 
@@ -119,47 +103,74 @@ void WebService::handleReset() {
 
 void WebService::handleReboot() {
     sendResponse(200, "application/json", "{\"status\":\"success\",\"message\":\"Rebooting\"}");
-    Serial.println("[WebService] Reboot requested via /reboot");
-    delay(200);
-    esp_restart();
+    hal::log("[WebService] Reboot requested via /reboot\n");
+    hal::sleepMs(200);
+    hal::restart();
 }
 
 void WebService::handleNotFound() {
     sendResponse(404, "text/plain", "Not Found");
 }
 
-String WebService::getContentType(const String& path) {
-    if (path.endsWith(".html")) return "text/html";
-    else if (path.endsWith(".css")) return "text/css";
-    else if (path.endsWith(".js")) return "application/javascript";
-    else if (path.endsWith(".png")) return "image/png";
-    else if (path.endsWith(".jpg")) return "image/jpeg";
-    else if (path.endsWith(".gif")) return "image/gif";
-    else if (path.endsWith(".ico")) return "image/x-icon";
+static bool endsWith(const std::string& text, const char* suffix) {
+    size_t length = strlen(suffix);
+    return text.size() >= length && text.compare(text.size() - length, length, suffix) == 0;
+}
+
+std::string WebService::getContentType(const std::string& path) {
+    if (endsWith(path, ".html")) return "text/html";
+    else if (endsWith(path, ".css")) return "text/css";
+    else if (endsWith(path, ".js")) return "application/javascript";
+    else if (endsWith(path, ".png")) return "image/png";
+    else if (endsWith(path, ".jpg")) return "image/jpeg";
+    else if (endsWith(path, ".gif")) return "image/gif";
+    else if (endsWith(path, ".ico")) return "image/x-icon";
     return "text/plain";
 }
 
-void WebService::sendResponse(int code, const String& type, const String& content) {
+void WebService::sendResponse(int code, const char* type, const std::string& content) {
     m_server->sendHeader("Access-Control-Allow-Origin", "*");
     m_server->sendHeader("Access-Control-Allow-Methods", "GET, POST, OPTIONS");
     m_server->sendHeader("Access-Control-Allow-Headers", "Content-Type");
     m_server->send(code, type, content);
 }
 
-String WebService::getNetworkListJSON() {
+std::string WebService::getScanJSON(int networkCount) {
+    std::string json = "{\"status\":\"success\",\"networks\":[";
+    
+    bool first = true;
+    for (int i = 0; i < networkCount; i++) {
+        std::string ssid = m_wifiManager->getScannedSSID(i);
+        if (ssid.length() == 0) continue; // 跳过无效的网络
+        
+        if (!first) json += ",";
+        first = false;
+        
+        json += "{";
+        json += "\"ssid\":\"" + escapeJSON(ssid) + "\",";
+        json += "\"rssi\":" + std::to_string(m_wifiManager->getScannedRSSI(i)) + ",";
+        json += "\"encryption\":\"" + m_wifiManager->getScannedEncryptionType(i) + "\"";
+        json += "}";
+    }
+    
+    json += "],\"count\":" + std::to_string(networkCount) + "}";
+    return json;
+}
+
+std::string WebService::getNetworkListJSON() {
     int networkCount = m_wifiManager->getScannedNetwork();
-    if(networkCount == 0) return "";
-    String json = "[";
+    if(networkCount <= 0) return "";
+    std::string json = "[";
 
     for (int i = 0; i < networkCount; i++) {
-        String ssid = m_wifiManager->getScannedSSID(i);
+        std::string ssid = m_wifiManager->getScannedSSID(i);
         if (ssid.length() == 0) continue; // Skip invalid networks
         
-        if (i > 0) json += ",";
+        if (json.length() > 1) json += ",";
         
         json += "{";
         json += "\"ssid\":\"" + escapeJSON(ssid) + "\",";
-        json += "\"rssi\":" + String(m_wifiManager->getScannedRSSI(i)) + ",";
+        json += "\"rssi\":" + std::to_string(m_wifiManager->getScannedRSSI(i)) + ",";
         json += "\"encryption\":\"" + m_wifiManager->getScannedEncryptionType(i) + "\"";
         json += "}";
     }
@@ -168,26 +179,50 @@ String WebService::getNetworkListJSON() {
     return json;
 }
 
-String WebService::getStatusJSON() {
-    String json = "{";
-    json += "\"connected\":" + String(m_wifiManager->isConnected() ? "true" : "false") + ",";
+std::string WebService::getStatusJSON() {
+    std::string json = "{";
+    json += "\"connected\":" + std::string(m_wifiManager->isConnected() ? "true" : "false") + ",";
     json += "\"status\":\"" + m_wifiManager->getConnectionStatus() + "\",";
     json += "\"ip\":\"" + m_wifiManager->getLocalIP() + "\",";
-    json += "\"ssid\":\"" + m_wifiManager->getSavedSSID() + "\",";
+    json += "\"ssid\":\"" + escapeJSON(m_wifiManager->getSavedSSID()) + "\",";
     json += "\"saved\":{";
-    json += "\"ssid\":\"" + m_wifiManager->getSavedSSID() + "\",";
-    json += "\"password\":\"" + m_wifiManager->getSavedPassword() + "\"";
+    json += "\"ssid\":\"" + escapeJSON(m_wifiManager->getSavedSSID()) + "\",";
+    json += "\"password\":\"" + escapeJSON(m_wifiManager->getSavedPassword()) + "\"";
+    json += "}";
+    if (m_timeSync) {
+        json += "," + getTimeJSON();
+    }
     json += "}";
+    return json;
+}
+
+std::string WebService::getTimeJSON() {
+    const ClockDiscipline& discipline = m_timeSync->discipline();
+    const int64_t errorUs = m_timeSync->estimatedErrorUs();
+    char buffer[64];
+    std::string json = "\"time\":{";
+    json += "\"source\":\"" + std::string(TimeSync::sourceName(m_timeSync->source())) + "\",";
+    json += "\"synced\":" + std::string(m_timeSync->timeSynced ? "true" : "false") + ",";
+    // 从没校时过时误差和距上次校时都未知
+    json += "\"errorUs\":" + (errorUs == INT64_MAX ? std::string("null") : std::to_string(errorUs)) + ",";
+    json += "\"limitUs\":" + std::to_string(m_timeSync->holdoverLimitUs()) + ",";
+    json += "\"lastSyncS\":" +
+            (discipline.referenceUs() == 0
+                 ? std::string("null")
+                 : std::to_string((hal::wallTimeUs() - discipline.referenceUs()) / 1000000LL)) + ",";
+    snprintf(buffer, sizeof(buffer), "%.3f", discipline.frequencyPpb() / 1000.0);
+    json += "\"frequencyPpm\":" + std::string(buffer) + ",";
+    json += "\"pollS\":" + std::to_string(discipline.pollIntervalS());
     json += "}";
     return json;
 }
 
-String WebService::escapeJSON(const String& input) {
-    String output;
+std::string WebService::escapeJSON(const std::string& input) {
+    std::string output;
     output.reserve(input.length() * 1.1); // Reserve some extra space for escape characters
     
     for (size_t i = 0; i < input.length(); i++) {
-        char c = input.charAt(i);
+        char c = input[i];
         switch (c) {
             case '"': output += "\\\""; break;
             case '\\': output += "\\\\"; break;
@@ -203,11 +238,11 @@ String WebService::escapeJSON(const String& input) {
                 } else {
                     // Non-printable or non-ASCII character, escape as \uXXXX
                     char buf[7];
-                    snprintf(buf, sizeof(buf), "\\u%04x", c);
+                    snprintf(buf, sizeof(buf), "\\u%04x", (unsigned char)c);
                     output += buf;
                 }
         }
     }
     
     return output;
-}
\ No newline at end of file
+}
@@ -8,16 +8,16 @@
 #ifndef WEBSERVICE_H
 #define WEBSERVICE_H
 
-#include <Arduino.h>
-#include <WiFi.h>
-#include <WebServer.h>
+#include <string>
+#include "HAL.h"
 #include "WiFiManager.h"
 #include "WiFiConfigPage.h"
 
+class TimeSync;
 
 class WebService {
 public:
-    WebService(WiFiManager* wifiManager);
+    WebService(WiFiManager* wifiManager, int port = 80);
     ~WebService();
     
     // 初始化Web服务器
@@ -29,13 +29,27 @@ public:
     // 检查服务器是否正在运行
     bool isRunning();
 
+    // 监听端口（构造时为0则由系统分配）
+    int port() const { return m_server->port(); }
+
+    // 设置后 /status 附带时间来源和误差估计
+    void setTimeSync(const TimeSync* timeSync) { m_timeSync = timeSync; }
+
+    // JSON 生成（不依赖 HTTP，主机上可直接测试和计时）
+    std::string getScanJSON(int networkCount);
+    std::string getNetworkListJSON();
+    std::string getStatusJSON();
+    // /status 的 "time" 字段，须先 setTimeSync
+    std::string getTimeJSON();
+    static std::string escapeJSON(const std::string& input);
+
 private:  
     
     WiFiManager* m_wifiManager;
-    WebServer* m_server;
+    hal::HttpServer* m_server;
     WiFiConfigPage* m_wifiConfigPage;
+    const TimeSync* m_timeSync = nullptr;
     bool m_running;
-    const int m_port = 80;
     
     // 路由处理函数
     void handleRoot();
@@ -47,16 +61,8 @@ private:
     void handleNotFound();
     
     // 辅助函数
-    String getContentType(const String& path);
-    void sendResponse(int code, const String& type, const String& content);
-    String getNetworkListJSON();
-    String getStatusJSON();
-    String escapeJSON(const String& input);
-    
-    // HTML页面生成
-    String generateHTMLPage();
-    String generateWiFiList();
-    String generateConnectionStatus();
+    std::string getContentType(const std::string& path);
+    void sendResponse(int code, const char* type, const std::string& content);
 };
 
 #endif // WEBSERVICE_H
\ No newline at end of file
@@ -6,6 +6,12 @@
  * GitHub: https://github.com/Tomosawa/WIFI2JJY
  */
 #include "WiFiConfigPage.h"
+#include <string.h>
+
+// ESP32 上 PROGMEM 本就是空宏，主机构建同样按普通常量处理
+#ifndef PROGMEM
+#define PROGMEM
+#endif
 
 // HTML头部模板 - 存储在PROGMEM中
 const char header_html[] PROGMEM = R"(
@@ -929,53 +935,54 @@ const char footer_html[] PROGMEM = R"(
 )";
 
 // 实现函数
-void WiFiConfigPage::sendPage(WiFiClient* client) {
+void WiFiConfigPage::sendPage(hal::HttpServer* server) {
     // 发送HTTP响应头
-    client->println("HTTP/1.1 200 OK");
-    client->println("Content-Type: text/html");
-    client->println("Cache-Control: no-cache, no-store, must-revalidate");
-    client->println("Pragma: no-cache");
-    client->println("Expires: -1");
-    client->println("Connection: close");
-    client->println();
+    static const char responseHeader[] =
+        "HTTP/1.1 200 OK\r\n"
+        "Content-Type: text/html\r\n"
+        "Cache-Control: no-cache, no-store, must-revalidate\r\n"
+        "Pragma: no-cache\r\n"
+        "Expires: -1\r\n"
+        "Connection: close\r\n"
+        "\r\n";
+    server->sendRaw(responseHeader, sizeof(responseHeader) - 1);
     
-    sendHeader(client);
-    sendBody(client);
-    sendFooter(client);
+    sendHeader(server);
+    sendBody(server);
+    sendFooter(server);
 }
 
-void WiFiConfigPage::sendHeader(WiFiClient* client) {
-    sendProgmemString(client, header_html);
-    sendCSS(client);
-    sendProgmemString(client, body_start);
+void WiFiConfigPage::sendHeader(hal::HttpServer* server) {
+    sendProgmemString(server, header_html);
+    sendCSS(server);
+    sendProgmemString(server, body_start);
 }
 
-void WiFiConfigPage::sendBody(WiFiClient* client) {
-    sendJavaScript(client);
+void WiFiConfigPage::sendBody(hal::HttpServer* server) {
+    sendJavaScript(server);
 }
 
-void WiFiConfigPage::sendFooter(WiFiClient* client) {
-    sendProgmemString(client, footer_html);
+void WiFiConfigPage::sendFooter(hal::HttpServer* server) {
+    sendProgmemString(server, footer_html);
 }
 
-void WiFiConfigPage::sendCSS(WiFiClient* client) {
-    sendProgmemString(client, css_style);
+void WiFiConfigPage::sendCSS(hal::HttpServer* server) {
+    sendProgmemString(server, css_style);
 }
 
-void WiFiConfigPage::sendJavaScript(WiFiClient* client) {
-    sendProgmemString(client, javascript_code);
+void WiFiConfigPage::sendJavaScript(hal::HttpServer* server) {
+    sendProgmemString(server, javascript_code);
 }
 
-void WiFiConfigPage::sendProgmemString(WiFiClient* client, const char* progmemStr) {
-    char buffer[256];
-    size_t len = strlen_P(progmemStr);
+void WiFiConfigPage::sendProgmemString(hal::HttpServer* server, const char* progmemStr) {
+    // ESP32 的 PROGMEM 数据可按普通内存直接读取，分块写出
+    static const size_t CHUNK = 1024;
+    size_t len = strlen(progmemStr);
     size_t pos = 0;
     
     while (pos < len) {
-        size_t chunkSize = min(len - pos, sizeof(buffer) - 1);
-        strncpy_P(buffer, progmemStr + pos, chunkSize);
-        buffer[chunkSize] = '\0';
-        client->print(buffer);
+        size_t chunkSize = len - pos < CHUNK ? len - pos : CHUNK;
+        server->sendRaw(progmemStr + pos, chunkSize);
         pos += chunkSize;
     }
-}
\ No newline at end of file
+}
@@ -8,34 +8,31 @@
 #ifndef WIFICONFIGPAGE_H
 #define WIFICONFIGPAGE_H
 
-#include <Arduino.h>
-#include <pgmspace.h>
-#include <WiFi.h>
-#include <WebServer.h>
+#include "HAL.h"
 
 class WiFiConfigPage {
 public:
     // 生成完整的HTML页面
-    static void sendPage(WiFiClient* client);
+    static void sendPage(hal::HttpServer* server);
     
 private:
     // 发送HTML头部
-    static void sendHeader(WiFiClient* client);
+    static void sendHeader(hal::HttpServer* server);
     
     // 发送HTML主体
-    static void sendBody(WiFiClient* client);
+    static void sendBody(hal::HttpServer* server);
     
     // 发送HTML尾部
-    static void sendFooter(WiFiClient* client);
+    static void sendFooter(hal::HttpServer* server);
     
     // 发送CSS样式
-    static void sendCSS(WiFiClient* client);
+    static void sendCSS(hal::HttpServer* server);
     
     // 发送JavaScript代码
-    static void sendJavaScript(WiFiClient* client);
+    static void sendJavaScript(hal::HttpServer* server);
     
     // 辅助函数：从PROGMEM发送字符串
-    static void sendProgmemString(WiFiClient* client, const char* progmemStr);
+    static void sendProgmemString(hal::HttpServer* server, const char* progmemStr);
 };
 
 #endif // WIFICONFIGPAGE_H
\ No newline at end of file
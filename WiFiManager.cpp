@@ -14,209 +14,187 @@ WiFiManager::~WiFiManager() {
 }
 
 void WiFiManager::begin() {
-    m_preferences.begin("wifi-config", false);
+    m_preferences.begin("wifi-config");
     m_connecting = false;
-    Serial.println("[WiFiManager] Initialized");
+    hal::log("[WiFiManager] Initialized\n");
     // 确保在AP_STA模式下
-    WiFi.mode(WIFI_AP_STA);
-    delay(200);
+    hal::netBegin();
+    hal::sleepMs(200);
     // 无论何时都需要启动AP
     startAPMode();
-    delay(100);
+    hal::sleepMs(100);
    
     // 检查是否有保存的WiFi配置，有则连接
     if (hasSavedConfig()) {
-        Serial.println("[WiFiManager] Found saved WiFi configuration");
+        hal::log("[WiFiManager] Found saved WiFi configuration\n");
         connectToSavedNetwork();
     } else {
-        Serial.println("[WiFiManager] No saved WiFi configuration found");
+        hal::log("[WiFiManager] No saved WiFi configuration found\n");
     }
 
      // 开始扫描网络
     startScan();
     // 等待扫描完成
-    while (WiFi.scanComplete() == -1) {
-        delay(100);
+    while (hal::netScanComplete() == -1) {
+        hal::sleepMs(100);
     }
-    Serial.println("[WiFiManager] WIFI Scan complete");
+    hal::log("[WiFiManager] WIFI Scan complete\n");
 }
 
 bool WiFiManager::isConnected() {
-    return WiFi.status() == WL_CONNECTED;
+    return hal::netStatus() == hal::NET_CONNECTED;
 }
 
 bool WiFiManager::connectToSavedNetwork() {
-    String ssid = getSavedSSID();
-    String password = m_preferences.getString(WIFI_PASSWORD_KEY, "");
+    std::string ssid = getSavedSSID();
+    std::string password = m_preferences.getString(WIFI_PASSWORD_KEY, "");
     
     if (ssid.length() == 0) {
-        Serial.println("[WiFiManager] No saved SSID found");
+        hal::log("[WiFiManager] No saved SSID found\n");
         return false;
     }
     
-    Serial.printf("[WiFiManager] Attempting to connect to saved network: %s\n", ssid.c_str());
+    hal::log("[WiFiManager] Attempting to connect to saved network: %s\n", ssid.c_str());
     return connectToNetwork(ssid, password);
 }
 
-bool WiFiManager::connectToNetwork(const String& ssid, const String& password) {
+bool WiFiManager::connectToNetwork(const std::string& ssid, const std::string& password) {
     
-    Serial.printf("[WiFiManager] Connecting to SSID: %s\n", ssid.c_str());
-    WiFi.begin(ssid.c_str(), password.c_str());
+    hal::log("[WiFiManager] Connecting to SSID: %s\n", ssid.c_str());
+    hal::netConnect(ssid.c_str(), password.c_str());
     
     m_connectionAttempts = 0;
-    m_lastConnectionAttempt = millis();
+    m_lastConnectionAttempt = hal::monotonicMs();
     
     // 等待连接
-    while (WiFi.status() != WL_CONNECTED && m_connectionAttempts < MAX_CONNECTION_ATTEMPTS) {
-        delay(500);
+    while (hal::netStatus() != hal::NET_CONNECTED && m_connectionAttempts < MAX_CONNECTION_ATTEMPTS) {
+        hal::sleepMs(500);
         m_connectionAttempts++;
         
         if (m_connectionAttempts % 2 == 0) {
-            Serial.print(".");
+            hal::log(".");
         }
         
         // 检查超时
-        if (millis() - m_lastConnectionAttempt > CONNECTION_TIMEOUT) {
-            Serial.println("\n[WiFiManager] Connection timeout");
+        if (hal::monotonicMs() - m_lastConnectionAttempt > CONNECTION_TIMEOUT) {
+            hal::log("\n[WiFiManager] Connection timeout\n");
             return false;
         }
     }
     
-    if (WiFi.status() == WL_CONNECTED) {
-        Serial.println("\n[WiFiManager] Connected successfully!");
-        Serial.printf("[WiFiManager] IP address: %s\n", WiFi.localIP().toString().c_str());
+    if (hal::netStatus() == hal::NET_CONNECTED) {
+        hal::log("\n[WiFiManager] Connected successfully!\n");
+        hal::log("[WiFiManager] IP address: %s\n", hal::netLocalIP().c_str());
         
         // 保存成功连接的配置
         saveWiFiConfig(ssid, password);
         return true;
     } else {
-        Serial.println("\n[WiFiManager] Failed to connect");
+        hal::log("\n[WiFiManager] Failed to connect\n");
         return false;
     }
 }
 
 void WiFiManager::startAPMode() {
-    Serial.printf("[WiFiManager] Starting AP mode with SSID: %s\n", m_apSSID);
-    WiFi.softAPConfig(IPAddress(192, 168, 1, 1), IPAddress(192, 168, 1, 1), IPAddress(255, 255, 255, 0));
-    WiFi.softAP(m_apSSID, m_apPassword);
+    hal::log("[WiFiManager] Starting AP mode with SSID: %s\n", m_apSSID);
+    hal::netStartAccessPoint(m_apSSID, m_apPassword);
     
-    IPAddress apIP = WiFi.softAPIP();
-    Serial.printf("[WiFiManager] AP started, IP address: %s\n", apIP.toString().c_str());
+    hal::log("[WiFiManager] AP started, IP address: %s\n", hal::netAccessPointIP().c_str());
     
     m_apMode = true;
 }
 
-String WiFiManager::getLocalIP() {
-    if (isConnected()) {
-        // 只有在真正连接到WiFi网络时才返回IP地址
-        IPAddress ip = WiFi.localIP();
-        if (ip != IPAddress(0, 0, 0, 0)) {
-            return ip.toString();
-        }
-    }
-    // 未连接或IP地址无效时返回空字符串
-    return "";
+std::string WiFiManager::getLocalIP() {
+    // 只有在真正连接到WiFi网络时才返回IP地址，未连接或IP地址无效时返回空字符串
+    return hal::netLocalIP();
 }
 
 bool WiFiManager::saveWiFiConfig() {
     return saveWiFiConfig(m_targetSSID, m_targetPassword);
 }
 
-bool WiFiManager::saveWiFiConfig(const String& ssid, const String& password) {
+bool WiFiManager::saveWiFiConfig(const std::string& ssid, const std::string& password) {
     m_preferences.putString(WIFI_SSID_KEY, ssid);
     m_preferences.putString(WIFI_PASSWORD_KEY, password);
     
-    Serial.printf("[WiFiManager] WiFi configuration saved: %s\n", ssid.c_str());
+    hal::log("[WiFiManager] WiFi configuration saved: %s\n", ssid.c_str());
     return true;
 }
 
 void WiFiManager::clearWiFiConfig() {
     m_preferences.remove(WIFI_SSID_KEY);
     m_preferences.remove(WIFI_PASSWORD_KEY);
-    Serial.println("[WiFiManager] WiFi configuration cleared");
+    hal::log("[WiFiManager] WiFi configuration cleared\n");
 }
 
-String WiFiManager::getSavedSSID() {
+std::string WiFiManager::getSavedSSID() {
     return m_preferences.getString(WIFI_SSID_KEY, "");
 }
 
-String WiFiManager::getSavedPassword() {
+std::string WiFiManager::getSavedPassword() {
     return m_preferences.getString(WIFI_PASSWORD_KEY, "");
 }
 
 bool WiFiManager::hasSavedConfig() {
-    String ssid = getSavedSSID();
+    std::string ssid = getSavedSSID();
     return ssid.length() > 0;
 }
 
 void WiFiManager::startScan() {
-    WiFi.scanNetworks(true, true); // 开始异步扫描
-    Serial.println("[WiFiManager] Starting WiFi scan...");
+    hal::netStartScan(); // 开始异步扫描
+    hal::log("[WiFiManager] Starting WiFi scan...\n");
 }
 
 int WiFiManager::getScannedNetwork() {
-    int8_t scanStatus = WiFi.scanComplete();
+    int scanStatus = hal::netScanComplete();
     if (scanStatus >= 0) {
         // 扫描完成
         m_scanResultCount = scanStatus;
-        Serial.printf("[WiFiManager] Scan completed, found %d networks\n", m_scanResultCount);
+        hal::log("[WiFiManager] Scan completed, found %d networks\n", m_scanResultCount);
     } else if (scanStatus == -1) {
         // 扫描仍在进行中
-        Serial.println("[WiFiManager] Scanning...");
+        hal::log("[WiFiManager] Scanning...\n");
         m_scanResultCount = 0;
     }
     return scanStatus;
 }
 
 
-String WiFiManager::getScannedSSID(int index) const {
-    if (index >= 0 && index < m_scanResultCount) {
-        return WiFi.SSID(index);
+std::string WiFiManager::getScannedSSID(int index) const {
+    hal::ScanEntry entry;
+    if (index >= 0 && index < m_scanResultCount && hal::netScanEntry(index, entry)) {
+        return entry.ssid;
     }
     return "";
 }
 
 int WiFiManager::getScannedRSSI(int index) const {
-    if (index >= 0 && index < m_scanResultCount) {
-        return WiFi.RSSI(index);
+    hal::ScanEntry entry;
+    if (index >= 0 && index < m_scanResultCount && hal::netScanEntry(index, entry)) {
+        return entry.rssi;
     }
     return 0;
 }
 
-String WiFiManager::getScannedEncryptionType(int index) const {
-    switch (WiFi.encryptionType(index)) {
-        case WIFI_AUTH_OPEN:
-            return "Open";
-        case WIFI_AUTH_WEP:
-            return "WEP";
-        case WIFI_AUTH_WPA_PSK:
-            return "WPA";
-        case WIFI_AUTH_WPA2_PSK:
-            return "WPA2";
-        case WIFI_AUTH_WPA_WPA2_PSK:
-            return "WPA/WPA2";
-        case WIFI_AUTH_WPA2_ENTERPRISE:
-            return "WPA2 Enterprise";
-        case WIFI_AUTH_WPA3_PSK:
-            return "WPA3";
-        case WIFI_AUTH_WPA2_WPA3_PSK:
-            return "WPA2/WPA3";
-        default:
-            return "Unknown";
+std::string WiFiManager::getScannedEncryptionType(int index) const {
+    hal::ScanEntry entry;
+    if (hal::netScanEntry(index, entry)) {
+        return entry.encryption;
     }
+    return "Unknown";
 }
 
 void WiFiManager::handleConnection() {
     // 优先处理正在进行的异步连接
     if (m_connecting) {
-        wl_status_t st = WiFi.status();
-        if (st == WL_CONNECTED) {
+        hal::NetStatus st = hal::netStatus();
+        if (st == hal::NET_CONNECTED) {
             m_connecting = false;
-            Serial.println("[WiFiManager] Async connected!");
+            hal::log("[WiFiManager] Async connected!\n");
             saveWiFiConfig(m_targetSSID, m_targetPassword);
-        } else if (millis() - m_connectStartTime > CONNECTION_TIMEOUT) {
+        } else if (hal::monotonicMs() - m_connectStartTime > CONNECTION_TIMEOUT) {
             m_connecting = false;
-            Serial.println("[WiFiManager] Async connect timeout");
+            hal::log("[WiFiManager] Async connect timeout\n");
         }
         return;
     }
@@ -227,21 +205,21 @@ void WiFiManager::handleConnection() {
     }
 }
 
-String WiFiManager::getConnectionStatus() {
-    switch (WiFi.status()) {
-        case WL_IDLE_STATUS:
+std::string WiFiManager::getConnectionStatus() {
+    switch (hal::netStatus()) {
+        case hal::NET_IDLE:
             return "Idle";
-        case WL_NO_SSID_AVAIL:
+        case hal::NET_NO_SSID_AVAIL:
             return "No SSID Available";
-        case WL_SCAN_COMPLETED:
+        case hal::NET_SCAN_COMPLETED:
             return "Scan Completed";
-        case WL_CONNECTED:
+        case hal::NET_CONNECTED:
             return "Connected";
-        case WL_CONNECT_FAILED:
+        case hal::NET_CONNECT_FAILED:
             return "Connection Failed";
-        case WL_CONNECTION_LOST:
+        case hal::NET_CONNECTION_LOST:
             return "Connection Lost";
-        case WL_DISCONNECTED:
+        case hal::NET_DISCONNECTED:
             return "Disconnected";
         default:
             return "Unknown";
@@ -249,24 +227,24 @@ String WiFiManager::getConnectionStatus() {
 }
 
 
-bool WiFiManager::attemptConnection(const String& ssid, const String& password) {
-    WiFi.begin(ssid.c_str(), password.c_str());
+bool WiFiManager::attemptConnection(const std::string& ssid, const std::string& password) {
+    hal::netConnect(ssid.c_str(), password.c_str());
     
     int attempts = 0;
-    while (WiFi.status() != WL_CONNECTED && attempts < 20) {
-        delay(500);
+    while (hal::netStatus() != hal::NET_CONNECTED && attempts < 20) {
+        hal::sleepMs(500);
         attempts++;
     }
     
-    return WiFi.status() == WL_CONNECTED;
+    return hal::netStatus() == hal::NET_CONNECTED;
 }
 
-void WiFiManager::startAsyncConnect(const String& ssid, const String& password) {
+void WiFiManager::startAsyncConnect(const std::string& ssid, const std::string& password) {
     m_targetSSID = ssid;
     m_targetPassword = password;
-    m_connectStartTime = millis();
+    m_connectStartTime = hal::monotonicMs();
     m_lastConnectionAttempt = m_connectStartTime;
     m_connecting = true;
-    Serial.printf("[WiFiManager] Async connect start: %s\n", ssid.c_str());
-    WiFi.begin(ssid.c_str(), password.c_str());
+    hal::log("[WiFiManager] Async connect start: %s\n", ssid.c_str());
+    hal::netConnect(ssid.c_str(), password.c_str());
 }
\ No newline at end of file
@@ -8,9 +8,8 @@
 #ifndef WIFIMANAGER_H
 #define WIFIMANAGER_H
 
-#include <Arduino.h>
-#include <WiFi.h>
-#include <Preferences.h>
+#include <string>
+#include "HAL.h"
 
 class WiFiManager {
 public:
@@ -27,25 +26,25 @@ public:
     bool connectToSavedNetwork();
     
     // 连接到指定的WiFi网络
-    bool connectToNetwork(const String& ssid, const String& password);
+    bool connectToNetwork(const std::string& ssid, const std::string& password);
     
     // 启动AP模式
     void startAPMode();
     
     // 获取本地IP地址
-    String getLocalIP();
+    std::string getLocalIP();
     
     // 保存WiFi配置
-    bool saveWiFiConfig(const String& ssid, const String& password);
+    bool saveWiFiConfig(const std::string& ssid, const std::string& password);
     bool saveWiFiConfig();
     
     // 清除保存的WiFi配置
     void clearWiFiConfig();
     
     // 获取已保存的SSID
-    String getSavedSSID();
+    std::string getSavedSSID();
     // 获取已保存的密码
-    String getSavedPassword();
+    std::string getSavedPassword();
     
     // 检查是否有保存的WiFi配置
     bool hasSavedConfig();
@@ -57,28 +56,28 @@ public:
     int getScannedNetwork();
     
     // 获取扫描到的网络SSID
-    String getScannedSSID(int index) const;
+    std::string getScannedSSID(int index) const;
     
     // 获取扫描到的网络信号强度
     int getScannedRSSI(int index) const;
     
     // 获取扫描到的网络加密类型
-    String getScannedEncryptionType(int index) const;
+    std::string getScannedEncryptionType(int index) const;
     
     // 处理WiFi连接状态
     void handleConnection();
     
     // 获取连接状态描述
-    String getConnectionStatus();
+    std::string getConnectionStatus();
     
     // 检查是否处于AP模式
     bool isAPMode() const { return m_apMode; }
     
     // 异步发起连接（不阻塞API）
-    void startAsyncConnect(const String& ssid, const String& password);
+    void startAsyncConnect(const std::string& ssid, const std::string& password);
 
 private:
-    Preferences m_preferences;
+    hal::Nvs m_preferences;
     bool m_apMode;
     bool m_stationMode;
     bool m_connecting;
@@ -97,11 +96,11 @@ private:
     const char* WIFI_PASSWORD_KEY = "wifi_password";
     
     // 内部方法
-    bool attemptConnection(const String& ssid, const String& password);
+    bool attemptConnection(const std::string& ssid, const std::string& password);
     
     // 异步连接状态
-    String m_targetSSID;
-    String m_targetPassword;
+    std::string m_targetSSID;
+    std::string m_targetPassword;
     unsigned long m_connectStartTime = 0;
 };
 
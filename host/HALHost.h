@@ -0,0 +1,38 @@
+/*
+ * Copyright (c) 2025 Tomosawa
+ * All rights reserved.
+ *
+ * This code is part of the WiFi2JJY project.
+ * GitHub: https://github.com/Tomosawa/WIFI2JJY
+ */
+#ifndef HALHOST_H
+#define HALHOST_H
+
+#include <vector>
+#include "../HAL.h"
+
+// 主机实现的附加接口：测试和基准程序用来设定输入引脚、网络状态和扫描结果，
+// 并读回输出引脚。固件中没有对应实现。
+namespace hal {
+namespace host {
+
+// 设置输入引脚电平（例如模拟 PON），电平变化时调用 pinCapture 注册的回调
+void setPinLevel(int pin, bool level);
+// 输出引脚的当前电平及被写入的次数
+bool pinLevel(int pin);
+uint32_t pinWrites(int pin);
+
+// 设置 STA 状态与 IP；netConnect 之后的状态由 connectResult 决定（默认连接成功）
+void setNetStatus(NetStatus status, const char* localIP = "127.0.0.1");
+void setConnectResult(NetStatus status);
+
+// 下一次扫描返回的网络列表
+void setScanResults(const std::vector<ScanEntry>& entries);
+
+// NVS 文件所在目录（默认取环境变量 WIFI2JJY_NVS_DIR，未设置时为 ./nvs）
+void setNvsDirectory(const char* directory);
+
+}  // namespace host
+}  // namespace hal
+
+#endif // HALHOST_H
@@ -0,0 +1,800 @@
+/*
+ * Copyright (c) 2025 Tomosawa
+ * All rights reserved.
+ *
+ * This code is part of the WiFi2JJY project.
+ * GitHub: https://github.com/Tomosawa/WIFI2JJY
+ */
+#include "HALHost.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <thread>
+
+// Linux 实现：GPIO 和无线为内存中的模拟，时钟、定时器、NVS 和 HTTP 使用真实的
+// POSIX 设施，固件逻辑可在工作站上运行、测试和计时
+namespace hal {
+
+static std::mutex s_logMutex;
+
+void log(const char* format, ...) {
+    std::lock_guard<std::mutex> lock(s_logMutex);
+    va_list args;
+    va_start(args, format);
+    vprintf(format, args);
+    va_end(args);
+    fflush(stdout);
+}
+
+void logWrite(const char* data, size_t length) {
+    std::lock_guard<std::mutex> lock(s_logMutex);
+    fwrite(data, 1, length, stdout);
+    fflush(stdout);
+}
+
+// ---- GPIO ----
+
+struct PinState {
+    bool level = false;
+    uint32_t writes = 0;
+    PinEdgeHandler capture = nullptr;
+    void* captureArg = nullptr;
+};
+
+static std::mutex s_pinMutex;
+static std::map<int, PinState> s_pins;
+
+void pinOutput(int pin, bool level) {
+    pinWrite(pin, level);
+}
+
+void pinInput(int pin) {
+    std::lock_guard<std::mutex> lock(s_pinMutex);
+    s_pins[pin];
+}
+
+void pinWrite(int pin, bool level) {
+    std::lock_guard<std::mutex> lock(s_pinMutex);
+    PinState& state = s_pins[pin];
+    state.level = level;
+    state.writes++;
+}
+
+bool pinRead(int pin) {
+    std::lock_guard<std::mutex> lock(s_pinMutex);
+    return s_pins[pin].level;
+}
+
+bool pinCapture(int pin, PinEdgeHandler handler, void* arg) {
+    std::lock_guard<std::mutex> lock(s_pinMutex);
+    PinState& state = s_pins[pin];
+    state.capture = handler;
+    state.captureArg = arg;
+    return true;
+}
+
+// ---- 时钟 ----
+
+int64_t monotonicUs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000LL + ts.tv_nsec / 1000;
+}
+
+uint32_t monotonicMs() {
+    return (uint32_t)(monotonicUs() / 1000);
+}
+
+void sleepMs(uint32_t ms) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+void waitUntilUs(int64_t targetUs) {
+    struct timespec ts;
+    ts.tv_sec = targetUs / 1000000;
+    ts.tv_nsec = (targetUs % 1000000) * 1000;
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR) {
+    }
+}
+
+void yield() {
+    std::this_thread::yield();
+}
+
+// 不改动主机的系统时钟，只在进程内叠加一个偏移
+static std::atomic<int64_t> s_wallAdjustUs(0);
+
+static int64_t realtimeUs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (int64_t)ts.tv_sec * 1000000LL + ts.tv_nsec / 1000;
+}
+
+int64_t wallTimeUs() {
+    return realtimeUs() + s_wallAdjustUs.load();
+}
+
+void setWallTimeUs(int64_t wallUs) {
+    s_wallAdjustUs.store(wallUs - realtimeUs());
+}
+
+void slewWallTime(int64_t deltaUs) {
+    // 主机上直接生效，不模拟渐进过程
+    s_wallAdjustUs.fetch_add(deltaUs);
+}
+
+void setUtcOffset(long utcOffset) {
+    // POSIX TZ 的符号与 UTC 偏移相反：东8区写作 UTC-8
+    char tz[24];
+    long magnitude = utcOffset < 0 ? -utcOffset : utcOffset;
+    snprintf(tz, sizeof(tz), "UTC%c%ld:%02ld", utcOffset > 0 ? '-' : '+', magnitude / 3600,
+             (magnitude % 3600) / 60);
+    setenv("TZ", tz, 1);
+    tzset();
+}
+
+// ---- 任务 ----
+
+bool startTask(void (*fn)(void*), const char* name, uint32_t stackBytes, void* arg, int priority) {
+    (void)name;
+    (void)stackBytes;
+    (void)priority;
+    std::thread(fn, arg).detach();
+    return true;
+}
+
+// ---- 同步 ----
+
+struct Semaphore::Impl {
+    std::mutex mutex;
+    std::condition_variable available;
+    uint32_t count;
+    uint32_t maxCount;
+};
+
+Semaphore::Semaphore(uint32_t maxCount, uint32_t initialCount) : m_impl(new Impl) {
+    m_impl->count = initialCount;
+    m_impl->maxCount = maxCount;
+}
+
+Semaphore::~Semaphore() {
+    delete m_impl;
+}
+
+void Semaphore::give() {
+    {
+        std::lock_guard<std::mutex> lock(m_impl->mutex);
+        if (m_impl->count >= m_impl->maxCount) {
+            return;
+        }
+        m_impl->count++;
+    }
+    m_impl->available.notify_one();
+}
+
+void Semaphore::giveFromIsr() {
+    give();
+}
+
+bool Semaphore::take(uint32_t timeoutMs) {
+    std::unique_lock<std::mutex> lock(m_impl->mutex);
+    auto ready = [this]() { return m_impl->count > 0; };
+    if (timeoutMs == WAIT_FOREVER) {
+        m_impl->available.wait(lock, ready);
+    } else if (!m_impl->available.wait_for(lock, std::chrono::milliseconds(timeoutMs), ready)) {
+        return false;
+    }
+    m_impl->count--;
+    return true;
+}
+
+// ---- 定时器 ----
+
+struct OneShotTimer::Impl {
+    Callback callback;
+    void* arg;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::thread thread;
+    bool cancelled = false;
+
+    void join() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            cancelled = true;
+        }
+        wake.notify_all();
+        if (thread.joinable()) {
+            // 回调里停止自身时不能等待自己
+            if (thread.get_id() == std::this_thread::get_id()) {
+                thread.detach();
+            } else {
+                thread.join();
+            }
+        }
+    }
+};
+
+OneShotTimer::OneShotTimer(Callback callback, void* arg, const char* name) : m_impl(new Impl) {
+    (void)name;
+    m_impl->callback = callback;
+    m_impl->arg = arg;
+}
+
+OneShotTimer::~OneShotTimer() {
+    m_impl->join();
+    delete m_impl;
+}
+
+bool OneShotTimer::start(int64_t delayUs) {
+    m_impl->join();
+    m_impl->cancelled = false;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::microseconds(delayUs);
+    Impl* impl = m_impl;
+    impl->thread = std::thread([impl, deadline]() {
+        std::unique_lock<std::mutex> lock(impl->mutex);
+        if (impl->wake.wait_until(lock, deadline, [impl]() { return impl->cancelled; })) {
+            return;
+        }
+        lock.unlock();
+        impl->callback(impl->arg);
+    });
+    return true;
+}
+
+void OneShotTimer::stop() {
+    m_impl->join();
+}
+
+struct Event::Impl {
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool signalled = false;
+};
+
+Event::Event() : m_impl(new Impl) {
+}
+
+Event::~Event() {
+    delete m_impl;
+}
+
+void Event::signal() {
+    {
+        std::lock_guard<std::mutex> lock(m_impl->mutex);
+        m_impl->signalled = true;
+    }
+    m_impl->wake.notify_one();
+}
+
+bool Event::wait(uint32_t timeoutMs) {
+    std::unique_lock<std::mutex> lock(m_impl->mutex);
+    bool signalled = m_impl->wake.wait_for(lock, std::chrono::milliseconds(timeoutMs),
+                                           [this]() { return m_impl->signalled; });
+    m_impl->signalled = false;
+    return signalled;
+}
+
+// ---- NVS ----
+
+static std::string s_nvsDirectory;
+
+static std::string nvsDirectory() {
+    if (s_nvsDirectory.empty()) {
+        const char* env = getenv("WIFI2JJY_NVS_DIR");
+        s_nvsDirectory = env != nullptr ? env : "nvs";
+    }
+    return s_nvsDirectory;
+}
+
+struct Nvs::Impl {
+    std::string directory;
+
+    std::string pathOf(const char* key) const {
+        return directory + "/" + key;
+    }
+};
+
+Nvs::Nvs() : m_impl(new Impl) {
+}
+
+Nvs::~Nvs() {
+    delete m_impl;
+}
+
+bool Nvs::begin(const char* nameSpace) {
+    std::string root = nvsDirectory();
+    mkdir(root.c_str(), 0755);
+    m_impl->directory = root + "/" + nameSpace;
+    return mkdir(m_impl->directory.c_str(), 0755) == 0 || errno == EEXIST;
+}
+
+std::string Nvs::getString(const char* key, const char* defaultValue) {
+    FILE* file = fopen(m_impl->pathOf(key).c_str(), "rb");
+    if (file == nullptr) {
+        return defaultValue;
+    }
+    std::string value;
+    char buffer[256];
+    size_t length;
+    while ((length = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        value.append(buffer, length);
+    }
+    fclose(file);
+    return value;
+}
+
+bool Nvs::putString(const char* key, const std::string& value) {
+    FILE* file = fopen(m_impl->pathOf(key).c_str(), "wb");
+    if (file == nullptr) {
+        return false;
+    }
+    bool ok = fwrite(value.data(), 1, value.size(), file) == value.size();
+    return fclose(file) == 0 && ok;
+}
+
+bool Nvs::remove(const char* key) {
+    return unlink(m_impl->pathOf(key).c_str()) == 0;
+}
+
+// ---- 网络 ----
+
+struct NetState {
+    NetStatus status = NET_CONNECTED;  // 主机默认已联网
+    NetStatus connectResult = NET_CONNECTED;
+    std::string localIP = "127.0.0.1";
+    std::vector<ScanEntry> pendingScan;
+    std::vector<ScanEntry> scan;
+    bool scanned = false;
+};
+
+static std::mutex s_netMutex;
+static NetState s_net;
+
+void netBegin() {
+}
+
+void netStartAccessPoint(const char* ssid, const char* password) {
+    (void)ssid;
+    (void)password;
+}
+
+std::string netAccessPointIP() {
+    return "192.168.1.1";
+}
+
+void netConnect(const char* ssid, const char* password) {
+    (void)ssid;
+    (void)password;
+    std::lock_guard<std::mutex> lock(s_netMutex);
+    s_net.status = s_net.connectResult;
+}
+
+NetStatus netStatus() {
+    std::lock_guard<std::mutex> lock(s_netMutex);
+    return s_net.status;
+}
+
+std::string netLocalIP() {
+    std::lock_guard<std::mutex> lock(s_netMutex);
+    return s_net.status == NET_CONNECTED ? s_net.localIP : "";
+}
+
+void netStartScan() {
+    std::lock_guard<std::mutex> lock(s_netMutex);
+    s_net.scan = s_net.pendingScan;
+    s_net.scanned = true;
+}
+
+int netScanComplete() {
+    std::lock_guard<std::mutex> lock(s_netMutex);
+    return s_net.scanned ? (int)s_net.scan.size() : -2;
+}
+
+bool netScanEntry(int index, ScanEntry& entry) {
+    std::lock_guard<std::mutex> lock(s_netMutex);
+    if (index < 0 || index >= (int)s_net.scan.size()) {
+        return false;
+    }
+    entry = s_net.scan[index];
+    return true;
+}
+
+void netShutdown() {
+    std::lock_guard<std::mutex> lock(s_netMutex);
+    s_net.status = NET_DISCONNECTED;
+    s_net.scan.clear();
+    s_net.scanned = false;
+}
+
+bool netResolve(const char* host, uint32_t& address) {
+    struct addrinfo hints = {};
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_DGRAM;
+    struct addrinfo* result = nullptr;
+    if (getaddrinfo(host, nullptr, &hints, &result) != 0 || result == nullptr) {
+        return false;
+    }
+    address = ntohl(((struct sockaddr_in*)result->ai_addr)->sin_addr.s_addr);
+    freeaddrinfo(result);
+    return true;
+}
+
+// ---- UDP ----
+
+struct UdpSocket::Impl {
+    int fd = -1;
+};
+
+UdpSocket::UdpSocket() : m_impl(new Impl) {
+}
+
+UdpSocket::~UdpSocket() {
+    if (m_impl->fd >= 0) {
+        close(m_impl->fd);
+    }
+    delete m_impl;
+}
+
+bool UdpSocket::open() {
+    if (m_impl->fd < 0) {
+        m_impl->fd = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    }
+    return m_impl->fd >= 0;
+}
+
+bool UdpSocket::sendTo(uint32_t address, uint16_t port, const void* data, size_t length) {
+    struct sockaddr_in to = {};
+    to.sin_family = AF_INET;
+    to.sin_port = htons(port);
+    to.sin_addr.s_addr = htonl(address);
+    return sendto(m_impl->fd, data, length, 0, (struct sockaddr*)&to, sizeof(to)) == (ssize_t)length;
+}
+
+int UdpSocket::receive(void* buffer, size_t size, uint32_t timeoutMs, int64_t& monoUs, uint32_t& from) {
+    fd_set readable;
+    FD_ZERO(&readable);
+    FD_SET(m_impl->fd, &readable);
+    struct timeval timeout;
+    timeout.tv_sec = timeoutMs / 1000;
+    timeout.tv_usec = (timeoutMs % 1000) * 1000;
+    if (select(m_impl->fd + 1, &readable, nullptr, nullptr, &timeout) <= 0) {
+        return -1;
+    }
+    monoUs = monotonicUs();
+    struct sockaddr_in source = {};
+    socklen_t sourceLength = sizeof(source);
+    ssize_t length = recvfrom(m_impl->fd, buffer, size, 0, (struct sockaddr*)&source, &sourceLength);
+    from = ntohl(source.sin_addr.s_addr);
+    return (int)length;
+}
+
+// ---- HTTP 服务 ----
+
+struct HttpRoute {
+    std::string path;
+    HttpMethod method;
+    HttpServer::Handler handler;
+};
+
+struct HttpServer::Impl {
+    int port;
+    int listenFd = -1;
+    int clientFd = -1;
+    std::vector<HttpRoute> routes;
+    Handler notFound;
+    std::map<std::string, std::string> args;
+    std::string extraHeaders;
+};
+
+HttpServer::HttpServer(int port) : m_impl(new Impl) {
+    m_impl->port = port;
+}
+
+HttpServer::~HttpServer() {
+    stop();
+    delete m_impl;
+}
+
+void HttpServer::on(const char* path, HttpMethod method, Handler handler) {
+    m_impl->routes.push_back({path, method, handler});
+}
+
+void HttpServer::onNotFound(Handler handler) {
+    m_impl->notFound = handler;
+}
+
+void HttpServer::begin() {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) {
+        log("[HttpServer] socket failed: %s\n", strerror(errno));
+        return;
+    }
+    int reuse = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons((uint16_t)m_impl->port);
+    if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0 || listen(fd, 4) != 0) {
+        log("[HttpServer] bind port %d failed: %s\n", m_impl->port, strerror(errno));
+        close(fd);
+        return;
+    }
+    socklen_t length = sizeof(addr);
+    getsockname(fd, (struct sockaddr*)&addr, &length);
+    m_impl->port = ntohs(addr.sin_port);
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    m_impl->listenFd = fd;
+}
+
+void HttpServer::stop() {
+    if (m_impl->listenFd >= 0) {
+        close(m_impl->listenFd);
+        m_impl->listenFd = -1;
+    }
+}
+
+int HttpServer::port() const {
+    return m_impl->port;
+}
+
+static int hexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+static std::string urlDecode(const std::string& text) {
+    std::string out;
+    for (size_t i = 0; i < text.size(); i++) {
+        if (text[i] == '+') {
+            out += ' ';
+        } else if (text[i] == '%' && i + 2 < text.size() && hexValue(text[i + 1]) >= 0 &&
+                   hexValue(text[i + 2]) >= 0) {
+            out += (char)(hexValue(text[i + 1]) * 16 + hexValue(text[i + 2]));
+            i += 2;
+        } else {
+            out += text[i];
+        }
+    }
+    return out;
+}
+
+static void parseArgs(const std::string& text, std::map<std::string, std::string>& args) {
+    size_t pos = 0;
+    while (pos < text.size()) {
+        size_t end = text.find('&', pos);
+        if (end == std::string::npos) {
+            end = text.size();
+        }
+        std::string pair = text.substr(pos, end - pos);
+        size_t equals = pair.find('=');
+        if (equals == std::string::npos) {
+            args[urlDecode(pair)] = "";
+        } else {
+            args[urlDecode(pair.substr(0, equals))] = urlDecode(pair.substr(equals + 1));
+        }
+        pos = end + 1;
+    }
+}
+
+// 读完请求头和 Content-Length 指定的正文
+static bool readRequest(int fd, std::string& head, std::string& body) {
+    std::string data;
+    char buffer[1024];
+    size_t headEnd;
+    while ((headEnd = data.find("\r\n\r\n")) == std::string::npos) {
+        ssize_t length = recv(fd, buffer, sizeof(buffer), 0);
+        if (length <= 0 || data.size() > 16384) {
+            return false;
+        }
+        data.append(buffer, length);
+    }
+    head = data.substr(0, headEnd);
+    body = data.substr(headEnd + 4);
+
+    size_t contentLength = 0;
+    size_t field = head.find("Content-Length:");
+    if (field == std::string::npos) {
+        field = head.find("content-length:");
+    }
+    if (field != std::string::npos) {
+        contentLength = strtoul(head.c_str() + field + 15, nullptr, 10);
+    }
+    while (body.size() < contentLength) {
+        ssize_t length = recv(fd, buffer, sizeof(buffer), 0);
+        if (length <= 0) {
+            return false;
+        }
+        body.append(buffer, length);
+    }
+    return true;
+}
+
+void HttpServer::handleClient() {
+    if (m_impl->listenFd < 0) {
+        return;
+    }
+    int fd = accept(m_impl->listenFd, nullptr, nullptr);
+    if (fd < 0) {
+        return;
+    }
+    struct timeval timeout = {2, 0};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    std::string head;
+    std::string body;
+    if (readRequest(fd, head, body)) {
+        // 请求行：METHOD /path?query HTTP/1.1
+        size_t methodEnd = head.find(' ');
+        size_t targetEnd = head.find(' ', methodEnd + 1);
+        std::string method = head.substr(0, methodEnd);
+        std::string target = head.substr(methodEnd + 1, targetEnd - methodEnd - 1);
+        std::string path = target;
+        m_impl->args.clear();
+        size_t query = target.find('?');
+        if (query != std::string::npos) {
+            path = target.substr(0, query);
+            parseArgs(target.substr(query + 1), m_impl->args);
+        }
+        if (method == "POST") {
+            parseArgs(body, m_impl->args);
+        }
+
+        m_impl->clientFd = fd;
+        m_impl->extraHeaders.clear();
+        bool handled = false;
+        for (const HttpRoute& route : m_impl->routes) {
+            bool methodMatches = route.method == HTTP_METHOD_ANY ||
+                                 (route.method == HTTP_METHOD_GET && method == "GET") ||
+                                 (route.method == HTTP_METHOD_POST && method == "POST");
+            if (route.path == path && methodMatches) {
+                route.handler();
+                handled = true;
+                break;
+            }
+        }
+        if (!handled) {
+            if (m_impl->notFound) {
+                m_impl->notFound();
+            } else {
+                send(404, "text/plain", "Not Found");
+            }
+        }
+        m_impl->clientFd = -1;
+    }
+    close(fd);
+}
+
+std::string HttpServer::arg(const char* name) {
+    auto it = m_impl->args.find(name);
+    return it == m_impl->args.end() ? "" : it->second;
+}
+
+void HttpServer::sendHeader(const char* name, const char* value) {
+    m_impl->extraHeaders += name;
+    m_impl->extraHeaders += ": ";
+    m_impl->extraHeaders += value;
+    m_impl->extraHeaders += "\r\n";
+}
+
+static const char* reasonPhrase(int code) {
+    switch (code) {
+        case 200: return "OK";
+        case 202: return "Accepted";
+        case 400: return "Bad Request";
+        case 404: return "Not Found";
+        default: return "";
+    }
+}
+
+void HttpServer::send(int code, const char* contentType, const std::string& content) {
+    char status[160];
+    snprintf(status, sizeof(status), "HTTP/1.1 %d %s\r\nContent-Type: %s\r\nContent-Length: %zu\r\n", code,
+             reasonPhrase(code), contentType, content.size());
+    std::string response = status;
+    response += m_impl->extraHeaders;
+    response += "Connection: close\r\n\r\n";
+    response += content;
+    sendRaw(response.data(), response.size());
+}
+
+void HttpServer::sendRaw(const char* data, size_t length) {
+    while (m_impl->clientFd >= 0 && length > 0) {
+        ssize_t written = ::send(m_impl->clientFd, data, length, MSG_NOSIGNAL);
+        if (written <= 0) {
+            return;
+        }
+        data += written;
+        length -= written;
+    }
+}
+
+// ---- 系统 ----
+
+void restart() {
+    log("[HAL] Restart requested, exiting\n");
+    exit(0);
+}
+
+void deepSleep(int wakePin) {
+    log("[HAL] Deep sleep until GPIO%d is low, exiting\n", wakePin);
+    exit(0);
+}
+
+// ---- 主机附加接口 ----
+
+namespace host {
+
+void setPinLevel(int pin, bool level) {
+    PinEdgeHandler capture;
+    void* captureArg;
+    {
+        std::lock_guard<std::mutex> lock(s_pinMutex);
+        PinState& state = s_pins[pin];
+        if (state.level == level) {
+            return;
+        }
+        state.level = level;
+        capture = state.capture;
+        captureArg = state.captureArg;
+    }
+    if (capture != nullptr) {
+        capture(captureArg, level, monotonicUs());
+    }
+}
+
+bool pinLevel(int pin) {
+    std::lock_guard<std::mutex> lock(s_pinMutex);
+    return s_pins[pin].level;
+}
+
+uint32_t pinWrites(int pin) {
+    std::lock_guard<std::mutex> lock(s_pinMutex);
+    return s_pins[pin].writes;
+}
+
+void setNetStatus(NetStatus status, const char* localIP) {
+    std::lock_guard<std::mutex> lock(s_netMutex);
+    s_net.status = status;
+    s_net.localIP = localIP;
+}
+
+void setConnectResult(NetStatus status) {
+    std::lock_guard<std::mutex> lock(s_netMutex);
+    s_net.connectResult = status;
+}
+
+void setScanResults(const std::vector<ScanEntry>& entries) {
+    std::lock_guard<std::mutex> lock(s_netMutex);
+    s_net.pendingScan = entries;
+}
+
+void setNvsDirectory(const char* directory) {
+    s_nvsDirectory = directory;
+}
+
+}  // namespace host
+
+}  // namespace hal
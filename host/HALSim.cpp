@@ -0,0 +1,673 @@
+/*
+ * Copyright (c) 2025 Tomosawa
+ * All rights reserved.
+ *
+ * This code is part of the WiFi2JJY project.
+ * GitHub: https://github.com/Tomosawa/WIFI2JJY
+ */
+#include "SimKernel.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <deque>
+#include <map>
+#include <random>
+#include <vector>
+#include "../SntpClient.h"
+
+// 模拟器的 hal 实现：时钟全部取自虚拟时间，GPIO、无线、DHCP、NTP 和 NVS 是
+// 带时延模型的内存模拟，HTTP 服务不监听端口。
+namespace sim {
+namespace device {
+
+// 一个 UDP 套接字的接收队列
+struct UdpEndpoint {
+    struct Datagram {
+        uint32_t from;
+        std::vector<uint8_t> data;
+    };
+    std::deque<Datagram> queue;
+    hal::Semaphore ready{16, 0};
+};
+
+struct State {
+    NetworkModel model;
+    std::mt19937 random;
+    int64_t trueEpochUs = 0;
+    bool verbose = false;
+    bool lineStart = true;
+
+    // 时钟：设备时钟比虚拟时间快 driftPpb；单调时钟从本次启动算起，挂钟（RTC）跨深度睡眠保持
+    int64_t driftPpb = 0;
+    int64_t bootUs = 0;
+    int64_t wallOffsetUs = 0;  // 设备挂钟 = 设备时钟 + wallOffsetUs
+
+    std::map<int, bool> pins;
+    PinObserver observer;
+    struct Latency {
+        int64_t fallUs;
+        int64_t riseUs;
+    };
+    std::map<int, Latency> outputLatency;
+    int loopbackOut = -1;
+    int loopbackIn = -1;
+    struct Capture {
+        hal::PinEdgeHandler handler;
+        void* arg;
+    };
+    std::map<int, Capture> captures;  // 本次启动注册的边沿捕获，睡眠后丢失
+
+    // 无线
+    bool radioOn = false;
+    int64_t radioOnSinceUs = 0;
+    int64_t radioOnTotalUs = 0;
+    hal::NetStatus status = hal::NET_IDLE;
+    TimerId connectTimer = 0;
+    int64_t linkDropUs = -1;
+    TimerId linkDropTimer = 0;
+    int scanState = -2;
+    TimerId scanTimer = 0;
+    int64_t connectedAtUs = -1;
+
+    // 挂钟调整：adjtime 按经过时间的 1/64 逐渐修正（同 ESP-IDF），在读挂钟时补算
+    int64_t slewTotalUs = 0;
+    int64_t slewAppliedUs = 0;
+    int64_t slewStartUs = 0;
+    int64_t ntpSyncedAtUs = -1;
+    bool ntpReplied = false;  // 本次启动收到过 NTP 应答，之后设置挂钟才算校时
+
+    // UDP：本次启动打开的套接字，应答按编号投递，套接字已关闭则丢弃
+    std::map<int, UdpEndpoint*> sockets;
+    int nextSocketId = 1;
+    std::map<std::string, uint32_t> hosts;
+
+    std::map<std::string, std::string> nvs;
+};
+
+static State s_state;
+
+// netResolve 按主机名首次出现的顺序分配 10.0.0.1、10.0.0.2…
+static const uint32_t FIRST_HOST_ADDRESS = 0x0A000001u;
+
+// 时延加上 ±jitterPercent 的均匀抖动
+static int64_t jitteredUs(uint32_t ms) {
+    int64_t us = (int64_t)ms * 1000;
+    int64_t spread = us * s_state.model.jitterPercent / 100;
+    if (spread == 0) {
+        return us;
+    }
+    std::uniform_int_distribution<int64_t> distribution(-spread, spread);
+    return us + distribution(s_state.random);
+}
+
+static void cancel(TimerId& id) {
+    if (id != 0) {
+        cancelTimer(id);
+        id = 0;
+    }
+}
+
+void reset(const NetworkModel& model, uint32_t seed, int64_t trueEpochUs, bool verbose) {
+    s_state = State();
+    s_state.model = model;
+    s_state.random.seed(seed);
+    s_state.trueEpochUs = trueEpochUs;
+    s_state.verbose = verbose;
+}
+
+void boot() {
+    s_state.bootUs = nowUs();
+    s_state.radioOn = false;
+    s_state.radioOnTotalUs = 0;
+    s_state.status = hal::NET_IDLE;
+    s_state.connectTimer = 0;
+    s_state.linkDropTimer = 0;
+    s_state.scanState = -2;
+    s_state.scanTimer = 0;
+    s_state.connectedAtUs = -1;
+    s_state.ntpSyncedAtUs = -1;
+    s_state.ntpReplied = false;
+    s_state.sockets.clear();
+    s_state.captures.clear();
+}
+
+int64_t trueUtcUs() {
+    return s_state.trueEpochUs + nowUs();
+}
+
+void setClockDrift(int64_t ppb) {
+    s_state.driftPpb = ppb;
+}
+
+void setApAvailable(bool available) {
+    s_state.model.apAvailable = available;
+}
+
+void setLinkDrop(int64_t afterUs) {
+    s_state.linkDropUs = afterUs;
+}
+
+// 虚拟时间 virtualUs 时设备晶振计到的微秒数
+static int64_t deviceUs(int64_t virtualUs) {
+    return virtualUs + virtualUs * s_state.driftPpb / 1000000000LL;
+}
+
+// deviceUs 的反函数：设备时钟到达 targetUs 的最早虚拟时间
+static int64_t virtualAtDeviceUs(int64_t targetUs) {
+    int64_t virtualUs = targetUs - targetUs * s_state.driftPpb / (1000000000LL + s_state.driftPpb);
+    while (deviceUs(virtualUs) < targetUs) {
+        virtualUs++;
+    }
+    while (virtualUs > 0 && deviceUs(virtualUs - 1) >= targetUs) {
+        virtualUs--;
+    }
+    return virtualUs;
+}
+
+// 输入引脚电平变化，捕获回调相当于引脚中断
+static void driveInput(int pin, bool level) {
+    if (s_state.pins[pin] == level) {
+        return;
+    }
+    s_state.pins[pin] = level;
+    auto capture = s_state.captures.find(pin);
+    if (capture != s_state.captures.end()) {
+        capture->second.handler(capture->second.arg, level, hal::monotonicUs());
+    }
+}
+
+void setPinLevel(int pin, bool level) {
+    driveInput(pin, level);
+}
+
+void setPinObserver(PinObserver observer) {
+    s_state.observer = observer;
+}
+
+void setOutputLatency(int pin, int64_t fallUs, int64_t riseUs) {
+    s_state.outputLatency[pin] = {fallUs, riseUs};
+}
+
+void setLoopback(int outPin, int inPin) {
+    s_state.loopbackOut = outPin;
+    s_state.loopbackIn = inPin;
+}
+
+// 引脚电平实际变化：通知观察者，经回环传到输入引脚
+static void pinChanged(int pin, bool level) {
+    if (s_state.observer) {
+        s_state.observer(pin, level);
+    }
+    if (pin == s_state.loopbackOut && s_state.loopbackIn >= 0) {
+        driveInput(s_state.loopbackIn, level);
+    }
+}
+
+void nvsPut(const char* nameSpace, const char* key, const std::string& value) {
+    s_state.nvs[std::string(nameSpace) + "/" + key] = value;
+}
+
+int64_t radioOnUs() {
+    int64_t total = s_state.radioOnTotalUs;
+    if (s_state.radioOn) {
+        total += nowUs() - s_state.radioOnSinceUs;
+    }
+    return total;
+}
+
+int64_t connectedAtUs() {
+    return s_state.connectedAtUs;
+}
+
+int64_t ntpSyncedAtUs() {
+    return s_state.ntpSyncedAtUs;
+}
+
+// 把到现在为止应当完成的渐进调整计入挂钟
+static void applySlew() {
+    if (s_state.slewAppliedUs == s_state.slewTotalUs) {
+        return;
+    }
+    int64_t magnitude = (nowUs() - s_state.slewStartUs) / 64;
+    int64_t target = s_state.slewTotalUs < 0 ? -magnitude : magnitude;
+    if (llabs(target) >= llabs(s_state.slewTotalUs)) {
+        target = s_state.slewTotalUs;
+    }
+    s_state.wallOffsetUs += target - s_state.slewAppliedUs;
+    s_state.slewAppliedUs = target;
+}
+
+static void clockSet() {
+    if (s_state.ntpReplied && s_state.ntpSyncedAtUs < 0) {
+        s_state.ntpSyncedAtUs = nowUs();
+    }
+}
+
+// 模拟的 NTP 服务器：请求经半个往返到达，50us 后发出应答，再经半个往返回到设备
+static void serveNtp(int socketId, uint32_t address, const uint8_t* request) {
+    const bool falseticker = s_state.model.ntpFalsetickerUs != 0 && address == FIRST_HOST_ADDRESS;
+    const uint32_t roundTripMs = falseticker ? s_state.model.ntpRoundTripMs / 2 : s_state.model.ntpRoundTripMs;
+    const int64_t errorUs = s_state.model.ntpErrorUs + (falseticker ? s_state.model.ntpFalsetickerUs : 0);
+    const int64_t arriveUs = nowUs() + jitteredUs(roundTripMs) / 2;
+    uint8_t reply[SntpClient::PACKET_SIZE] = {};
+    reply[0] = (0 << 6) | (4 << 3) | 4;  // LI=0，版本4，服务器
+    reply[1] = 2;
+    reply[2] = request[2];
+    reply[3] = (uint8_t)-20;
+    reply[6] = 0x03;  // 根时延约 15ms（16.16 定点秒）
+    reply[7] = 0xD7;
+    reply[11] = 0x42;  // 根离散度约 1ms
+    memcpy(reply + 24, request + 40, 8);
+    const int64_t receiveUtcUs = s_state.trueEpochUs + arriveUs + errorUs;
+    SntpClient::writeTimestamp(reply + 32, receiveUtcUs);
+    SntpClient::writeTimestamp(reply + 40, receiveUtcUs + 50);
+    SntpClient::writeTimestamp(reply + 16, receiveUtcUs - 64LL * 1000000LL);
+    const int64_t deliverUs = arriveUs + 50 + jitteredUs(roundTripMs) / 2;
+    std::vector<uint8_t> datagram(reply, reply + sizeof(reply));
+    scheduleAt(deliverUs, [socketId, address, datagram]() {
+        auto socket = s_state.sockets.find(socketId);
+        if (socket != s_state.sockets.end() && s_state.status == hal::NET_CONNECTED) {
+            s_state.ntpReplied = true;
+            socket->second->queue.push_back({address, datagram});
+            socket->second->ready.give();
+        }
+    });
+}
+
+}  // namespace device
+}  // namespace sim
+
+namespace hal {
+
+using sim::device::s_state;
+
+void log(const char* format, ...) {
+    if (!s_state.verbose) {
+        return;
+    }
+    char buffer[512];
+    va_list args;
+    va_start(args, format);
+    int length = vsnprintf(buffer, sizeof(buffer), format, args);
+    va_end(args);
+    if (length < 0) {
+        return;
+    }
+    if ((size_t)length >= sizeof(buffer)) {
+        length = sizeof(buffer) - 1;
+    }
+    // 每行前面加上虚拟时间（秒）
+    for (int i = 0; i < length; i++) {
+        if (s_state.lineStart) {
+            printf("[%11.6f] ", sim::nowUs() / 1e6);
+            s_state.lineStart = false;
+        }
+        putchar(buffer[i]);
+        if (buffer[i] == '\n') {
+            s_state.lineStart = true;
+        }
+    }
+}
+
+void logWrite(const char* data, size_t length) {
+    if (s_state.verbose) {
+        fwrite(data, 1, length, stdout);
+    }
+}
+
+// ---- GPIO ----
+
+void pinOutput(int pin, bool level) {
+    pinWrite(pin, level);
+}
+
+void pinInput(int pin) {
+    s_state.pins[pin];
+}
+
+void pinWrite(int pin, bool level) {
+    s_state.pins[pin] = level;
+    auto latency = s_state.outputLatency.find(pin);
+    int64_t delayUs = 0;
+    if (latency != s_state.outputLatency.end()) {
+        delayUs = level ? latency->second.riseUs : latency->second.fallUs;
+    }
+    if (delayUs > 0) {
+        sim::scheduleAt(sim::nowUs() + delayUs, [pin, level]() { sim::device::pinChanged(pin, level); });
+    } else {
+        sim::device::pinChanged(pin, level);
+    }
+}
+
+bool pinRead(int pin) {
+    return s_state.pins[pin];
+}
+
+bool pinCapture(int pin, PinEdgeHandler handler, void* arg) {
+    if (handler == nullptr) {
+        s_state.captures.erase(pin);
+    } else {
+        s_state.captures[pin] = {handler, arg};
+    }
+    return true;
+}
+
+// ---- 时钟 ----
+
+int64_t monotonicUs() {
+    return sim::device::deviceUs(sim::nowUs()) - sim::device::deviceUs(s_state.bootUs);
+}
+
+uint32_t monotonicMs() {
+    return (uint32_t)(monotonicUs() / 1000);
+}
+
+void sleepMs(uint32_t ms) {
+    sim::block(sim::nowUs() + (int64_t)ms * 1000);
+}
+
+void waitUntilUs(int64_t targetUs) {
+    int64_t atUs = sim::device::virtualAtDeviceUs(targetUs + sim::device::deviceUs(s_state.bootUs));
+    if (atUs > sim::nowUs()) {
+        sim::block(atUs);
+    }
+}
+
+void yield() {
+    // 让虚拟时间前进一点，自旋等待才能结束
+    sim::block(sim::nowUs() + 1);
+}
+
+int64_t wallTimeUs() {
+    sim::device::applySlew();
+    return sim::device::deviceUs(sim::nowUs()) + s_state.wallOffsetUs;
+}
+
+void setWallTimeUs(int64_t wallUs) {
+    // 同 ESP-IDF：设置时间会取消进行中的渐进调整
+    s_state.wallOffsetUs = wallUs - sim::device::deviceUs(sim::nowUs());
+    s_state.slewTotalUs = 0;
+    s_state.slewAppliedUs = 0;
+    sim::device::clockSet();
+}
+
+void slewWallTime(int64_t deltaUs) {
+    sim::device::applySlew();
+    s_state.slewTotalUs = s_state.slewTotalUs - s_state.slewAppliedUs + deltaUs;
+    s_state.slewAppliedUs = 0;
+    s_state.slewStartUs = sim::nowUs();
+    sim::device::clockSet();
+}
+
+void setUtcOffset(long utcOffset) {
+    // POSIX TZ 的符号与 UTC 偏移相反：东8区写作 UTC-8
+    char tz[24];
+    long magnitude = utcOffset < 0 ? -utcOffset : utcOffset;
+    snprintf(tz, sizeof(tz), "UTC%c%ld:%02ld", utcOffset > 0 ? '-' : '+', magnitude / 3600,
+             (magnitude % 3600) / 60);
+    setenv("TZ", tz, 1);
+    tzset();
+}
+
+// ---- NVS ----
+
+struct Nvs::Impl {
+    std::string nameSpace;
+
+    std::string keyOf(const char* key) const {
+        return nameSpace + "/" + key;
+    }
+};
+
+Nvs::Nvs() : m_impl(new Impl) {
+}
+
+Nvs::~Nvs() {
+    delete m_impl;
+}
+
+bool Nvs::begin(const char* nameSpace) {
+    m_impl->nameSpace = nameSpace;
+    return true;
+}
+
+std::string Nvs::getString(const char* key, const char* defaultValue) {
+    auto it = s_state.nvs.find(m_impl->keyOf(key));
+    return it != s_state.nvs.end() ? it->second : defaultValue;
+}
+
+bool Nvs::putString(const char* key, const std::string& value) {
+    s_state.nvs[m_impl->keyOf(key)] = value;
+    return true;
+}
+
+bool Nvs::remove(const char* key) {
+    return s_state.nvs.erase(m_impl->keyOf(key)) > 0;
+}
+
+// ---- 网络 ----
+
+void netBegin() {
+    if (!s_state.radioOn) {
+        s_state.radioOn = true;
+        s_state.radioOnSinceUs = sim::nowUs();
+    }
+}
+
+void netStartAccessPoint(const char* ssid, const char* password) {
+    (void)ssid;
+    (void)password;
+}
+
+std::string netAccessPointIP() {
+    return "192.168.1.1";
+}
+
+void netConnect(const char* ssid, const char* password) {
+    const sim::NetworkModel& model = s_state.model;
+    sim::device::cancel(s_state.connectTimer);
+    sim::device::cancel(s_state.linkDropTimer);
+    s_state.status = NET_DISCONNECTED;
+
+    // 关联失败在关联阶段就能知道，成功还要再等 DHCP
+    NetStatus result = NET_CONNECTED;
+    int64_t delayUs = sim::device::jitteredUs(model.associateMs);
+    if (!model.apAvailable || model.ssid != ssid) {
+        result = NET_NO_SSID_AVAIL;
+    } else if (model.password != password) {
+        result = NET_CONNECT_FAILED;
+    } else {
+        delayUs += sim::device::jitteredUs(model.dhcpMs);
+    }
+    s_state.connectTimer = sim::scheduleAt(sim::nowUs() + delayUs, [result]() {
+        s_state.connectTimer = 0;
+        s_state.status = result;
+        if (result == NET_CONNECTED && s_state.connectedAtUs < 0) {
+            s_state.connectedAtUs = sim::nowUs();
+        }
+        if (result == NET_CONNECTED && s_state.linkDropUs >= 0) {
+            s_state.linkDropTimer = sim::scheduleAt(sim::nowUs() + s_state.linkDropUs, []() {
+                s_state.linkDropTimer = 0;
+                s_state.status = NET_CONNECTION_LOST;
+            });
+        }
+    });
+}
+
+NetStatus netStatus() {
+    return s_state.status;
+}
+
+std::string netLocalIP() {
+    return s_state.status == NET_CONNECTED ? "192.168.1.100" : "";
+}
+
+void netStartScan() {
+    sim::device::cancel(s_state.scanTimer);
+    s_state.scanState = -1;
+    s_state.scanTimer = sim::scheduleAt(sim::nowUs() + sim::device::jitteredUs(s_state.model.scanMs), []() {
+        s_state.scanTimer = 0;
+        s_state.scanState = s_state.model.apAvailable ? 1 : 0;
+    });
+}
+
+int netScanComplete() {
+    return s_state.scanState;
+}
+
+bool netScanEntry(int index, ScanEntry& entry) {
+    if (index != 0 || s_state.scanState < 1) {
+        return false;
+    }
+    entry.ssid = s_state.model.ssid;
+    entry.rssi = -55;
+    entry.encryption = "WPA2";
+    return true;
+}
+
+void netShutdown() {
+    sim::device::cancel(s_state.connectTimer);
+    sim::device::cancel(s_state.linkDropTimer);
+    sim::device::cancel(s_state.scanTimer);
+    s_state.status = NET_IDLE;
+    if (s_state.radioOn) {
+        s_state.radioOnTotalUs += sim::nowUs() - s_state.radioOnSinceUs;
+        s_state.radioOn = false;
+    }
+}
+
+bool netResolve(const char* host, uint32_t& address) {
+    if (s_state.status != NET_CONNECTED) {
+        return false;
+    }
+    // 每个主机名分到一个固定的 10.0.0.x 地址
+    auto known = s_state.hosts.find(host);
+    if (known == s_state.hosts.end()) {
+        known = s_state.hosts.emplace(host, sim::device::FIRST_HOST_ADDRESS + (uint32_t)s_state.hosts.size()).first;
+    }
+    address = known->second;
+    return true;
+}
+
+// ---- UDP ----
+
+struct UdpSocket::Impl {
+    int id = 0;
+    sim::device::UdpEndpoint endpoint;
+};
+
+UdpSocket::UdpSocket() : m_impl(new Impl) {
+}
+
+UdpSocket::~UdpSocket() {
+    if (m_impl->id != 0) {
+        s_state.sockets.erase(m_impl->id);
+    }
+    delete m_impl;
+}
+
+bool UdpSocket::open() {
+    if (m_impl->id == 0) {
+        m_impl->id = s_state.nextSocketId++;
+        s_state.sockets[m_impl->id] = &m_impl->endpoint;
+    }
+    return true;
+}
+
+bool UdpSocket::sendTo(uint32_t address, uint16_t port, const void* data, size_t length) {
+    if (m_impl->id == 0 || s_state.status != NET_CONNECTED) {
+        return false;
+    }
+    if (port == SntpClient::NTP_PORT && length >= SntpClient::PACKET_SIZE && s_state.linkDropUs < 0) {
+        sim::device::serveNtp(m_impl->id, address, static_cast<const uint8_t*>(data));
+    }
+    return true;
+}
+
+int UdpSocket::receive(void* buffer, size_t size, uint32_t timeoutMs, int64_t& monoUs, uint32_t& from) {
+    if (!m_impl->endpoint.ready.take(timeoutMs)) {
+        return -1;
+    }
+    monoUs = monotonicUs();
+    sim::device::UdpEndpoint::Datagram datagram = m_impl->endpoint.queue.front();
+    m_impl->endpoint.queue.pop_front();
+    from = datagram.from;
+    size_t length = datagram.data.size() < size ? datagram.data.size() : size;
+    memcpy(buffer, datagram.data.data(), length);
+    return (int)length;
+}
+
+// ---- HTTP 服务（模拟中没有客户端） ----
+
+struct HttpServer::Impl {
+    int port;
+};
+
+HttpServer::HttpServer(int port) : m_impl(new Impl) {
+    m_impl->port = port;
+}
+
+HttpServer::~HttpServer() {
+    delete m_impl;
+}
+
+void HttpServer::on(const char* path, HttpMethod method, Handler handler) {
+    (void)path;
+    (void)method;
+    (void)handler;
+}
+
+void HttpServer::onNotFound(Handler handler) {
+    (void)handler;
+}
+
+void HttpServer::begin() {
+}
+
+void HttpServer::stop() {
+}
+
+int HttpServer::port() const {
+    return m_impl->port;
+}
+
+void HttpServer::handleClient() {
+}
+
+std::string HttpServer::arg(const char* name) {
+    (void)name;
+    return "";
+}
+
+void HttpServer::sendHeader(const char* name, const char* value) {
+    (void)name;
+    (void)value;
+}
+
+void HttpServer::send(int code, const char* contentType, const std::string& content) {
+    (void)code;
+    (void)contentType;
+    (void)content;
+}
+
+void HttpServer::sendRaw(const char* data, size_t length) {
+    (void)data;
+    (void)length;
+}
+
+// ---- 系统 ----
+
+void restart() {
+    netShutdown();
+    sim::endSession(sim::SESSION_RESTART);
+}
+
+void deepSleep(int wakePin) {
+    (void)wakePin;
+    netShutdown();
+    sim::endSession(sim::SESSION_DEEP_SLEEP);
+}
+
+}  // namespace hal
@@ -0,0 +1,357 @@
+/*
+ * Copyright (c) 2025 Tomosawa
+ * All rights reserved.
+ *
+ * This code is part of the WiFi2JJY project.
+ * GitHub: https://github.com/Tomosawa/WIFI2JJY
+ */
+
+// 主机微基准：给编码、时间表编译、多路归并、波形渲染和 JSON 生成计时，
+// 改动这些路径前后各跑一次对比每次操作的耗时。
+// 编码一项同时运行最初的 int[60] JJY 编码器作为参考，并先核对两者的输出逐秒一致。
+// 用法：wifi2jjy_bench [过滤子串] [--ms 每项最短运行毫秒数，默认300]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <chrono>
+#include <string>
+#include <vector>
+#include "HALHost.h"
+#include "../TimeCode.h"
+#include "../JJYTimeline.h"
+#include "../JJYSchedule.h"
+#include "../JJYFrameCache.h"
+#include "../JJYWaveform.h"
+#include "../JJYDecoder.h"
+#include "../JJYJitter.h"
+#include "../WiFiManager.h"
+#include "../WebService.h"
+
+static const time_t BASE_MINUTE = 1735689600;  // 2025-01-01 00:00 UTC
+
+static const char* s_filter = nullptr;
+static int s_minMs = 300;
+static volatile uint64_t s_sink;
+
+// 参考实现：最初按秒填 int[60] 的 JJY 编码器（0/1 为数据位，2 为位置标记），
+// 只把奇偶校验改成与现行编码器相同的 NICT 定义（PA1 为小时、PA2 为分钟），其余照旧
+static void baselineEncodeJJY(int jjyBits[60], const struct tm* timeinfo) {
+    for (int i = 0; i < 60; i++) {
+        jjyBits[i] = 0;
+    }
+    // 位置标记 M, P1-P5, P0
+    jjyBits[0] = 2;
+    jjyBits[9] = 2;
+    jjyBits[19] = 2;
+    jjyBits[29] = 2;
+    jjyBits[39] = 2;
+    jjyBits[49] = 2;
+    jjyBits[59] = 2;
+
+    // 分钟（1-8位）：十位1-3位，第4位保留，个位5-8位
+    int minute = timeinfo->tm_min;
+    int min_tens = minute / 10;
+    int min_ones = minute % 10;
+    jjyBits[1] = (min_tens & 0x04) ? 1 : 0;
+    jjyBits[2] = (min_tens & 0x02) ? 1 : 0;
+    jjyBits[3] = (min_tens & 0x01) ? 1 : 0;
+    jjyBits[5] = (min_ones & 0x08) ? 1 : 0;
+    jjyBits[6] = (min_ones & 0x04) ? 1 : 0;
+    jjyBits[7] = (min_ones & 0x02) ? 1 : 0;
+    jjyBits[8] = (min_ones & 0x01) ? 1 : 0;
+
+    // 小时（12-18位）：十位12-13位，第14位保留，个位15-18位
+    int hour = timeinfo->tm_hour;
+    int hour_tens = hour / 10;
+    int hour_ones = hour % 10;
+    jjyBits[12] = (hour_tens & 0x02) ? 1 : 0;
+    jjyBits[13] = (hour_tens & 0x01) ? 1 : 0;
+    jjyBits[15] = (hour_ones & 0x08) ? 1 : 0;
+    jjyBits[16] = (hour_ones & 0x04) ? 1 : 0;
+    jjyBits[17] = (hour_ones & 0x02) ? 1 : 0;
+    jjyBits[18] = (hour_ones & 0x01) ? 1 : 0;
+
+    // 当年第几天（22-33位）：百位22-23位，第24位保留，十位25-28位，个位30-33位
+    int dayOfYear = timeinfo->tm_yday + 1;
+    int day_hundreds = dayOfYear / 100;
+    jjyBits[22] = (day_hundreds & 0x02) ? 1 : 0;
+    jjyBits[23] = (day_hundreds & 0x01) ? 1 : 0;
+    int day_tens = (dayOfYear % 100) / 10;
+    jjyBits[25] = (day_tens & 0x08) ? 1 : 0;
+    jjyBits[26] = (day_tens & 0x04) ? 1 : 0;
+    jjyBits[27] = (day_tens & 0x02) ? 1 : 0;
+    jjyBits[28] = (day_tens & 0x01) ? 1 : 0;
+    int day_ones = dayOfYear % 10;
+    jjyBits[30] = (day_ones & 0x08) ? 1 : 0;
+    jjyBits[31] = (day_ones & 0x04) ? 1 : 0;
+    jjyBits[32] = (day_ones & 0x02) ? 1 : 0;
+    jjyBits[33] = (day_ones & 0x01) ? 1 : 0;
+
+    // 奇偶校验位1（36位）：小时；奇偶校验位2（37位）：分钟
+    int parity1 = 0;
+    for (int i = 12; i <= 18; i++) {
+        if (jjyBits[i] == 1) parity1++;
+    }
+    jjyBits[36] = (parity1 % 2 == 1) ? 1 : 0;
+    int parity2 = 0;
+    for (int i = 1; i <= 8; i++) {
+        if (jjyBits[i] == 1) parity2++;
+    }
+    jjyBits[37] = (parity2 % 2 == 1) ? 1 : 0;
+
+    // 年份（41-48位）：只编码后两位
+    int year = (timeinfo->tm_year + 1900) % 100;
+    int year_tens = year / 10;
+    int year_ones = year % 10;
+    jjyBits[41] = (year_tens & 0x08) ? 1 : 0;
+    jjyBits[42] = (year_tens & 0x04) ? 1 : 0;
+    jjyBits[43] = (year_tens & 0x02) ? 1 : 0;
+    jjyBits[44] = (year_tens & 0x01) ? 1 : 0;
+    jjyBits[45] = (year_ones & 0x08) ? 1 : 0;
+    jjyBits[46] = (year_ones & 0x04) ? 1 : 0;
+    jjyBits[47] = (year_ones & 0x02) ? 1 : 0;
+    jjyBits[48] = (year_ones & 0x01) ? 1 : 0;
+
+    // 星期（50-52位）：0=星期日 ... 6=星期六
+    int dayOfWeek = timeinfo->tm_wday;
+    jjyBits[50] = (dayOfWeek & 0x04) ? 1 : 0;
+    jjyBits[51] = (dayOfWeek & 0x02) ? 1 : 0;
+    jjyBits[52] = (dayOfWeek & 0x01) ? 1 : 0;
+}
+
+// 2000-2099 年每隔 37 分钟取一帧，核对参考实现与 JJYFrame 编码器逐秒码元一致；返回不一致的帧数
+static int checkBaselineJJY() {
+    const time_t first = 946684800;  // 2000-01-01 00:00 UTC
+    const time_t last = 4102444800;  // 2100-01-01 00:00 UTC
+    int frames = 0;
+    int mismatches = 0;
+    for (time_t t = first; t < last; t += 37 * 60) {
+        struct tm timeinfo;
+        gmtime_r(&t, &timeinfo);
+        int jjyBits[60];
+        baselineEncodeJJY(jjyBits, &timeinfo);
+        JJYFrame frame;
+        JJYCode::encodeTime(frame, &timeinfo);
+        frames++;
+        for (int second = 0; second < 60; second++) {
+            if (frame.symbol(second) != jjyBits[second]) {
+                if (mismatches < 5) {
+                    printf("encode/JJY mismatch at %ld second %d: int[60]=%d JJYFrame=%d\n",
+                           (long)t, second, jjyBits[second], frame.symbol(second));
+                }
+                mismatches++;
+                break;
+            }
+        }
+    }
+    printf("encode/JJY int[60] vs JJYFrame: %d frames, %d mismatches\n", frames, mismatches);
+    return mismatches;
+}
+
+// 反复运行 body（每次处理 batch 个操作）直到至少 s_minMs 毫秒，报告每个操作的耗时
+template<class Body>
+static void bench(const char* name, int batch, Body body) {
+    if (s_filter != nullptr && strstr(name, s_filter) == nullptr) {
+        return;
+    }
+    body();  // 预热
+    uint64_t operations = 0;
+    auto start = std::chrono::steady_clock::now();
+    double elapsed = 0;
+    do {
+        body();
+        operations += batch;
+        elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    } while (elapsed * 1000 < s_minMs);
+    printf("%-32s %12.1f ns/op %14.0f op/s\n", name, elapsed * 1e9 / operations, operations / elapsed);
+}
+
+int main(int argc, char** argv) {
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--ms") == 0 && i + 1 < argc) {
+            s_minMs = atoi(argv[++i]);
+        } else {
+            s_filter = argv[i];
+        }
+    }
+    hal::setUtcOffset(8 * 3600);
+
+    // 编码：每批连续1440分钟（一天）。参考实现与 JJYFrame 一样从 time_t 起算，计入换算日历的开销
+    if (s_filter == nullptr || strstr("encode/JJY int[60]", s_filter) != nullptr) {
+        if (checkBaselineJJY() != 0) {
+            return 1;
+        }
+    }
+    bench("encode/JJY int[60]", 1440, []() {
+        int jjyBits[60];
+        uint64_t sum = 0;
+        for (int m = 0; m < 1440; m++) {
+            const time_t jst = BASE_MINUTE + m * 60 + 9 * 3600;
+            struct tm timeinfo;
+            gmtime_r(&jst, &timeinfo);
+            baselineEncodeJJY(jjyBits, &timeinfo);
+            sum += jjyBits[m % 60];
+        }
+        s_sink = sum;
+    });
+    for (int p = 0; p < PROTOCOL_COUNT; p++) {
+        const TimeCode& code = TimeCode::get((TimeCodeProtocol)p);
+        std::string name = std::string("encode/") + code.name;
+        bench(name.c_str(), 1440, [&code]() {
+            JJYFrame frame;
+            uint64_t sum = 0;
+            for (int m = 0; m < 1440; m++) {
+                code.encode(frame, BASE_MINUTE + m * 60, TIME_CODE_NATIVE_ZONE);
+                sum += frame.data;
+            }
+            s_sink = sum;
+        });
+    }
+
+    // 只比较编码本身：日历字段预先换算好
+    {
+        static struct tm days[1440];
+        for (int m = 0; m < 1440; m++) {
+            const time_t jst = BASE_MINUTE + m * 60 + 9 * 3600;
+            gmtime_r(&jst, &days[m]);
+        }
+        bench("encode/JJY int[60] (tm)", 1440, []() {
+            int jjyBits[60];
+            uint64_t sum = 0;
+            for (int m = 0; m < 1440; m++) {
+                baselineEncodeJJY(jjyBits, &days[m]);
+                sum += jjyBits[m % 60];
+            }
+            s_sink = sum;
+        });
+        bench("encode/JJY (tm)", 1440, []() {
+            JJYFrame frame;
+            uint64_t sum = 0;
+            for (int m = 0; m < 1440; m++) {
+                JJYCode::encodeTime(frame, &days[m]);
+                sum += frame.data;
+            }
+            s_sink = sum;
+        });
+    }
+
+    // 帧缓存：每次换一个时钟代数，强制重新预编码 CAPACITY 帧
+    {
+        JJYFrameCache cache(TimeCode::get(PROTOCOL_JJY));
+        uint32_t generation = 0;
+        bench("frameCache/prefill", JJYFrameCache::CAPACITY, [&]() {
+            cache.prefill(BASE_MINUTE, ++generation);
+        });
+    }
+
+    // 时间表编译
+    for (int p = 0; p < PROTOCOL_COUNT; p++) {
+        const TimeCode& code = TimeCode::get((TimeCodeProtocol)p);
+        JJYFrame frame;
+        code.encode(frame, BASE_MINUTE, TIME_CODE_NATIVE_ZONE);
+        static JJYTimeline timeline;
+        std::string name = std::string("timeline/") + code.name;
+        bench(name.c_str(), 1, [&]() {
+            timeline.compile(frame, (int64_t)BASE_MINUTE * 1000000LL, *code.shapes);
+            s_sink = timeline.size();
+        });
+    }
+
+    // 四路不同协议、不同时区归并
+    {
+        static JJYTimeline timelines[JJYSchedule::MAX_CHANNELS];
+        const JJYTimeline* pointers[JJYSchedule::MAX_CHANNELS];
+        for (int i = 0; i < JJYSchedule::MAX_CHANNELS; i++) {
+            const TimeCode& code = TimeCode::get((TimeCodeProtocol)(i % PROTOCOL_COUNT));
+            JJYFrame frame;
+            code.encode(frame, BASE_MINUTE, i * 3600);
+            timelines[i].compile(frame, (int64_t)BASE_MINUTE * 1000000LL, *code.shapes);
+            pointers[i] = &timelines[i];
+        }
+        static JJYSchedule schedule;
+        bench("schedule/merge4", 1, [&]() {
+            schedule.merge(pointers, JJYSchedule::MAX_CHANNELS);
+            s_sink = schedule.size();
+        });
+    }
+
+    // 解码
+    {
+        JJYFrame frame;
+        JJYCode::encode(frame, BASE_MINUTE, TIME_CODE_NATIVE_ZONE);
+        bench("decode/frame", 1, [&]() {
+            JJYDecoded decoded;
+            s_sink = JJYDecoder::decode(frame, decoded);
+        });
+    }
+
+    // 边沿抖动记录（输出热路径上的开销）：每批一帧的边沿，之后由消费者取走
+    {
+        static JJYTimeline timeline;
+        JJYFrame frame;
+        JJYCode::encode(frame, BASE_MINUTE, TIME_CODE_NATIVE_ZONE);
+        timeline.compile(frame, (int64_t)BASE_MINUTE * 1000000LL);
+        static JJYJitterMonitor jitter;
+        jitter.beginSession(timeline.idleLevel());
+        bench("jitter/record (per edge)", timeline.size(), [&]() {
+            for (int i = 0; i < timeline.size(); i++) {
+                jitter.record(timeline[i], i, i & 63);
+            }
+            jitter.drain();
+        });
+    }
+
+    // 波形：渲染一秒（48000 个采样），按采样计
+    {
+        static JJYWaveform waveform;
+        waveform.configure(JJYWaveform::Config());
+        JJYFrame frame;
+        JJYCode::encode(frame, BASE_MINUTE, TIME_CODE_NATIVE_ZONE);
+        static JJYTimeline timeline;
+        timeline.compile(frame, (int64_t)BASE_MINUTE * 1000000LL);
+        static int16_t samples[48000];
+        bench("waveform/render (per sample)", 48000, [&]() {
+            if (waveform.positionUs() >= timeline.endUs()) {
+                waveform.setAnchor(timeline.epochUs());
+            }
+            waveform.render(timeline, samples, 48000);
+            s_sink = samples[0];
+        });
+    }
+
+    // JSON：20个扫描结果，状态
+    {
+        char nvsDirectory[] = "/tmp/wifi2jjy_bench_XXXXXX";
+        if (mkdtemp(nvsDirectory) != nullptr) {
+            hal::host::setNvsDirectory(nvsDirectory);
+        }
+        std::vector<hal::ScanEntry> entries;
+        for (int i = 0; i < 20; i++) {
+            entries.push_back({"Network \"" + std::to_string(i) + "\" 2.4G", -40 - i, "WPA2"});
+        }
+        hal::host::setScanResults(entries);
+        WiFiManager wifiManager;
+        wifiManager.begin();
+        wifiManager.saveWiFiConfig("Home", "secret");
+        WebService webService(&wifiManager, 0);
+        int count = wifiManager.getScannedNetwork();
+
+        bench("json/scan20", 1, [&]() {
+            s_sink = webService.getScanJSON(count).size();
+        });
+        bench("json/status", 1, [&]() {
+            s_sink = webService.getStatusJSON().size();
+        });
+        std::string text = "Some \"quoted\" SSID with\ttabs and \\slashes\\";
+        bench("json/escape", 1, [&]() {
+            s_sink = WebService::escapeJSON(text).size();
+        });
+        std::string cleanup = std::string("rm -rf ") + nvsDirectory;
+        if (system(cleanup.c_str()) != 0) {
+            printf("Failed to remove %s\n", nvsDirectory);
+        }
+    }
+    return 0;
+}
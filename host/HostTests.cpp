@@ -0,0 +1,899 @@
+/*
+ * Copyright (c) 2025 Tomosawa
+ * All rights reserved.
+ *
+ * This code is part of the WiFi2JJY project.
+ * GitHub: https://github.com/Tomosawa/WIFI2JJY
+ */
+
+// 主机测试：在 Linux 上运行固件逻辑（编码、时间表、调度、缓存、波形、校时、
+// WiFi 配置与 Web 服务）并检查结果。由 ctest 调用，任一检查失败时返回非0。
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <algorithm>
+#include <atomic>
+#include <initializer_list>
+#include <string>
+#include <thread>
+#include "HALHost.h"
+#include "../TimeCode.h"
+#include "../JJYTimeline.h"
+#include "../JJYSchedule.h"
+#include "../JJYFrameCache.h"
+#include "../JJYWaveform.h"
+#include "../JJYDecoder.h"
+#include "../JJYTrace.h"
+#include "../JJYJitter.h"
+#include "../JJYCalibration.h"
+#include "../JJYSoftwareOutput.h"
+#include "../JJYSoftwareScheduler.h"
+#include "../JJYSender.h"
+#include "../ClockDiscipline.h"
+#include "../SntpClient.h"
+#include "../TimeSync.h"
+#include "../WiFiManager.h"
+#include "../WebService.h"
+
+static int s_failures = 0;
+
+#define CHECK(cond)                                                          \
+    do {                                                                     \
+        if (!(cond)) {                                                       \
+            printf("  FAILED %s:%d: %s\n", __FILE__, __LINE__, #cond);       \
+            s_failures++;                                                    \
+        }                                                                    \
+    } while (0)
+
+// 2025-01-01 00:00:00 UTC（星期三），北京时间 08:00
+static const time_t NEW_YEAR_2025 = 1735689600;
+
+static void testJJYEncodeDecode() {
+    JJYFrame frame;
+    JJYCode::encode(frame, NEW_YEAR_2025, TIME_CODE_NATIVE_ZONE);
+    JJYDecoded decoded;
+    CHECK(JJYDecoder::decode(frame, decoded) == JJYDecoder::OK);
+    CHECK(decoded.hour == 8);
+    CHECK(decoded.minute == 0);
+    CHECK(decoded.dayOfYear == 1);
+    CHECK(decoded.year2 == 25);
+    CHECK(decoded.weekDay == 3);
+
+    // 按日本时间编码
+    JJYCode::encode(frame, NEW_YEAR_2025 + 59 * 60, 9 * 3600);
+    CHECK(JJYDecoder::decode(frame, decoded) == JJYDecoder::OK);
+    CHECK(decoded.hour == 9);
+    CHECK(decoded.minute == 59);
+}
+
+static void testTimelineShapes() {
+    JJYTimeline timeline;
+    JJYFrame frame;
+    const int64_t epochUs = (int64_t)NEW_YEAR_2025 * 1000000LL;
+
+    const TimeCode& jjy = TimeCode::get(PROTOCOL_JJY);
+    jjy.encode(frame, NEW_YEAR_2025, TIME_CODE_NATIVE_ZONE);
+    timeline.compile(frame, epochUs, *jjy.shapes);
+    CHECK(timeline.size() == 120);
+    CHECK(timeline.idleLevel() == 1);
+    CHECK(timeline[0].timeUs == epochUs);
+    CHECK(timeline[0].level == 0);
+    // 第0秒为位置标记：低电平0.2秒
+    CHECK(timeline[1].timeUs == epochUs + 200000);
+    JJYDecoded decoded;
+    CHECK(JJYDecoder::decode(timeline, decoded) == JJYDecoder::OK);
+
+    // DCF77 第59秒没有脉冲
+    const TimeCode& dcf = TimeCode::get(PROTOCOL_DCF77);
+    dcf.encode(frame, NEW_YEAR_2025, TIME_CODE_NATIVE_ZONE);
+    timeline.compile(frame, epochUs, *dcf.shapes);
+    CHECK(timeline.size() == 118);
+    CHECK(timeline.idleLevel() == 0);
+
+    // WWVB 的位置标记与 JJY 同在第0、9、19...59秒
+    const TimeCode& wwvb = TimeCode::get(PROTOCOL_WWVB);
+    wwvb.encode(frame, NEW_YEAR_2025, TIME_CODE_NATIVE_ZONE);
+    CHECK(frame.symbol(0) == JJYFrame::MARKER);
+    CHECK(frame.symbol(9) == JJYFrame::MARKER);
+    CHECK(frame.symbol(59) == JJYFrame::MARKER);
+    CHECK(frame.symbol(1) != JJYFrame::MARKER);
+}
+
+// 位平面中给定的秒置位（第 s 秒为第 63-s 位）
+static uint64_t secondsMask(std::initializer_list<int> seconds) {
+    uint64_t mask = 0;
+    for (int second : seconds) {
+        mask |= 1ULL << (63 - second);
+    }
+    return mask;
+}
+
+static void testFrameLayout() {
+    // 超出位宽的数值被截断，不写进相邻的秒
+    using Group = BitGroup<5, 4>;
+    CHECK(Group::place(9) == (frameSecondBit(5) | frameSecondBit(8)));
+    CHECK(Group::place(0x1F) == Group::MASK);
+    CHECK((BinaryField<BitGroup<50, 3>>::encode(0xFF) & ~BitGroup<50, 3>::MASK) == 0);
+}
+
+static void testTimeCodeFields() {
+    // 2024-07-04 17:23 UTC（星期四，闰年第186天，美国与欧洲都在夏令时）；
+    // 期望的帧按各台的公开格式逐位手算，不经过帧布局
+    const time_t minute = 1720113780;
+    JJYFrame frame;
+
+    // WWVB 发送本分钟的 UTC：分23（2/3位、7/8位）、时17（13位、16-18位）、
+    // 日186（23位、25位、31/32位）、DUT1 符号"+"（36/38位）、DUT1=0（40-43位）、
+    // 年24（47位、51位）、闰年（55位）、闰秒预告0（56位）、夏令时今天/昨天（57/58位）
+    WWVBCode::encode(frame, minute, TIME_CODE_NATIVE_ZONE);
+    CHECK(frame.data == secondsMask({2, 7, 8, 13, 16, 17, 18, 23, 25, 31, 32, 36, 38, 47, 51, 55, 57, 58}));
+    CHECK(frame.markers == secondsMask({0, 9, 19, 29, 39, 49, 59}));
+
+    // DCF77 发送下一分钟的中欧夏令时 19:24：CEST（17位）、起始位（20位）、
+    // 分24（23、26位，偶校验28位=0）、时19（29、32、33位，偶校验35位=1）、
+    // 日4（38位）、星期四（44位）、月7（45-47位）、年24（52、55位），日期偶校验58位=1
+    DCF77Code::encode(frame, minute, TIME_CODE_NATIVE_ZONE);
+    CHECK(frame.data == secondsMask({17, 20, 23, 26, 29, 32, 33, 35, 38, 44, 45, 46, 47, 52, 55, 58}));
+    CHECK(frame.markers == 0);
+
+    // MSF 发送下一分钟的英国夏令时 18:24。A 位：年24（19、22位）、月7（27-29位）、日4（33位）、
+    // 星期四（36位）、时18（40、41位）、分24（46、49位），52-59位固定为 01111110。
+    // B 位：奇校验 年（54位=1）、月日（55位=1）、星期（56位=0）、时分（57位=1），BST（58位）
+    MSFCode::encode(frame, minute, TIME_CODE_NATIVE_ZONE);
+    CHECK(frame.data == secondsMask({19, 22, 27, 28, 29, 33, 36, 40, 41, 46, 49, 53, 54, 55, 56, 57, 58}));
+    CHECK(frame.markers == secondsMask({54, 55, 57, 58}));
+}
+
+static void testScheduleMerge() {
+    JJYFrame frame;
+    JJYCode::encode(frame, NEW_YEAR_2025, TIME_CODE_NATIVE_ZONE);
+    JJYTimeline a;
+    JJYTimeline b;
+    const int64_t epochUs = (int64_t)NEW_YEAR_2025 * 1000000LL;
+    a.compile(frame, epochUs);
+    b.compile(frame, epochUs);
+
+    // 两路完全相同时每个时刻合并为一步，两路同时跳变
+    const JJYTimeline* timelines[2] = {&a, &b};
+    JJYSchedule schedule;
+    schedule.merge(timelines, 2);
+    CHECK(schedule.size() == 120);
+    CHECK(schedule.epochUs() == epochUs);
+    CHECK(schedule.channelMask() == 0x3);
+    CHECK(schedule.idleHighMask() == 0x3);
+    CHECK(schedule[0].clearMask == 0x3 && schedule[0].pulseMask == 0x3);
+    CHECK(schedule[1].setMask == 0x3 && schedule[1].pulseMask == 0);
+    for (int i = 1; i < schedule.size(); i++) {
+        CHECK(schedule.timeUs(i) > schedule.timeUs(i - 1));
+        CHECK(schedule.startsPulse(i) == (i % 2 == 0));
+    }
+
+    // 各路的补偿在归并前加上：进入脉冲的边沿提前，可以早于分钟起点
+    a.advanceEdges(1000, 500);
+    b.advanceEdges(1000, 500);
+    schedule.merge(timelines, 2);
+    CHECK(schedule.timeUs(0) == epochUs - 1000);
+    CHECK(schedule.timeUs(1) == a[1].timeUs);
+
+    // 空闲为高的一路脉冲 0-800ms，空闲为低的一路 0-100ms 和 200-300ms：
+    // 第二路的第二个脉冲开始时第一路还在脉冲中，不是停止点，下一秒的秒首才是
+    a.clear(epochUs, 1);
+    b.clear(epochUs, 0);
+    for (int s = 0; s < 2; s++) {
+        const int64_t secondUs = epochUs + s * JJYTimeline::SECOND_US;
+        a.append(secondUs, 0);
+        a.append(secondUs + 800000, 1);
+        b.append(secondUs, 1);
+        b.append(secondUs + 100000, 0);
+        b.append(secondUs + 200000, 1);
+        b.append(secondUs + 300000, 0);
+    }
+    schedule.merge(timelines, 2);
+    CHECK(schedule.size() == 10);
+    CHECK(schedule.idleHighMask() == 0x1);
+    CHECK(schedule[0].clearMask == 0x1 && schedule[0].setMask == 0x2);
+    CHECK(schedule[2].pulseMask == 0x2 && schedule[2].activeMask == 0x1);
+    CHECK(schedule[4].setMask == 0x1 && schedule[4].activeMask == 0x1);
+    for (int i = 0; i < schedule.size(); i++) {
+        CHECK(schedule.startsPulse(i) == (i == 0 || i == 5));
+    }
+}
+
+static void testFrameCache() {
+    JJYFrameCache cache(TimeCode::get(PROTOCOL_JJY));
+    JJYFrame frame;
+    cache.prefill(NEW_YEAR_2025, 1);
+    CHECK(cache.lookup(NEW_YEAR_2025, 1, frame));
+    CHECK(cache.lookup(NEW_YEAR_2025 + 3 * 60, 1, frame));
+    CHECK(!cache.lookup(NEW_YEAR_2025 + 4 * 60, 1, frame));
+    // 时钟代数变化后缓存失效
+    CHECK(!cache.lookup(NEW_YEAR_2025, 2, frame));
+
+    JJYFrame direct;
+    JJYCode::encode(direct, NEW_YEAR_2025 + 60, TIME_CODE_NATIVE_ZONE);
+    CHECK(cache.lookup(NEW_YEAR_2025 + 60, 1, frame));
+    CHECK(frame.data == direct.data && frame.markers == direct.markers);
+
+    // 多路发送时每路按自己的时区预编码：UTC 0:00 在东9区是 9:00
+    JJYFrameCache zoned(TimeCode::get(PROTOCOL_JJY), 9 * 3600);
+    zoned.prefill(NEW_YEAR_2025, 1);
+    CHECK(zoned.lookup(NEW_YEAR_2025, 1, frame));
+    JJYCode::encode(direct, NEW_YEAR_2025, 9 * 3600);
+    CHECK(frame.data == direct.data);
+    JJYCode::encode(direct, NEW_YEAR_2025, 0);
+    CHECK(frame.data != direct.data);
+}
+
+static void testWaveform() {
+    static JJYWaveform waveform;
+    CHECK(waveform.configure(JJYWaveform::Config()));
+    waveform.setAnchor(1000000);
+    CHECK(waveform.sampleAt(2000000) == 48000);
+    CHECK(waveform.sampleTimeUs(48000) == 2000000);
+}
+
+static uint32_t readLE(const uint8_t* bytes, int count) {
+    uint32_t value = 0;
+    for (int i = count - 1; i >= 0; i--) {
+        value = (value << 8) | bytes[i];
+    }
+    return value;
+}
+
+// [fromMs, toMs) 秒内窗口的最大采样幅度
+static int wavPeak(const std::string& wav, int second, int fromMs, int toMs) {
+    const size_t rate = 48000;
+    int peak = 0;
+    for (size_t i = second * rate + fromMs * rate / 1000; i < second * rate + toMs * rate / 1000; i++) {
+        const int16_t sample = (int16_t)readLE((const uint8_t*)wav.data() + 44 + 2 * i, 2);
+        peak = std::max(peak, abs(sample));
+    }
+    return peak;
+}
+
+static void testWaveformWav() {
+    static JJYWaveform waveform;
+    const JJYWaveform::Config config;
+    CHECK(waveform.configure(config));
+    FILE* file = tmpfile();
+    CHECK(file != nullptr);
+    if (file == nullptr) {
+        return;
+    }
+    CHECK(waveform.writeWav(file, NEW_YEAR_2025));
+    std::string wav;
+    wav.resize((size_t)ftell(file));
+    rewind(file);
+    CHECK(fread(&wav[0], 1, wav.size(), file) == wav.size());
+    fclose(file);
+
+    // 一分钟 48kHz 单声道 16 位：数据 5760000 字节，RIFF 大小为数据加 36 字节头
+    const uint32_t dataBytes = 60 * 48000 * 2;
+    CHECK(wav.size() == 44 + dataBytes);
+    if (wav.size() != 44 + dataBytes) {
+        return;
+    }
+    const uint8_t* header = (const uint8_t*)wav.data();
+    CHECK(memcmp(header, "RIFF", 4) == 0);
+    CHECK(readLE(header + 4, 4) == 36 + dataBytes);
+    CHECK(memcmp(header + 8, "WAVEfmt ", 8) == 0);
+    CHECK(readLE(header + 22, 2) == 1);
+    CHECK(readLE(header + 24, 4) == 48000);
+    CHECK(memcmp(header + 36, "data", 4) == 0);
+    CHECK(readLE(header + 40, 4) == dataBytes);
+
+    // DA 低电平（脉冲）为满幅，其余为 10% 幅度：
+    // 标记 0.2 秒、数据位0 0.8 秒、数据位1 0.5 秒满幅
+    JJYFrame frame;
+    JJYCode::encode(frame, NEW_YEAR_2025, TIME_CODE_NATIVE_ZONE);
+    int zero = -1;
+    int one = -1;
+    for (int second = 1; second < 60; second++) {
+        if (frame.symbol(second) == JJYFrame::ZERO && zero < 0) {
+            zero = second;
+        } else if (frame.symbol(second) == JJYFrame::ONE && one < 0) {
+            one = second;
+        }
+    }
+    CHECK(zero > 0 && one > 0);
+    const int full = config.fullAmplitude * 9 / 10;
+    const int reduced = config.reducedAmplitude;
+    CHECK(wavPeak(wav, 0, 50, 150) >= full);
+    CHECK(wavPeak(wav, 0, 300, 900) <= reduced);
+    CHECK(wavPeak(wav, 0, 300, 900) >= reduced * 9 / 10);
+    CHECK(wavPeak(wav, zero, 100, 700) >= full);
+    CHECK(wavPeak(wav, zero, 850, 950) <= reduced);
+    CHECK(wavPeak(wav, one, 100, 400) >= full);
+    CHECK(wavPeak(wav, one, 600, 900) <= reduced);
+}
+
+static void timerSignal(void* arg) {
+    static_cast<hal::Event*>(arg)->signal();
+}
+
+static void testClockAndTimer() {
+    // 挂钟换算到单调时钟后应与当前单调时间一致
+    int64_t mono = TimeSync::wallToMonotonicUs(TimeSync::wallTimeUs());
+    int64_t diff = mono - hal::monotonicUs();
+    CHECK(diff > -1000 && diff < 1000);
+
+    hal::Event event;
+    CHECK(!event.wait(1));
+    hal::OneShotTimer timer(&timerSignal, &event, "test");
+    int64_t start = hal::monotonicUs();
+    CHECK(timer.start(20000));
+    CHECK(event.wait(1000));
+    CHECK(hal::monotonicUs() - start >= 19000);
+
+    // 停止后不再触发
+    CHECK(timer.start(20000));
+    timer.stop();
+    CHECK(!event.wait(50));
+}
+
+static void testGpio() {
+    hal::pinOutput(3, true);
+    CHECK(hal::host::pinLevel(3));
+    hal::pinWrite(3, false);
+    CHECK(!hal::pinRead(3));
+    hal::pinInput(4);
+    hal::host::setPinLevel(4, true);
+    CHECK(hal::pinRead(4));
+}
+
+static void testWiFiManagerAndJson() {
+    hal::host::setScanResults({{"Home \"Net\"", -42, "WPA2"}, {"", -90, "Open"}, {"Cafe", -70, "Open"}});
+    hal::host::setNetStatus(hal::NET_DISCONNECTED);
+    WiFiManager wifiManager;
+    wifiManager.begin();
+    CHECK(!wifiManager.hasSavedConfig());
+    CHECK(!wifiManager.isConnected());
+    CHECK(wifiManager.getLocalIP().empty());
+
+    WebService webService(&wifiManager, 0);
+    int count = wifiManager.getScannedNetwork();
+    CHECK(count == 3);
+    CHECK(webService.getScanJSON(count) ==
+          "{\"status\":\"success\",\"networks\":["
+          "{\"ssid\":\"Home \\\"Net\\\"\",\"rssi\":-42,\"encryption\":\"WPA2\"},"
+          "{\"ssid\":\"Cafe\",\"rssi\":-70,\"encryption\":\"Open\"}],\"count\":3}");
+    CHECK(webService.getNetworkListJSON() ==
+          "[{\"ssid\":\"Home \\\"Net\\\"\",\"rssi\":-42,\"encryption\":\"WPA2\"},"
+          "{\"ssid\":\"Cafe\",\"rssi\":-70,\"encryption\":\"Open\"}]");
+    CHECK(WebService::escapeJSON("a\\b\n\x01") == "a\\\\b\\n\\u0001");
+
+    CHECK(wifiManager.connectToNetwork("Cafe", "p\"w"));
+    CHECK(wifiManager.getSavedSSID() == "Cafe");
+    CHECK(webService.getStatusJSON() ==
+          "{\"connected\":true,\"status\":\"Connected\",\"ip\":\"127.0.0.1\",\"ssid\":\"Cafe\","
+          "\"saved\":{\"ssid\":\"Cafe\",\"password\":\"p\\\"w\"}}");
+    TimeSync timeSync;
+    webService.setTimeSync(&timeSync);
+    CHECK(webService.getStatusJSON().find(
+              ",\"time\":{\"source\":\"none\",\"synced\":false,\"errorUs\":null,\"limitUs\":100000,"
+              "\"lastSyncS\":null,\"frequencyPpm\":0.000,\"pollS\":0}}") != std::string::npos);
+
+    wifiManager.clearWiFiConfig();
+    CHECK(!wifiManager.hasSavedConfig());
+}
+
+// 向本机端口发送一个请求并读回完整响应
+static std::string httpRequest(int port, const std::string& request) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons((uint16_t)port);
+    std::string response;
+    if (connect(fd, (struct sockaddr*)&addr, sizeof(addr)) == 0) {
+        ::send(fd, request.data(), request.size(), 0);
+        char buffer[1024];
+        ssize_t length;
+        while ((length = recv(fd, buffer, sizeof(buffer), 0)) > 0) {
+            response.append(buffer, length);
+        }
+    }
+    close(fd);
+    return response;
+}
+
+// 客户端线程发请求，本线程像固件主循环一样轮询 handleClient
+static std::string serve(WebService& webService, const std::string& request) {
+    std::atomic<bool> done(false);
+    std::string response;
+    std::thread client([&]() {
+        response = httpRequest(webService.port(), request);
+        done = true;
+    });
+    int64_t deadline = hal::monotonicUs() + 5000000;
+    while (!done && hal::monotonicUs() < deadline) {
+        webService.handleClient();
+        hal::sleepMs(1);
+    }
+    client.join();
+    return response;
+}
+
+static void testWebService() {
+    hal::host::setNetStatus(hal::NET_DISCONNECTED);
+    WiFiManager wifiManager;
+    wifiManager.begin();
+    WebService webService(&wifiManager, 0);
+    webService.begin();
+    CHECK(webService.isRunning());
+    CHECK(webService.port() > 0);
+
+    std::string response = serve(webService, "GET /status HTTP/1.1\r\nHost: test\r\n\r\n");
+    CHECK(response.compare(0, 15, "HTTP/1.1 200 OK") == 0);
+    CHECK(response.find("Access-Control-Allow-Origin: *") != std::string::npos);
+    CHECK(response.find("\"connected\":false") != std::string::npos);
+
+    std::string body = "ssid=Home%20Net&password=a%2Bb";
+    response = serve(webService, "POST /connect HTTP/1.1\r\nHost: test\r\n"
+                                 "Content-Type: application/x-www-form-urlencoded\r\n"
+                                 "Content-Length: " + std::to_string(body.size()) + "\r\n\r\n" + body);
+    CHECK(response.compare(0, 12, "HTTP/1.1 202") == 0);
+    wifiManager.handleConnection();
+    CHECK(wifiManager.getSavedSSID() == "Home Net");
+    CHECK(wifiManager.getSavedPassword() == "a+b");
+
+    response = serve(webService, "GET / HTTP/1.1\r\nHost: test\r\n\r\n");
+    CHECK(response.find("Content-Type: text/html") != std::string::npos);
+    CHECK(response.find("</html>") != std::string::npos);
+
+    response = serve(webService, "GET /missing HTTP/1.1\r\nHost: test\r\n\r\n");
+    CHECK(response.compare(0, 12, "HTTP/1.1 404") == 0);
+
+    wifiManager.clearWiFiConfig();
+}
+
+static void appendSink(void* context, const char* data, size_t length) {
+    static_cast<std::string*>(context)->append(data, length);
+}
+
+static void testTraceVcd() {
+    JJYTimeline timeline;
+    JJYFrame frame;
+    const int64_t epochUs = (int64_t)NEW_YEAR_2025 * 1000000LL;
+    const TimeCode& jjy = TimeCode::get(PROTOCOL_JJY);
+    jjy.encode(frame, NEW_YEAR_2025, TIME_CODE_NATIVE_ZONE);
+    timeline.compile(frame, epochUs, *jjy.shapes);
+
+    JJYTraceCapture capture;
+    // PON 按单调时钟记录，这里单调时钟比挂钟慢 1000 秒；电平不变的重复记录不占缓冲
+    const int64_t monoToWallUs = 1000000000LL;
+    capture.recordPon(false, epochUs - 5000000 - monoToWallUs);
+    for (int i = 0; i < timeline.size(); i++) {
+        capture.recordDa(timeline[i].level != 0, timeline[i].timeUs);
+    }
+    for (size_t i = 0; i < 4 * JJYTraceCapture::PON_CAPACITY; i++) {
+        CHECK(capture.recordPon(false, epochUs - monoToWallUs + (int64_t)i * 1000000));
+    }
+    CHECK(capture.recordPon(true, epochUs + 60500000 - monoToWallUs));
+    capture.setMonotonicOffset(monoToWallUs);
+
+    std::string vcd;
+    JJYTraceWriter writer(appendSink, &vcd);
+    int64_t originUs = 0;
+    CHECK(capture.oldestTime(originUs));
+    CHECK(originUs == epochUs - 5000000);
+    writer.begin(originUs, "test");
+    CHECK(capture.drainTo(writer) == (size_t)(timeline.size() + 2));
+    writer.end(epochUs + 61000000);
+    CHECK(capture.dropped() == 0);
+    CHECK(!capture.oldestTime(originUs));
+
+    CHECK(vcd.find("$timescale 1us $end") != std::string::npos);
+    CHECK(vcd.find("$var wire 1 ! DA $end") != std::string::npos);
+    CHECK(vcd.find("$var wire 1 \" PON $end") != std::string::npos);
+    // 分标记下降沿在第5秒，PON 在帧后拉高，分钟结束处注释解码结果
+    CHECK(vcd.find("#5000000\n0!\n") != std::string::npos);
+    CHECK(vcd.find("#65500000\n1\"\n") != std::string::npos);
+    CHECK(vcd.find("s25/001_08:00_w3 #") != std::string::npos);
+}
+
+static void testJitterMonitor() {
+    JJYTimeline timeline;
+    JJYFrame frame;
+    const int64_t epochUs = (int64_t)NEW_YEAR_2025 * 1000000LL;
+    JJYCode::encode(frame, NEW_YEAR_2025, TIME_CODE_NATIVE_ZONE);
+    timeline.compile(frame, epochUs, *TimeCode::get(PROTOCOL_JJY).shapes);
+
+    // 下降沿晚 30us，上升沿晚 130us：每个脉冲宽 100us
+    JJYJitterMonitor jitter;
+    jitter.beginSession(timeline.idleLevel());
+    for (int i = 0; i < timeline.size(); i++) {
+        jitter.record(timeline[i], i, timeline[i].level == 0 ? 30 : 130);
+    }
+    CHECK(jitter.drain() == (size_t)timeline.size());
+    CHECK(jitter.lateness().count == 120);
+    CHECK(jitter.lateness().minUs == 30);
+    CHECK(jitter.lateness().maxUs == 130);
+    CHECK(jitter.lateness().bins[2] == 60);  // <=50us
+    CHECK(jitter.lateness().bins[4] == 60);  // <=200us
+    CHECK(jitter.widthClassCount() == 3);
+    uint32_t pulses = 0;
+    for (int i = 0; i < jitter.widthClassCount(); i++) {
+        uint32_t nominalMs = jitter.widthNominalMs(i);
+        CHECK(nominalMs == 200 || nominalMs == 500 || nominalMs == 800);
+        CHECK(jitter.widthError(i).minUs == 100 && jitter.widthError(i).maxUs == 100);
+        pulses += jitter.widthError(i).count;
+    }
+    CHECK(pulses == 60);
+
+    // 只有首尾边沿（硬件定时后端）时没有脉宽样本
+    jitter.beginSession(timeline.idleLevel());
+    jitter.record(timeline[0], 0, 5);
+    jitter.record(timeline[timeline.size() - 1], timeline.size() - 1, -5);
+    jitter.drain();
+    CHECK(jitter.lateness().count == 2);
+    CHECK(jitter.lateness().early == 1);
+    CHECK(jitter.widthClassCount() == 0);
+
+    // 缓冲满时丢弃并计数
+    jitter.beginSession(timeline.idleLevel());
+    for (size_t i = 0; i < JJYJitterMonitor::RING_CAPACITY + 10; i++) {
+        jitter.record(timeline[0], 0, 0);
+    }
+    CHECK(jitter.dropped() == 10);
+    char text[160];
+    jitter.drain();
+    jitter.lateness().format(text, sizeof(text));
+    CHECK(strcmp(text, "<=10us:256") == 0);
+}
+
+static void testEdgeCompensation() {
+    JJYTimeline timeline;
+    JJYFrame frame;
+    const int64_t epochUs = (int64_t)NEW_YEAR_2025 * 1000000LL;
+    JJYCode::encode(frame, NEW_YEAR_2025, TIME_CODE_NATIVE_ZONE);
+    timeline.compile(frame, epochUs, *TimeCode::get(PROTOCOL_JJY).shapes);
+
+    // 下降沿（进入脉冲）提前 70ms，上升沿提前 10ms
+    timeline.advanceEdges(70000, 10000);
+    CHECK(timeline[0].timeUs == epochUs - 70000);
+    CHECK(timeline[1].timeUs == epochUs + 200000 - 10000);
+
+    JJYEdgeCompensation compensation;
+    CHECK(!JJYEdgeCompensation::load("rmt", compensation));
+    compensation.toPulseUs = 70000;
+    compensation.toIdleUs = -250;
+    CHECK(compensation.save("rmt"));
+    JJYEdgeCompensation loaded;
+    CHECK(JJYEdgeCompensation::load("rmt", loaded));
+    CHECK(loaded.toPulseUs == 70000 && loaded.toIdleUs == -250);
+    CHECK(!JJYEdgeCompensation::load("timer", loaded));
+    CHECK(JJYEdgeCompensation::clear("rmt"));
+    CHECK(!JJYEdgeCompensation::load("rmt", loaded));
+}
+
+static void onPonRaised(void* arg, bool level, int64_t monoUs) {
+    (void)monoUs;
+    if (level) {
+        static_cast<JJYOutput*>(arg)->requestStop(JJYOutput::STOP_AT_PULSE);
+    }
+}
+
+static void testPonStop() {
+    // 每150ms一个50ms的脉冲，第二个脉冲开始前拉高 PON
+    const int64_t startUs = TimeSync::wallTimeUs() + 100000;
+    JJYTimeline timeline;
+    timeline.clear(startUs, 1);
+    for (int i = 0; i < 3; i++) {
+        timeline.append(startUs + i * 150000, 0);
+        timeline.append(startUs + i * 150000 + 50000, 1);
+    }
+    JJYSoftwareOutput output(5, 1);
+    CHECK(output.start());
+    hal::pinInput(6);
+    hal::host::setPinLevel(6, false);
+    CHECK(hal::pinCapture(6, onPonRaised, &output));
+    CHECK(output.submit(timeline, 1000));
+    hal::sleepMs(200);
+    hal::host::setPinLevel(6, true);
+
+    // 停在第二个脉冲开始处，不等整帧结束
+    CHECK(output.waitFrameDone(1000));
+    CHECK(TimeSync::wallTimeUs() < startUs + 300000);
+    CHECK(output.report().stoppedIndex == 2);
+    CHECK(hal::host::pinLevel(5));
+
+    // 请求一直有效，直到 clearStop
+    timeline.advanceEdges(-1000000, -1000000);
+    CHECK(output.submit(timeline, 1000));
+    CHECK(output.waitFrameDone(1000));
+    CHECK(output.report().stoppedIndex == 0);
+
+    // PON 又回落：清除停止请求后下一帧完整输出
+    hal::host::setPinLevel(6, false);
+    output.clearStop();
+    const int64_t nextUs = TimeSync::wallTimeUs() + 50000;
+    timeline.clear(nextUs, 1);
+    timeline.append(nextUs, 0);
+    timeline.append(nextUs + 50000, 1);
+    CHECK(output.submit(timeline, 1000));
+    CHECK(output.waitFrameDone(1000));
+    CHECK(output.report().stoppedIndex < 0);
+    CHECK(TimeSync::wallTimeUs() >= nextUs + 50000);
+    hal::pinCapture(6, nullptr, nullptr);
+}
+
+static void onSchedulerPonRaised(void* arg, bool level, int64_t monoUs) {
+    (void)monoUs;
+    if (level) {
+        static_cast<JJYScheduler*>(arg)->requestStop(JJYScheduler::STOP_AT_PULSE);
+    }
+}
+
+// 两路测试队列：每 period 一个周期，空闲为高的一路脉冲 120ms，
+// 空闲为低的一路脉冲 0-40ms 和 80-100ms（每周期5步）
+static JJYSchedule testSchedule(int64_t startUs, int64_t periodUs, int periods) {
+    JJYTimeline a;
+    JJYTimeline b;
+    a.clear(startUs, 1);
+    b.clear(startUs, 0);
+    for (int i = 0; i < periods; i++) {
+        const int64_t t = startUs + i * periodUs;
+        a.append(t, 0);
+        a.append(t + 120000, 1);
+        b.append(t, 1);
+        b.append(t + 40000, 0);
+        b.append(t + 80000, 1);
+        b.append(t + 100000, 0);
+    }
+    const JJYTimeline* timelines[2] = {&a, &b};
+    JJYSchedule schedule;
+    schedule.merge(timelines, 2);
+    return schedule;
+}
+
+static void testScheduler() {
+    const int pins[2] = {8, 9};
+    JJYSoftwareScheduler scheduler(pins, 2, 0x1);
+    CHECK(scheduler.start());
+    CHECK(hal::host::pinLevel(8) && !hal::host::pinLevel(9));
+
+    // 整帧输出，两路最后都回到空闲电平
+    int64_t startUs = TimeSync::wallTimeUs() + 50000;
+    CHECK(scheduler.submit(testSchedule(startUs, 200000, 2), 1000));
+    hal::sleepMs(70);
+    CHECK(!hal::host::pinLevel(8) && hal::host::pinLevel(9));
+    CHECK(scheduler.waitFrameDone(1000));
+    CHECK(TimeSync::wallTimeUs() >= startUs + 320000);
+    CHECK(scheduler.report().stoppedIndex < 0 && scheduler.report().missedIndex < 0);
+    CHECK(hal::host::pinLevel(8) && !hal::host::pinLevel(9));
+
+    // 第二个周期的 60ms 处拉高 PON：第二路在 80ms 的脉冲照常输出（第一路还在脉冲中），
+    // 第一路的脉冲照常结束，停在第三个周期开始处
+    hal::pinInput(6);
+    hal::host::setPinLevel(6, false);
+    CHECK(hal::pinCapture(6, onSchedulerPonRaised, &scheduler));
+    startUs = TimeSync::wallTimeUs() + 50000;
+    CHECK(scheduler.submit(testSchedule(startUs, 200000, 4), 1000));
+    hal::sleepMs((uint32_t)((startUs + 260000 - TimeSync::wallTimeUs()) / 1000));
+    hal::host::setPinLevel(6, true);
+    hal::sleepMs(30);
+    CHECK(!hal::host::pinLevel(8) && hal::host::pinLevel(9));
+    CHECK(scheduler.waitFrameDone(1000));
+    CHECK(TimeSync::wallTimeUs() < startUs + 500000);
+    CHECK(scheduler.report().stoppedIndex == 10);
+    CHECK(hal::host::pinLevel(8) && !hal::host::pinLevel(9));
+
+    // 请求一直有效，直到 clearStop
+    CHECK(scheduler.submit(testSchedule(TimeSync::wallTimeUs() + 50000, 200000, 1), 1000));
+    CHECK(scheduler.waitFrameDone(1000));
+    CHECK(scheduler.report().stoppedIndex == 0);
+    hal::host::setPinLevel(6, false);
+    scheduler.clearStop();
+    hal::pinCapture(6, nullptr, nullptr);
+
+    // 第一步已晚于截止时间：整帧放弃，计为迟到开始
+    const uint32_t lateStarts = scheduler.deadlineStats().lateStarts;
+    CHECK(scheduler.submit(testSchedule(TimeSync::wallTimeUs() - 50000, 200000, 2), 1000));
+    CHECK(scheduler.waitFrameDone(1000));
+    CHECK(scheduler.report().missedIndex == 0);
+    CHECK(scheduler.deadlineStats().lateStarts == lateStarts + 1);
+    CHECK(hal::host::pinLevel(8) && !hal::host::pinLevel(9));
+}
+
+static void testOutputIdleLevel() {
+    // WWVB/DCF77/MSF 空闲为低电平（满幅），JJY 为高电平：启动、中止和立即停止后 DA 都回到协议的空闲电平
+    const int pin = 7;
+    for (int p = 0; p < PROTOCOL_COUNT; p++) {
+        const TimeCode& code = TimeCode::get((TimeCodeProtocol)p);
+        const bool idle = code.shapes->idleLevel != 0;
+        for (int backend = JJYSender::BACKEND_SOFTWARE; backend <= JJYSender::BACKEND_I2S; backend++) {
+            hal::pinOutput(pin, !idle);
+            JJYSender sender(pin, (JJYSender::OutputBackend)backend, code.protocol);
+            CHECK(hal::host::pinLevel(pin) == idle);
+        }
+
+        hal::pinOutput(pin, !idle);
+        JJYSoftwareOutput output(pin, code.shapes->idleLevel);
+        CHECK(output.start());
+        CHECK(hal::host::pinLevel(pin) == idle);
+
+        // 每个协议第0秒的脉冲都不短于100ms，在脉冲中途中止或立即停止
+        JJYFrame frame;
+        code.encode(frame, NEW_YEAR_2025, TIME_CODE_NATIVE_ZONE);
+        for (int stop = 0; stop < 2; stop++) {
+            JJYTimeline timeline;
+            timeline.compile(frame, TimeSync::wallTimeUs() + 50000, *code.shapes);
+            CHECK(output.submit(timeline, 1000));
+            hal::sleepMs(100);
+            CHECK(hal::host::pinLevel(pin) != idle);
+            if (stop == 0) {
+                output.cancel();
+            } else {
+                output.requestStop(JJYOutput::STOP_NOW);
+            }
+            CHECK(output.waitFrameDone(1000));
+            CHECK(hal::host::pinLevel(pin) == idle);
+            output.clearStop();
+        }
+    }
+}
+
+static void testSntpPacket() {
+    // NTP 时间戳往返不丢微秒，2036 年之后进入下一纪元
+    uint8_t field[8];
+    const int64_t t1Us = (int64_t)NEW_YEAR_2025 * 1000000LL + 123457;
+    SntpClient::writeTimestamp(field, t1Us);
+    CHECK(SntpClient::readTimestamp(field) == t1Us);
+    const int64_t year2040Us = 2208988800LL * 1000000LL + 999999;
+    SntpClient::writeTimestamp(field, year2040Us);
+    CHECK(SntpClient::readTimestamp(field) == year2040Us);
+
+    // 服务器快 2.5s，去程 30ms、回程 10ms，服务器处理 100us
+    uint8_t packet[SntpClient::PACKET_SIZE];
+    SntpClient::buildRequest(packet, t1Us);
+    CHECK((packet[0] & 0x07) == 3);
+    uint8_t reply[SntpClient::PACKET_SIZE] = {};
+    reply[0] = (4 << 3) | 4;
+    reply[1] = 1;
+    reply[11] = 0x83;  // 根离散度 2ms
+    memcpy(reply + 24, packet + 40, 8);
+    const int64_t t2Us = t1Us + 2500000 + 30000;
+    SntpClient::writeTimestamp(reply + 32, t2Us);
+    SntpClient::writeTimestamp(reply + 40, t2Us + 100);
+    const int64_t t4Us = t1Us + 30000 + 100 + 10000;
+    NtpSample sample;
+    CHECK(SntpClient::parseResponse(reply, sizeof(reply), t1Us, t4Us, sample));
+    CHECK(sample.delayUs == 40000);
+    CHECK(sample.offsetUs == 2500000 + 10000);  // 往返不对称带来的误差为时延差的一半
+    CHECK(sample.errorUs >= 20000 + 1900 && sample.errorUs <= 20000 + 2100);
+    CHECK(sample.stratum == 1);
+
+    // 不是对这次请求的应答、Kiss-o'-Death、未同步的服务器都拒绝
+    CHECK(!SntpClient::parseResponse(reply, sizeof(reply), t1Us + 1, t4Us, sample));
+    reply[1] = 0;
+    CHECK(!SntpClient::parseResponse(reply, sizeof(reply), t1Us, t4Us, sample));
+    reply[1] = 1;
+    reply[0] |= 3 << 6;
+    CHECK(!SntpClient::parseResponse(reply, sizeof(reply), t1Us, t4Us, sample));
+    CHECK(!SntpClient::parseResponse(reply, 40, t1Us, t4Us, sample));
+
+    // 时延最小的服务器快了 400ms：与另两台的区间不相交，被当作假报者剔除
+    NtpSample samples[3];
+    samples[0].offsetUs = 400000;
+    samples[0].delayUs = 10000;
+    samples[0].errorUs = 15000;
+    samples[1].offsetUs = 2000;
+    samples[1].delayUs = 40000;
+    samples[1].errorUs = 30000;
+    samples[2].offsetUs = -1000;
+    samples[2].delayUs = 30000;
+    samples[2].errorUs = 25000;
+    NtpSample best;
+    CHECK(SntpClient::selectBest(samples, 3, best) == 2);
+    CHECK(best.offsetUs == -1000);
+    // 两台互不相交时没有多数，退回时延最小的
+    CHECK(SntpClient::selectBest(samples, 2, best) == 1);
+    CHECK(best.offsetUs == 400000);
+    CHECK(SntpClient::selectBest(samples, 0, best) == 0);
+
+    // 主机 HAL 的挂钟调整只作用于本进程
+    const int64_t before = hal::wallTimeUs();
+    hal::slewWallTime(5000000);
+    CHECK(hal::wallTimeUs() - before >= 5000000);
+    hal::setWallTimeUs(before);
+    CHECK(llabs(hal::wallTimeUs() - before) < 100000);
+}
+
+static void testClockDiscipline() {
+    // 晶振快 30ppm：十分钟后本地时钟快了 18ms
+    const int64_t startUs = (int64_t)NEW_YEAR_2025 * 1000000LL;
+    const int64_t intervalUs = 600LL * 1000000LL;
+    ClockDiscipline discipline;
+    CHECK(discipline.estimatedErrorUs(startUs) == INT64_MAX);
+    discipline.update(startUs, 0, 20000, true);
+    CHECK(!discipline.learned());
+    // 频率未知时误差按 100ppm 增长
+    CHECK(discipline.estimatedErrorUs(startUs + 1000 * 1000000LL) == 20000 + 100000);
+    discipline.update(startUs + intervalUs, -18000, 20000, false);
+    CHECK(discipline.learned());
+    CHECK(discipline.frequencyPpb() == -30000);
+    CHECK(discipline.pollIntervalS() == 0);
+    // 之后按最近一次的修正量（30ppm）增长
+    CHECK(discipline.estimatedErrorUs(discipline.referenceUs() + intervalUs) == 20000 + 18000);
+
+    // 修正后的残差只剩测量噪声，校时间隔开始翻倍
+    discipline.update(startUs + 2 * intervalUs, -18000 + 1000, 20000, false);
+    CHECK(llabs(discipline.frequencyPpb() + 30000 - 833) < 10);
+    CHECK(discipline.pollIntervalS() == ClockDiscipline::MIN_POLL_S);
+    discipline.update(startUs + 3 * intervalUs, -18000, 20000, false);
+    CHECK(discipline.pollIntervalS() == 2 * ClockDiscipline::MIN_POLL_S);
+
+    // 残差超过目标时间隔减半，步进后重新确认
+    discipline.update(startUs + 4 * intervalUs, -18000 + 20000, 20000, false);
+    CHECK(discipline.pollIntervalS() == ClockDiscipline::MIN_POLL_S);
+    CHECK(discipline.save());
+    discipline.update(startUs + 5 * intervalUs, 500000, 20000, true);
+    CHECK(discipline.pollIntervalS() == 0);
+
+    ClockDiscipline loaded;
+    loaded.load();
+    CHECK(loaded.learned());
+    CHECK(loaded.pollIntervalS() == ClockDiscipline::MIN_POLL_S);
+    CHECK(loaded.referenceUs() == startUs + 4 * intervalUs + 2000);
+}
+
+struct TestCase {
+    const char* name;
+    void (*run)();
+};
+
+int main() {
+    // 与固件相同按东8区编码 JJY，NVS 写到临时目录
+    hal::setUtcOffset(8 * 3600);
+    char nvsDirectory[] = "/tmp/wifi2jjy_nvs_XXXXXX";
+    if (mkdtemp(nvsDirectory) == nullptr) {
+        perror("mkdtemp");
+        return 1;
+    }
+    hal::host::setNvsDirectory(nvsDirectory);
+
+    static const TestCase TESTS[] = {
+        {"JJY encode/decode", testJJYEncodeDecode},
+        {"timeline shapes", testTimelineShapes},
+        {"frame layout", testFrameLayout},
+        {"time code fields", testTimeCodeFields},
+        {"schedule merge", testScheduleMerge},
+        {"frame cache", testFrameCache},
+        {"waveform", testWaveform},
+        {"waveform WAV", testWaveformWav},
+        {"clock and timer", testClockAndTimer},
+        {"gpio", testGpio},
+        {"WiFiManager and JSON", testWiFiManagerAndJson},
+        {"WebService over HTTP", testWebService},
+        {"trace VCD", testTraceVcd},
+        {"jitter monitor", testJitterMonitor},
+        {"edge compensation", testEdgeCompensation},
+        {"PON stop", testPonStop},
+        {"multi-output scheduler", testScheduler},
+        {"output idle level", testOutputIdleLevel},
+        {"SNTP packet and selection", testSntpPacket},
+        {"clock discipline", testClockDiscipline},
+    };
+
+    for (const TestCase& test : TESTS) {
+        int before = s_failures;
+        printf("[Test] %s\n", test.name);
+        test.run();
+        printf("[Test] %s: %s\n", test.name, s_failures == before ? "ok" : "FAILED");
+    }
+
+    std::string cleanup = std::string("rm -rf ") + nvsDirectory;
+    if (system(cleanup.c_str()) != 0) {
+        printf("[Test] Failed to remove %s\n", nvsDirectory);
+    }
+
+    printf("%d failures\n", s_failures);
+    return s_failures == 0 ? 0 : 1;
+}
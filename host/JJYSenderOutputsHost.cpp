@@ -0,0 +1,27 @@
+/*
+ * Copyright (c) 2025 Tomosawa
+ * All rights reserved.
+ *
+ * This code is part of the WiFi2JJY project.
+ * GitHub: https://github.com/Tomosawa/WIFI2JJY
+ */
+#include "../JJYSender.h"
+#include "../JJYMultiSender.h"
+#include "../JJYSoftwareOutput.h"
+#include "../JJYSoftwareScheduler.h"
+
+// 主机构建的输出后端工厂：没有 RMT、GPTimer、LEDC、I2S 外设，
+// 所有后端都用软件输出（hal::pinWrite 到模拟的 GPIO）
+JJYOutput* JJYSender::createOutput(int daPin, OutputBackend backend, const TimeCode& code,
+                                   uint32_t carrierHz) {
+    (void)backend;
+    (void)carrierHz;
+    return new JJYSoftwareOutput(daPin, code.shapes->idleLevel);
+}
+
+// 多路调度同样只有软件调度
+JJYScheduler* JJYMultiSender::createScheduler(const int pins[], int count, uint8_t idleHighMask,
+                                              JJYSender::OutputBackend backend) {
+    (void)backend;
+    return new JJYSoftwareScheduler(pins, count, idleHighMask);
+}
@@ -0,0 +1,357 @@
+/*
+ * Copyright (c) 2025 Tomosawa
+ * All rights reserved.
+ *
+ * This code is part of the WiFi2JJY project.
+ * GitHub: https://github.com/Tomosawa/WIFI2JJY
+ */
+#include "SimKernel.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <ucontext.h>
+#include <algorithm>
+#include <deque>
+#include <map>
+#include <memory>
+#include <vector>
+
+namespace sim {
+
+// 每个任务的协程栈；主机上 printf 等调用比固件用得多，不按任务声明的大小分配
+static constexpr size_t TASK_STACK_BYTES = 256 * 1024;
+
+// 同一虚拟时刻连续调度这么多次仍不前进，说明有任务在不阻塞地空转
+static constexpr uint64_t SPIN_LIMIT = 1000000;
+
+struct Task {
+    ucontext_t context;
+    std::unique_ptr<char[]> stack;
+    void (*fn)(void*);
+    void* arg;
+    std::string name;
+    int priority;
+    int64_t wakeUs;      // 可运行的虚拟时间，INT64_MAX 为无限等待
+    uint64_t sequence;   // 同一时刻同优先级按进入就绪的先后
+    bool woken;
+    bool finished;
+};
+
+struct Timer {
+    int64_t atUs;
+    uint64_t sequence;
+    std::function<void()> callback;
+};
+
+static std::vector<std::unique_ptr<Task>> s_tasks;
+static std::map<TimerId, Timer> s_timers;
+static Task* s_current = nullptr;
+static ucontext_t s_schedulerContext;
+static int64_t s_nowUs = 0;
+static uint64_t s_sequence = 0;
+static TimerId s_nextTimerId = 1;
+static SessionEnd s_endRequest = SESSION_RUNNING;
+static int64_t s_stallUntilUs = 0;
+
+int64_t nowUs() {
+    return s_nowUs;
+}
+
+TimerId scheduleAt(int64_t atUs, std::function<void()> callback) {
+    TimerId id = s_nextTimerId++;
+    s_timers[id] = Timer{std::max(atUs, s_nowUs), ++s_sequence, std::move(callback)};
+    return id;
+}
+
+void cancelTimer(TimerId id) {
+    s_timers.erase(id);
+}
+
+Task* currentTask() {
+    return s_current;
+}
+
+bool block(int64_t wakeUs) {
+    Task* task = s_current;
+    if (task == nullptr) {
+        fprintf(stderr, "[Sim] Blocking call outside of a task\n");
+        abort();
+    }
+    task->wakeUs = wakeUs;
+    task->woken = false;
+    task->sequence = ++s_sequence;
+    swapcontext(&task->context, &s_schedulerContext);
+    return task->woken;
+}
+
+void wake(Task* task) {
+    if (task->finished || task->wakeUs <= s_nowUs) {
+        return;
+    }
+    task->wakeUs = s_nowUs;
+    task->woken = true;
+    task->sequence = ++s_sequence;
+}
+
+void stallTasks(int64_t durationUs) {
+    s_stallUntilUs = std::max(s_stallUntilUs, s_nowUs + durationUs);
+}
+
+void endSession(SessionEnd reason) {
+    s_endRequest = reason;
+    Task* task = s_current;
+    if (task == nullptr) {
+        fprintf(stderr, "[Sim] Session ended outside of a task\n");
+        abort();
+    }
+    task->wakeUs = INT64_MAX;
+    swapcontext(&task->context, &s_schedulerContext);
+    // 会话结束后任务被丢弃，不会回到这里
+    abort();
+}
+
+static void taskEntry() {
+    Task* task = s_current;
+    try {
+        task->fn(task->arg);
+    } catch (const std::exception& e) {
+        fprintf(stderr, "[Sim] Task %s threw: %s\n", task->name.c_str(), e.what());
+        abort();
+    }
+    task->finished = true;
+    // 返回后经 uc_link 回到调度器
+}
+
+static bool spawn(void (*fn)(void*), void* arg, const char* name, int priority) {
+    std::unique_ptr<Task> task(new Task());
+    task->stack.reset(new char[TASK_STACK_BYTES]);
+    task->fn = fn;
+    task->arg = arg;
+    task->name = name;
+    task->priority = priority;
+    task->wakeUs = s_nowUs;
+    task->sequence = ++s_sequence;
+    task->woken = false;
+    task->finished = false;
+    if (getcontext(&task->context) != 0) {
+        return false;
+    }
+    task->context.uc_stack.ss_sp = task->stack.get();
+    task->context.uc_stack.ss_size = TASK_STACK_BYTES;
+    task->context.uc_link = &s_schedulerContext;
+    makecontext(&task->context, taskEntry, 0);
+    s_tasks.push_back(std::move(task));
+    return true;
+}
+
+// 先比较时间，同一时刻高优先级在前，再按进入就绪的先后
+static bool runsBefore(const Task* a, const Task* b) {
+    if (a->wakeUs != b->wakeUs) {
+        return a->wakeUs < b->wakeUs;
+    }
+    if (a->priority != b->priority) {
+        return a->priority > b->priority;
+    }
+    return a->sequence < b->sequence;
+}
+
+SessionEnd run(int64_t untilUs) {
+    s_endRequest = SESSION_RUNNING;
+    int64_t lastUs = s_nowUs;
+    uint64_t sameInstant = 0;
+    while (s_endRequest == SESSION_RUNNING) {
+        auto timer = s_timers.end();
+        for (auto it = s_timers.begin(); it != s_timers.end(); ++it) {
+            if (timer == s_timers.end() || it->second.atUs < timer->second.atUs ||
+                (it->second.atUs == timer->second.atUs && it->second.sequence < timer->second.sequence)) {
+                timer = it;
+            }
+        }
+        Task* next = nullptr;
+        for (auto& task : s_tasks) {
+            if (!task->finished && task->wakeUs != INT64_MAX && (next == nullptr || runsBefore(task.get(), next))) {
+                next = task.get();
+            }
+        }
+
+        // 同一时刻定时器先于任务；停顿期间任务推迟到停顿结束
+        int64_t taskAtUs = next != nullptr ? std::max(next->wakeUs, s_stallUntilUs) : INT64_MAX;
+        bool fireTimer = timer != s_timers.end() && (next == nullptr || timer->second.atUs <= taskAtUs);
+        if (!fireTimer && next == nullptr) {
+            s_nowUs = std::max(s_nowUs, untilUs);
+            return SESSION_IDLE;
+        }
+        int64_t atUs = fireTimer ? timer->second.atUs : taskAtUs;
+        if (atUs > untilUs) {
+            s_nowUs = std::max(s_nowUs, untilUs);
+            return SESSION_TIME_LIMIT;
+        }
+        s_nowUs = std::max(s_nowUs, atUs);
+
+        if (s_nowUs != lastUs) {
+            lastUs = s_nowUs;
+            sameInstant = 0;
+        } else if (++sameInstant > SPIN_LIMIT) {
+            fprintf(stderr, "[Sim] Virtual time stuck at %lld us (task %s spinning?)\n",
+                    (long long)s_nowUs, next != nullptr ? next->name.c_str() : "-");
+            abort();
+        }
+
+        if (fireTimer) {
+            std::function<void()> callback = std::move(timer->second.callback);
+            s_timers.erase(timer);
+            callback();
+        } else {
+            s_current = next;
+            swapcontext(&s_schedulerContext, &next->context);
+            s_current = nullptr;
+        }
+    }
+    return s_endRequest;
+}
+
+void advanceTo(int64_t atUs) {
+    s_nowUs = std::max(s_nowUs, atUs);
+}
+
+void resetSession() {
+    s_tasks.clear();
+    s_timers.clear();
+    s_current = nullptr;
+    s_endRequest = SESSION_RUNNING;
+    s_stallUntilUs = 0;
+}
+
+void resetKernel() {
+    resetSession();
+    s_nowUs = 0;
+    s_sequence = 0;
+}
+
+}  // namespace sim
+
+// ---- hal：任务、同步、定时器 ----
+namespace hal {
+
+bool startTask(void (*fn)(void*), const char* name, uint32_t stackBytes, void* arg, int priority) {
+    (void)stackBytes;
+    return sim::spawn(fn, arg, name, priority);
+}
+
+static int64_t deadlineOf(uint32_t timeoutMs) {
+    return timeoutMs == WAIT_FOREVER ? INT64_MAX : sim::nowUs() + (int64_t)timeoutMs * 1000;
+}
+
+struct Semaphore::Impl {
+    uint32_t count;
+    uint32_t maxCount;
+    std::deque<sim::Task*> waiters;
+};
+
+Semaphore::Semaphore(uint32_t maxCount, uint32_t initialCount) : m_impl(new Impl) {
+    m_impl->count = initialCount;
+    m_impl->maxCount = maxCount;
+}
+
+Semaphore::~Semaphore() {
+    delete m_impl;
+}
+
+void Semaphore::give() {
+    if (m_impl->count < m_impl->maxCount) {
+        m_impl->count++;
+    }
+    if (!m_impl->waiters.empty()) {
+        sim::wake(m_impl->waiters.front());
+        m_impl->waiters.pop_front();
+    }
+}
+
+void Semaphore::giveFromIsr() {
+    give();
+}
+
+bool Semaphore::take(uint32_t timeoutMs) {
+    int64_t deadline = deadlineOf(timeoutMs);
+    while (m_impl->count == 0) {
+        if (sim::nowUs() >= deadline) {
+            return false;
+        }
+        sim::Task* self = sim::currentTask();
+        m_impl->waiters.push_back(self);
+        sim::block(deadline);
+        // 超时醒来时仍在等待队列里
+        auto it = std::find(m_impl->waiters.begin(), m_impl->waiters.end(), self);
+        if (it != m_impl->waiters.end()) {
+            m_impl->waiters.erase(it);
+        }
+    }
+    m_impl->count--;
+    return true;
+}
+
+struct OneShotTimer::Impl {
+    Callback callback;
+    void* arg;
+    sim::TimerId id = 0;
+};
+
+OneShotTimer::OneShotTimer(Callback callback, void* arg, const char* name) : m_impl(new Impl) {
+    (void)name;
+    m_impl->callback = callback;
+    m_impl->arg = arg;
+}
+
+OneShotTimer::~OneShotTimer() {
+    stop();
+    delete m_impl;
+}
+
+bool OneShotTimer::start(int64_t delayUs) {
+    stop();
+    Impl* impl = m_impl;
+    impl->id = sim::scheduleAt(sim::nowUs() + delayUs, [impl]() {
+        impl->id = 0;
+        impl->callback(impl->arg);
+    });
+    return true;
+}
+
+void OneShotTimer::stop() {
+    if (m_impl->id != 0) {
+        sim::cancelTimer(m_impl->id);
+        m_impl->id = 0;
+    }
+}
+
+struct Event::Impl {
+    bool signalled = false;
+    sim::Task* waiter = nullptr;
+};
+
+Event::Event() : m_impl(new Impl) {
+}
+
+Event::~Event() {
+    delete m_impl;
+}
+
+void Event::signal() {
+    m_impl->signalled = true;
+    if (m_impl->waiter != nullptr) {
+        sim::wake(m_impl->waiter);
+        m_impl->waiter = nullptr;
+    }
+}
+
+bool Event::wait(uint32_t timeoutMs) {
+    if (!m_impl->signalled) {
+        m_impl->waiter = sim::currentTask();
+        sim::block(deadlineOf(timeoutMs));
+        m_impl->waiter = nullptr;
+    }
+    bool signalled = m_impl->signalled;
+    m_impl->signalled = false;
+    return signalled;
+}
+
+}  // namespace hal
@@ -0,0 +1,126 @@
+/*
+ * Copyright (c) 2025 Tomosawa
+ * All rights reserved.
+ *
+ * This code is part of the WiFi2JJY project.
+ * GitHub: https://github.com/Tomosawa/WIFI2JJY
+ */
+#ifndef SIMKERNEL_H
+#define SIMKERNEL_H
+
+#include <stdint.h>
+#include <functional>
+#include <string>
+#include "../HAL.h"
+
+// 模拟器内核：单线程的离散事件调度器。每个 hal 任务是一个有独立栈的协程，
+// 阻塞调用（sleepMs、信号量、事件等待）把控制权交回调度器，调度器直接把
+// 虚拟时间推进到下一个定时器或任务唤醒时刻。任务之间不会真正并发，
+// 同一输入下每次运行的结果完全相同。
+// SimKernel.cpp 实现调度器与 hal 的任务、同步和定时器部分；
+// HALSim.cpp 在其上实现 hal 的其余部分和设备外部环境（无线、NTP、引脚）。
+namespace sim {
+
+// 会话（一次上电到深度睡眠）的结束原因
+enum SessionEnd {
+    SESSION_RUNNING,
+    SESSION_DEEP_SLEEP,   // 固件调用 hal::deepSleep
+    SESSION_RESTART,      // 固件调用 hal::restart
+    SESSION_TIME_LIMIT,   // 到达模拟时长
+    SESSION_IDLE          // 没有任何任务或定时器可运行
+};
+
+// ---- 调度器 ----
+
+// 虚拟时间（微秒，从模拟开始计）
+int64_t nowUs();
+
+typedef uint64_t TimerId;
+
+// 在虚拟时间 atUs 于调度器上下文中调用 callback（不能阻塞，可以唤醒任务）
+TimerId scheduleAt(int64_t atUs, std::function<void()> callback);
+void cancelTimer(TimerId id);
+
+// 挂起当前任务直到虚拟时间 wakeUs（INT64_MAX 为无限）或被 wake；返回是否被唤醒
+struct Task;
+Task* currentTask();
+bool block(int64_t wakeUs);
+void wake(Task* task);
+
+// 从现在起 durationUs 内不调度任何任务（模拟关中断的代码或 WiFi 驱动占住 CPU），
+// 定时器照常触发，到期的任务在停顿结束后按原顺序运行
+void stallTasks(int64_t durationUs);
+
+// 结束本次会话并挂起当前任务（不再恢复）
+[[noreturn]] void endSession(SessionEnd reason);
+
+// 运行到虚拟时间 untilUs 或会话结束
+SessionEnd run(int64_t untilUs);
+
+// 睡眠期间：没有任务运行，虚拟时间直接跳到 atUs
+void advanceTo(int64_t atUs);
+
+// 丢弃所有任务和定时器（掉电：栈上对象不析构）
+void resetSession();
+
+// 新一次模拟：虚拟时间清零
+void resetKernel();
+
+// ---- 设备外部环境（HALSim.cpp） ----
+
+// 无线、DHCP 和 NTP 的时延模型（任意主机名都解析为一台模拟的 NTP 服务器）
+struct NetworkModel {
+    bool apAvailable = true;           // 保存的热点是否在范围内
+    std::string ssid = "Home";
+    std::string password = "secret";
+    uint32_t associateMs = 1500;       // 扫描信道、认证、关联
+    uint32_t dhcpMs = 400;             // 取得 IP
+    uint32_t scanMs = 2100;            // 一次完整的信道扫描
+    uint32_t ntpRoundTripMs = 40;      // 到 NTP 服务器的往返时延，去程和回程各一半、各自抖动
+    int64_t ntpErrorUs = 0;            // NTP 服务器时钟相对真实时间的误差
+    int64_t ntpFalsetickerUs = 0;      // 非0时第一个解析的服务器时钟另外错这么多，且往返时延减半（最近的坏服务器）
+    uint32_t jitterPercent = 20;       // 以上时延的随机抖动幅度
+};
+
+namespace device {
+
+typedef std::function<void(int pin, bool level)> PinObserver;
+
+// 新一次模拟：trueEpochUs 为虚拟时间0对应的真实 UTC 微秒，设备挂钟从0（1970年）开始
+void reset(const NetworkModel& model, uint32_t seed, int64_t trueEpochUs, bool verbose);
+
+// 上电或从深度睡眠唤醒：单调时钟清零，无线关闭；挂钟（RTC）和 NVS 保留
+void boot();
+
+// 真实 UTC 时间（微秒）
+int64_t trueUtcUs();
+
+// 设备晶振的频率误差：单调时钟和挂钟比真实时间快 ppb（十亿分之一，负数为慢），唤醒和睡眠时相同
+void setClockDrift(int64_t ppb);
+
+// 保存的热点是否在范围内（模拟断网），下次关联时生效
+void setApAvailable(bool available);
+// 热点能关联但上不了网（NTP 无应答），关联成功 afterUs 后链路断开；-1 为正常联网。下次关联时生效
+void setLinkDrop(int64_t afterUs);
+
+// 外部驱动输入引脚（例如钟表拉低/拉高 PON，电平变化时调用 pinCapture 的回调），以及观察输出引脚
+void setPinLevel(int pin, bool level);
+void setPinObserver(PinObserver observer);
+
+// 输出引脚的硬件延迟：固件写引脚后，引脚实际变低/变高要晚 fallUs/riseUs（观察者按实际时刻看到）
+void setOutputLatency(int pin, int64_t fallUs, int64_t riseUs);
+// 用导线把 outPin 接到输入 inPin（校准用的回环），inPin 上的 pinCapture 会看到实际的边沿
+void setLoopback(int outPin, int inPin);
+
+// 写入 NVS（例如预置保存的 WiFi 配置）
+void nvsPut(const char* nameSpace, const char* key, const std::string& value);
+
+// 本次启动的统计：无线打开的累计时长、首次连上 WiFi 和收到 NTP 应答后首次调整挂钟的虚拟时间（未发生为 -1）
+int64_t radioOnUs();
+int64_t connectedAtUs();
+int64_t ntpSyncedAtUs();
+
+}  // namespace device
+}  // namespace sim
+
+#endif // SIMKERNEL_H
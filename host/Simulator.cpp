@@ -0,0 +1,274 @@
+/*
+ * Copyright (c) 2025 Tomosawa
+ * All rights reserved.
+ *
+ * This code is part of the WiFi2JJY project.
+ * GitHub: https://github.com/Tomosawa/WIFI2JJY
+ */
+#include "Simulator.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+#include <new>
+#include "../ClockApp.h"
+#include "../IOPin.h"
+#include "../JJYPulseDecoder.h"
+#include "../JJYTrace.h"
+
+namespace sim {
+
+static constexpr int64_t SECOND_US = 1000000LL;
+static constexpr int64_t MINUTE_US = 60LL * SECOND_US;
+
+// JJY 钟表的接收模型：用 JJYPulseDecoder 像电波钟一样从 DA 解码，
+// 每收满一帧与真实时间比较。
+class ReceiverModel {
+public:
+    // 一帧结束：frameStartUs 为分标记的真实 UTC 时刻
+    typedef std::function<void(int64_t frameStartUs, bool correct, int64_t markerErrorUs)> FrameHandler;
+
+    ReceiverModel(int64_t toleranceUs, FrameHandler onFrame)
+        : m_toleranceUs(toleranceUs), m_onFrame(onFrame),
+          m_decoder([this](const JJYPulseDecoder::Event& event) { onEvent(event); }) {
+    }
+
+    void reset() { m_decoder.reset(); }
+
+    int framesStarted() const { return m_framesStarted; }
+    void clearCounters() { m_framesStarted = 0; }
+
+    // DA 电平变化（JJY 为负逻辑：低电平为脉冲）
+    void onLevel(bool level, int64_t trueUs) { m_decoder.onLevel(level, trueUs); }
+
+private:
+    int64_t m_toleranceUs;
+    FrameHandler m_onFrame;
+    JJYPulseDecoder m_decoder;
+    int m_framesStarted = 0;
+
+    void onEvent(const JJYPulseDecoder::Event& event) {
+        if (event.type == JJYPulseDecoder::FRAME_START) {
+            m_framesStarted++;
+            return;
+        }
+        if (event.type == JJYPulseDecoder::FRAME_BROKEN) {
+            m_onFrame(event.startUs, false, 0);
+            return;
+        }
+
+        // 最近的真实整分，按设备时区取本地时间
+        int64_t minuteUs = (event.startUs + MINUTE_US / 2) / MINUTE_US * MINUTE_US;
+        int64_t errorUs = event.startUs - minuteUs;
+        time_t minute = (time_t)(minuteUs / SECOND_US);
+        struct tm expected;
+        localtime_r(&minute, &expected);
+
+        const JJYDecoded& decoded = event.decoded;
+        bool correct = event.result == JJYDecoder::OK &&
+                       decoded.minute == expected.tm_min && decoded.hour == expected.tm_hour &&
+                       decoded.dayOfYear == expected.tm_yday + 1 &&
+                       decoded.year2 == (expected.tm_year + 1900) % 100 &&
+                       decoded.weekDay == expected.tm_wday && llabs(errorUs) <= m_toleranceUs;
+        m_onFrame(event.startUs, correct, errorUs);
+    }
+};
+
+// 设备 RAM：每次启动在这里重新构造 ClockApp，掉电（深度睡眠）时不析构
+alignas(ClockApp) static unsigned char s_appMemory[sizeof(ClockApp)];
+static ClockApp* s_app = nullptr;
+
+// Arduino 的 loopTask：setup() 一次，之后反复 loop()
+static void appTask(void* param) {
+    const Config* config = static_cast<const Config*>(param);
+    ClockApp* app = new (s_appMemory) ClockApp(JJYSender::BACKEND_SOFTWARE, PROTOCOL_JJY);
+    s_app = app;
+    app->stopOnPon(config->ponStop);
+    if (config->holdoverLimitUs > 0) {
+        app->setHoldoverLimit(config->holdoverLimitUs);
+    }
+    if (config->calibrate) {
+        app->calibrateOnBoot(PIN_DA_CAPTURE);
+    }
+    app->setup();
+    while (true) {
+        app->loop();
+    }
+}
+
+bool Report::allSynced(int64_t graceUs) const {
+    for (size_t i = 0; i < sessions.size(); i++) {
+        const SessionMetrics& session = sessions[i];
+        bool last = i + 1 == sessions.size();
+        if (session.ponHighUs >= 0) {
+            continue;
+        }
+        if (!last || session.end != SESSION_TIME_LIMIT || simulatedUs - session.bootUs >= graceUs) {
+            return false;
+        }
+    }
+    return !sessions.empty();
+}
+
+Report simulate(const Config& config) {
+    auto hostStart = std::chrono::steady_clock::now();
+    Report report;
+
+    resetKernel();
+    device::reset(config.network, config.seed, (int64_t)config.startUtc * SECOND_US, config.verbose);
+    device::setClockDrift(config.clockDriftPpb);
+    if (config.savedConfig) {
+        device::nvsPut("wifi-config", "wifi_ssid", config.network.ssid);
+        device::nvsPut("wifi-config", "wifi_password", config.network.password);
+    }
+    device::setOutputLatency(PIN_DA, config.daFallLatencyUs, config.daRiseLatencyUs);
+    if (config.calibrate) {
+        device::setLoopback(PIN_DA, PIN_DA_CAPTURE);
+    }
+
+    SessionMetrics* session = nullptr;
+    int consecutiveCorrect = 0;
+    TimerId ponTimer = 0;
+    bool ponGlitched = false;
+
+    // 周期性地占住 CPU，检验发送端的截止时间检查
+    std::function<void()> stall = [&]() {
+        stallTasks((int64_t)config.stallMs * 1000);
+        scheduleAt(nowUs() + (int64_t)config.stallEveryS * SECOND_US, stall);
+    };
+
+    // 波形按真实 UTC 记录，帧注释与钟表看到的一致
+    FILE* vcdFile = nullptr;
+    if (config.vcdPath != nullptr) {
+        vcdFile = fopen(config.vcdPath, "w");
+        if (vcdFile == nullptr) {
+            fprintf(stderr, "[Sim] Cannot open %s\n", config.vcdPath);
+        }
+    }
+    JJYTraceWriter trace(VcdWriter::fileSink, vcdFile);
+    if (vcdFile != nullptr) {
+        char comment[80];
+        snprintf(comment, sizeof(comment), "WiFi2JJY simulator DA/PON, t=0 at unix %lld",
+                 (long long)config.startUtc);
+        trace.begin((int64_t)config.startUtc * SECOND_US, comment);
+    }
+
+    // PON 由钟表模型驱动，不经过设备的 pinWrite
+    auto setPon = [&](bool level) {
+        device::setPinLevel(PIN_PON, level);
+        if (vcdFile != nullptr) {
+            trace.record(JJYTraceWriter::SIGNAL_PON, level, device::trueUtcUs());
+        }
+    };
+
+    ReceiverModel receiver(config.markerToleranceUs,
+                           [&](int64_t frameStartUs, bool correct, int64_t markerErrorUs) {
+        // PON 毛刺落在下一帧第21秒的 0.8 秒脉冲中：输出停在第22秒，
+        // 帧结束检查时 PON 已回落，设备应清除停止请求继续发送
+        if (config.ponGlitchMs > 0 && !ponGlitched) {
+            ponGlitched = true;
+            const int64_t glitchUtcUs = frameStartUs + MINUTE_US + 21 * SECOND_US + 100000;
+            scheduleAt(nowUs() + glitchUtcUs - device::trueUtcUs(), [&]() {
+                setPon(true);
+                scheduleAt(nowUs() + (int64_t)config.ponGlitchMs * 1000, [&]() {
+                    if (session->ponHighUs < 0) {
+                        setPon(false);
+                    }
+                });
+            });
+        }
+        if (!correct) {
+            session->framesBad++;
+            consecutiveCorrect = 0;
+            return;
+        }
+        session->framesCorrect++;
+        consecutiveCorrect++;
+        if (session->firstMarkerUs < 0) {
+            session->firstMarkerUs = frameStartUs - config.startUtc * SECOND_US - session->bootUs;
+            session->firstMarkerErrorUs = markerErrorUs;
+        }
+        // 钟表校时完成，处理一会儿后拉高 PON
+        if (consecutiveCorrect >= config.framesToLock && session->ponHighUs < 0 && ponTimer == 0) {
+            ponTimer = scheduleAt(nowUs() + (int64_t)config.ponDelayMs * 1000, [&]() {
+                ponTimer = 0;
+                setPon(true);
+                session->ponHighUs = nowUs() - session->bootUs;
+            });
+        }
+    });
+    device::setPinObserver([&](int pin, bool level) {
+        if (pin == PIN_DA) {
+            receiver.onLevel(level, device::trueUtcUs());
+            if (vcdFile != nullptr) {
+                trace.record(JJYTraceWriter::SIGNAL_DA, level, device::trueUtcUs());
+            }
+        }
+    });
+
+    int64_t bootUs = 0;
+    while (bootUs < config.durationUs) {
+        advanceTo(bootUs);
+        report.sessions.push_back(SessionMetrics());
+        session = &report.sessions.back();
+        session->bootUs = bootUs;
+
+        // 钟表拉低 PON 请求校时，设备从深度睡眠唤醒
+        setPon(false);
+        const bool outage = bootUs >= config.outageFromUs && bootUs < config.outageToUs;
+        device::setApAvailable(config.network.apAvailable && !(outage && config.outageLinkDropUs < 0));
+        device::setLinkDrop(outage ? config.outageLinkDropUs : -1);
+        device::boot();
+        receiver.reset();
+        receiver.clearCounters();
+        consecutiveCorrect = 0;
+        ponTimer = 0;
+        ponGlitched = false;
+        s_app = nullptr;
+        hal::startTask(appTask, "loopTask", 8192, const_cast<Config*>(&config), 1);
+        if (config.stallEveryS > 0 && config.stallMs > 0) {
+            scheduleAt(nowUs() + (int64_t)config.stallEveryS * SECOND_US, stall);
+        }
+
+        session->end = run(config.durationUs);
+
+        session->framesTransmitted = receiver.framesStarted();
+        session->radioOnUs = device::radioOnUs();
+        if (s_app != nullptr) {
+            session->deadlineMisses = s_app->jjySender().deadlineStats().missed();
+            session->frameCacheMisses = s_app->jjySender().frameCacheMisses();
+            session->holdover = s_app->timeSync().source() == TimeSync::SOURCE_HOLDOVER;
+        }
+        if (device::connectedAtUs() >= 0) {
+            session->wifiConnectedUs = device::connectedAtUs() - bootUs;
+        }
+        if (device::ntpSyncedAtUs() >= 0) {
+            session->ntpSyncedUs = device::ntpSyncedAtUs() - bootUs;
+        }
+        resetSession();
+
+        if (session->end == SESSION_DEEP_SLEEP) {
+            session->sleepUs = nowUs() - bootUs;
+            if (config.syncIntervalS == 0) {
+                break;
+            }
+            bootUs = nowUs() + (int64_t)config.syncIntervalS * SECOND_US;
+        } else if (session->end == SESSION_RESTART) {
+            bootUs = nowUs();
+        } else {
+            break;
+        }
+    }
+
+    // 最后一次睡眠一直持续到模拟结束
+    advanceTo(config.durationUs);
+    report.simulatedUs = nowUs();
+    device::setPinObserver(nullptr);
+    if (vcdFile != nullptr) {
+        trace.end(device::trueUtcUs());
+        fclose(vcdFile);
+    }
+    report.hostSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - hostStart).count();
+    return report;
+}
+
+}  // namespace sim
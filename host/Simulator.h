@@ -0,0 +1,82 @@
+/*
+ * Copyright (c) 2025 Tomosawa
+ * All rights reserved.
+ *
+ * This code is part of the WiFi2JJY project.
+ * GitHub: https://github.com/Tomosawa/WIFI2JJY
+ */
+#ifndef SIMULATOR_H
+#define SIMULATOR_H
+
+#include <stdint.h>
+#include <time.h>
+#include <vector>
+#include "SimKernel.h"
+#include "../JJYSender.h"
+
+// 虚拟时间的整机模拟：ClockApp 的 setup()/loop()、JJYSender 发送任务和
+// TimeSync 校时任务都跑在 SimKernel 上，外加一个 JJY 钟表模型：
+// 钟表拉低 PON 唤醒设备，按脉冲宽度解码 DA 上的信号，连续正确解码
+// framesToLock 帧后拉高 PON，设备随后进入深度睡眠，syncIntervalS 后再次唤醒。
+// 一小时的设备时间在主机上只需几十毫秒。
+namespace sim {
+
+struct Config {
+    time_t startUtc = 1735701443;      // 2025-01-01 03:17:23 UTC，故意不在整分
+    int64_t durationUs = 3600LL * 1000000LL;
+    uint32_t seed = 1;
+    uint32_t syncIntervalS = 0;        // 睡眠后多久钟表再次拉低 PON，0 为只校时一次
+    int framesToLock = 2;              // 钟表连续正确解码几帧后拉高 PON
+    uint32_t ponDelayMs = 500;         // 钟表解码完最后一帧到拉高 PON 的处理时间
+    int64_t markerToleranceUs = 50000; // 分标记相对真实整分的容许误差
+    bool savedConfig = true;           // NVS 中是否有保存的 WiFi 配置
+    bool verbose = false;              // 输出固件日志（带虚拟时间戳）
+    const char* vcdPath = nullptr;     // 非空时把 DA/PON 波形和逐分钟解码结果写成 VCD 文件
+    int64_t daFallLatencyUs = 0;       // DA 引脚的硬件延迟：写入后实际变低/变高晚多少
+    int64_t daRiseLatencyUs = 0;
+    bool calibrate = false;            // DA 回环到 PIN_DA_CAPTURE，首次启动时校准边沿延迟
+    uint32_t stallEveryS = 0;          // 每隔多少秒任务调度停顿一次（模拟长时间关中断），0 为不停顿
+    uint32_t stallMs = 0;              // 每次停顿的时长
+    JJYSender::PonStop ponStop = JJYSender::PON_STOP_NEXT_SECOND;  // 钟表拉高 PON 后设备怎样结束发送
+    uint32_t ponGlitchMs = 0;          // 每次会话第一帧之后那一帧的第21.1秒 PON 拉高这么久再拉低（毛刺），0 为没有
+    int64_t clockDriftPpb = 0;         // 设备晶振的频率误差（正数为快）
+    int64_t outageFromUs = -1;         // 这段时间内（相对模拟开始）唤醒时热点不在范围内，-1 为不断网
+    int64_t outageToUs = -1;
+    int64_t outageLinkDropUs = -1;     // 非负时断网期间热点能关联但上不了网，关联成功这么久后链路断开
+    uint32_t holdoverLimitUs = 0;      // 守时的误差上限，0 为固件默认
+    NetworkModel network;
+};
+
+// 一次会话（PON 拉低唤醒到深度睡眠）的统计，时间均为相对本次启动的微秒，未发生为 -1
+struct SessionMetrics {
+    int64_t bootUs = 0;              // 启动的虚拟时间（相对模拟开始）
+    int64_t wifiConnectedUs = -1;
+    int64_t ntpSyncedUs = -1;
+    int64_t firstMarkerUs = -1;      // 第一个正确帧的分标记：PON 拉低到首个正确分标记
+    int64_t firstMarkerErrorUs = 0;  // 该分标记相对真实整分的误差
+    int64_t ponHighUs = -1;
+    int64_t sleepUs = -1;
+    int64_t radioOnUs = 0;
+    int framesTransmitted = 0;       // 钟表看到的帧起点数
+    int framesCorrect = 0;
+    int framesBad = 0;
+    uint32_t deadlineMisses = 0;     // 发送端因边沿超过截止时间而放弃的帧数
+    uint32_t frameCacheMisses = 0;   // 发送端预编码缓存未命中、排队前现场编码的帧数
+    bool holdover = false;           // 没有校时，按本地时钟守时发送
+    SessionEnd end = SESSION_RUNNING;
+};
+
+struct Report {
+    std::vector<SessionMetrics> sessions;
+    int64_t simulatedUs = 0;
+    double hostSeconds = 0;
+
+    // 每次会话都拉高了 PON（最后一次会话运行不足 graceUs 时可以未完成）
+    bool allSynced(int64_t graceUs) const;
+};
+
+Report simulate(const Config& config);
+
+}  // namespace sim
+
+#endif // SIMULATOR_H
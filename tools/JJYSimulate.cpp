@@ -0,0 +1,258 @@
+/*
+ * Copyright (c) 2025 Tomosawa
+ * All rights reserved.
+ *
+ * This code is part of the WiFi2JJY project.
+ * GitHub: https://github.com/Tomosawa/WIFI2JJY
+ */
+
+// 整机虚拟时间模拟（主机工具）：在 SimKernel 上运行 ClockApp、发送任务和校时任务，
+// 无线关联、DHCP、扫描和 NTP 按时延模型推进，钟表模型解码 DA 并控制 PON。
+// 每次会话报告：WiFi 连上、NTP 校时、首个正确分标记、PON 拉高和进入睡眠的时刻
+// （均相对 PON 拉低），无线开启时长，发送/正确/错误的帧数，以及发送端因错过截止时间放弃的帧数。
+//
+// 使用 CMake 主机构建的 jjy_simulate 目标（ctest 中的 simulate_hour）
+// 用法：jjy_simulate [--minutes N] [--interval 秒] [--seed N] [--lock-frames N]
+//                    [--pon-delay-ms N] [--ntp-error-ms N] [--ntp-falseticker-ms N] [--jitter 百分比]
+//                    [--no-ap] [--no-config] [--verbose] [--check] [--vcd 文件]
+//                    [--da-latency-us 下降,上升] [--calibrate] [--stall-every 秒 --stall-ms N]
+//                    [--pon-stop frame|second|now] [--pon-glitch-ms N] [--drift-ppm X]
+//                    [--wav 文件 [--wav-code JJY|WWVB|DCF77|MSF]]
+//   --interval  睡眠后多久钟表再次拉低 PON（默认0，只校时一次）
+//   --check     有会话未能让钟表拉高 PON 时返回1
+//   --ntp-falseticker-ms  第一台 NTP 服务器的时钟另外错 N 毫秒，且离得最近（往返时延减半）
+//   --vcd       把 DA/PON 波形和每分钟的解码结果写成 VCD（PulseView / GTKWave）
+//   --da-latency-us  DA 引脚实际变低/变高比固件写入晚多少微秒
+//   --calibrate      DA 回环到 PIN_DA_CAPTURE，首次启动时校准并补偿边沿延迟
+//   --stall-every/--stall-ms  每隔若干秒任务调度停顿 N 毫秒（模拟长时间关中断）
+//   --drift-ppm 设备晶振快 X ppm（负数为慢），校时之间由时钟驯服学习并修正
+//   --outage FROM,TO  第 FROM 到 TO 分钟之间唤醒时热点不在范围内（断网），误差估计在上限内时守时发送
+//   --outage-link-drop-ms N  断网期间热点能关联但上不了网（NTP 无应答），关联成功 N 毫秒后链路断开
+//   --holdover-ms     守时的误差上限（默认100）
+//   --pon-stop  钟表拉高 PON 后：帧结束才检查（frame）、停在下一个整秒（second，默认）或立即停止（now）
+//   --pon-glitch-ms  每次会话第二帧的第21.1秒 PON 拉高 N 毫秒再回落（抖动或钟表的脉冲），之后的帧要照常输出
+//   --wav       不运行模拟，把模拟起点之后第一个整分的帧渲染成 WAV（48kHz 单声道 16 位）后退出
+//   --wav-code  WAV 使用的时间码协议（默认 JJY）
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../host/Simulator.h"
+#include "../JJYWaveform.h"
+
+static const char* endName(sim::SessionEnd end) {
+    switch (end) {
+        case sim::SESSION_DEEP_SLEEP:
+            return "sleep";
+        case sim::SESSION_RESTART:
+            return "restart";
+        case sim::SESSION_TIME_LIMIT:
+            return "running";
+        case sim::SESSION_IDLE:
+            return "idle";
+        default:
+            return "-";
+    }
+}
+
+// 相对启动的秒数，未发生时输出 "-"
+static void printSeconds(int64_t us) {
+    if (us < 0) {
+        printf(" %9s", "-");
+    } else {
+        printf(" %9.3f", us / 1e6);
+    }
+}
+
+// 把 startUtc 之后第一个整分按 code 渲染成 WAV 文件
+static int writeWav(const char* path, time_t startUtc, const TimeCode& code) {
+    static JJYWaveform waveform;
+    if (!waveform.configure(JJYWaveform::Config())) {
+        fprintf(stderr, "Waveform configuration failed\n");
+        return 1;
+    }
+    FILE* file = fopen(path, "wb");
+    if (file == nullptr) {
+        fprintf(stderr, "Cannot open %s\n", path);
+        return 1;
+    }
+    const time_t minute = (startUtc + 59) / 60 * 60;
+    const bool written = waveform.writeWav(file, minute, code);
+    if (fclose(file) != 0 || !written) {
+        fprintf(stderr, "Failed to write %s\n", path);
+        return 1;
+    }
+    printf("%s frame for %lld written to %s\n", code.name, (long long)minute, path);
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    sim::Config config;
+    bool check = false;
+    const char* wavPath = nullptr;
+    const TimeCode* wavCode = &TimeCode::get(PROTOCOL_JJY);
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (strcmp(arg, "--minutes") == 0 && value != nullptr) {
+            config.durationUs = atoll(value) * 60LL * 1000000LL;
+            i++;
+        } else if (strcmp(arg, "--interval") == 0 && value != nullptr) {
+            config.syncIntervalS = (uint32_t)atoi(value);
+            i++;
+        } else if (strcmp(arg, "--seed") == 0 && value != nullptr) {
+            config.seed = (uint32_t)atoi(value);
+            i++;
+        } else if (strcmp(arg, "--lock-frames") == 0 && value != nullptr) {
+            config.framesToLock = atoi(value);
+            i++;
+        } else if (strcmp(arg, "--pon-delay-ms") == 0 && value != nullptr) {
+            config.ponDelayMs = (uint32_t)atoi(value);
+            i++;
+        } else if (strcmp(arg, "--ntp-error-ms") == 0 && value != nullptr) {
+            config.network.ntpErrorUs = atoll(value) * 1000LL;
+            i++;
+        } else if (strcmp(arg, "--jitter") == 0 && value != nullptr) {
+            config.network.jitterPercent = (uint32_t)atoi(value);
+            i++;
+        } else if (strcmp(arg, "--vcd") == 0 && value != nullptr) {
+            config.vcdPath = value;
+            i++;
+        } else if (strcmp(arg, "--da-latency-us") == 0 && value != nullptr) {
+            long long fallUs = 0;
+            long long riseUs = 0;
+            if (sscanf(value, "%lld,%lld", &fallUs, &riseUs) != 2) {
+                fprintf(stderr, "--da-latency-us expects FALL,RISE\n");
+                return 2;
+            }
+            config.daFallLatencyUs = fallUs;
+            config.daRiseLatencyUs = riseUs;
+            i++;
+        } else if (strcmp(arg, "--stall-every") == 0 && value != nullptr) {
+            config.stallEveryS = (uint32_t)atoi(value);
+            i++;
+        } else if (strcmp(arg, "--ntp-falseticker-ms") == 0 && value != nullptr) {
+            config.network.ntpFalsetickerUs = atoll(value) * 1000LL;
+            i++;
+        } else if (strcmp(arg, "--drift-ppm") == 0 && value != nullptr) {
+            config.clockDriftPpb = (int64_t)(atof(value) * 1000.0);
+            i++;
+        } else if (strcmp(arg, "--outage") == 0 && value != nullptr) {
+            long long fromMinutes = 0;
+            long long toMinutes = 0;
+            if (sscanf(value, "%lld,%lld", &fromMinutes, &toMinutes) != 2) {
+                fprintf(stderr, "--outage expects FROM,TO (minutes)\n");
+                return 2;
+            }
+            config.outageFromUs = fromMinutes * 60LL * 1000000LL;
+            config.outageToUs = toMinutes * 60LL * 1000000LL;
+            i++;
+        } else if (strcmp(arg, "--outage-link-drop-ms") == 0 && value != nullptr) {
+            config.outageLinkDropUs = atoll(value) * 1000LL;
+            i++;
+        } else if (strcmp(arg, "--holdover-ms") == 0 && value != nullptr) {
+            config.holdoverLimitUs = (uint32_t)atoi(value) * 1000;
+            i++;
+        } else if (strcmp(arg, "--pon-glitch-ms") == 0 && value != nullptr) {
+            config.ponGlitchMs = (uint32_t)atoi(value);
+            i++;
+        } else if (strcmp(arg, "--stall-ms") == 0 && value != nullptr) {
+            config.stallMs = (uint32_t)atoi(value);
+            i++;
+        } else if (strcmp(arg, "--pon-stop") == 0 && value != nullptr) {
+            if (strcmp(value, "frame") == 0) {
+                config.ponStop = JJYSender::PON_STOP_FRAME_END;
+            } else if (strcmp(value, "second") == 0) {
+                config.ponStop = JJYSender::PON_STOP_NEXT_SECOND;
+            } else if (strcmp(value, "now") == 0) {
+                config.ponStop = JJYSender::PON_STOP_IMMEDIATE;
+            } else {
+                fprintf(stderr, "--pon-stop expects frame, second or now\n");
+                return 2;
+            }
+            i++;
+        } else if (strcmp(arg, "--wav") == 0 && value != nullptr) {
+            wavPath = value;
+            i++;
+        } else if (strcmp(arg, "--wav-code") == 0 && value != nullptr) {
+            wavCode = nullptr;
+            for (int p = 0; p < PROTOCOL_COUNT; p++) {
+                if (strcmp(value, TimeCode::get((TimeCodeProtocol)p).name) == 0) {
+                    wavCode = &TimeCode::get((TimeCodeProtocol)p);
+                }
+            }
+            if (wavCode == nullptr) {
+                fprintf(stderr, "--wav-code expects JJY, WWVB, DCF77 or MSF\n");
+                return 2;
+            }
+            i++;
+        } else if (strcmp(arg, "--calibrate") == 0) {
+            config.calibrate = true;
+        } else if (strcmp(arg, "--no-ap") == 0) {
+            config.network.apAvailable = false;
+        } else if (strcmp(arg, "--no-config") == 0) {
+            config.savedConfig = false;
+        } else if (strcmp(arg, "--verbose") == 0) {
+            config.verbose = true;
+        } else if (strcmp(arg, "--check") == 0) {
+            check = true;
+        } else {
+            fprintf(stderr, "Unknown argument: %s\n", arg);
+            return 2;
+        }
+    }
+
+    if (wavPath != nullptr) {
+        return writeWav(wavPath, config.startUtc, *wavCode);
+    }
+
+    sim::Report report = sim::simulate(config);
+
+    printf("session      boot      wifi       ntp    marker  pon-high     sleep     radio  frames ok bad miss  marker-err  end\n");
+    int64_t radioUs = 0;
+    int frames = 0;
+    int syncs = 0;
+    int holdovers = 0;
+    uint32_t cacheMisses = 0;
+    for (size_t i = 0; i < report.sessions.size(); i++) {
+        const sim::SessionMetrics& session = report.sessions[i];
+        printf("%7zu", i + 1);
+        printSeconds(session.bootUs);
+        printSeconds(session.wifiConnectedUs);
+        if (session.holdover) {
+            printf(" %9s", "hold");
+        } else {
+            printSeconds(session.ntpSyncedUs);
+        }
+        printSeconds(session.firstMarkerUs);
+        printSeconds(session.ponHighUs);
+        printSeconds(session.sleepUs);
+        printSeconds(session.radioOnUs);
+        printf(" %6d %2d %3d %4lu", session.framesTransmitted, session.framesCorrect, session.framesBad,
+               (unsigned long)session.deadlineMisses);
+        if (session.firstMarkerUs >= 0) {
+            printf(" %+8lld us", (long long)session.firstMarkerErrorUs);
+        } else {
+            printf(" %11s", "-");
+        }
+        printf("  %s\n", endName(session.end));
+        radioUs += session.radioOnUs;
+        frames += session.framesTransmitted;
+        syncs += session.ntpSyncedUs >= 0 ? 1 : 0;
+        holdovers += session.holdover ? 1 : 0;
+        cacheMisses += session.frameCacheMisses;
+    }
+
+    double simulatedSeconds = report.simulatedUs / 1e6;
+    printf("simulated %.0f s in %.1f ms (%.0fx): %zu sessions, %d NTP syncs, %d holdover, radio on %.1f s (%.2f%%), "
+           "%d frames, %lu frame cache misses\n",
+           simulatedSeconds, report.hostSeconds * 1000, simulatedSeconds / report.hostSeconds,
+           report.sessions.size(), syncs, holdovers, radioUs / 1e6,
+           simulatedSeconds > 0 ? radioUs / 1e4 / simulatedSeconds : 0.0, frames, (unsigned long)cacheMisses);
+
+    if (check && !report.allSynced(5 * 60 * 1000000LL)) {
+        printf("not every session got the clock to raise PON\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,191 @@
+/*
+ * Copyright (c) 2025 Tomosawa
+ * All rights reserved.
+ *
+ * This code is part of the WiFi2JJY project.
+ * GitHub: https://github.com/Tomosawa/WIFI2JJY
+ */
+
+// JJY 编码器穷举往返校验（主机工具）：
+// 对 2000-01-01 00:00 至 2099-12-31 23:59 的每一分钟（约5260万帧）编码后用参考解码器
+// 解码，与输入的时间逐字段比较。日期由本工具按公历规则独立推算，不经过 libc。
+// 工作按天均分到所有核心，最后报告吞吐量（帧/秒）。
+//
+// 编译（在仓库根目录）：
+//   g++ -std=c++17 -O2 -pthread tools/JJYValidate.cpp TimeCode.cpp JJYTimeline.cpp JJYDecoder.cpp -o jjy_validate
+// 或使用 CMake 主机构建的 jjy_validate 目标（ctest 中的 jjy_round_trip）
+// 用法：jjy_validate [--timeline] [--threads N]
+//   --timeline  同时把每帧编译成边沿时间表，并从脉冲宽度解码
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include "../TimeCode.h"
+#include "../JJYTimeline.h"
+#include "../JJYDecoder.h"
+
+struct CivilDay {
+    int year;
+    int month;      // 1-12
+    int monthDay;   // 1-31
+    int yearDay;    // 0-365，与 tm_yday 相同
+    int weekDay;    // 0=星期日
+};
+
+struct Failure {
+    int day;
+    int hour;
+    int minute;
+    JJYDecoder::Result result;
+    JJYDecoded decoded;
+};
+
+struct WorkerResult {
+    uint64_t frames = 0;
+    uint64_t failures = 0;
+    bool hasFailure = false;
+    Failure first;
+};
+
+static const int FIRST_YEAR = 2000;
+static const int LAST_YEAR = 2099;
+
+static bool isLeapYear(int year) {
+    return (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+}
+
+// 按公历规则逐日推算，2000-01-01 为星期六
+static std::vector<CivilDay> buildCalendar() {
+    static const int DAYS_IN_MONTH[12] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    std::vector<CivilDay> days;
+    int weekDay = 6;
+    for (int year = FIRST_YEAR; year <= LAST_YEAR; year++) {
+        int yearDay = 0;
+        for (int month = 1; month <= 12; month++) {
+            int length = DAYS_IN_MONTH[month - 1] + (month == 2 && isLeapYear(year) ? 1 : 0);
+            for (int monthDay = 1; monthDay <= length; monthDay++) {
+                days.push_back({year, month, monthDay, yearDay, weekDay});
+                yearDay++;
+                weekDay = (weekDay + 1) % 7;
+            }
+        }
+    }
+    return days;
+}
+
+static bool matches(const JJYDecoded& decoded, const CivilDay& day, int hour, int minute) {
+    return decoded.minute == minute && decoded.hour == hour && decoded.dayOfYear == day.yearDay + 1 &&
+           decoded.year2 == day.year % 100 && decoded.weekDay == day.weekDay;
+}
+
+static void validateDays(const std::vector<CivilDay>& days, int firstDay, int endDay, bool viaTimeline,
+                         WorkerResult& out) {
+    // 在本地累计，结束时才写回，各线程的结果不共享缓存行
+    WorkerResult result;
+    JJYTimeline timeline;
+    for (int d = firstDay; d < endDay; d++) {
+        const CivilDay& day = days[d];
+        struct tm timeinfo;
+        memset(&timeinfo, 0, sizeof(timeinfo));
+        timeinfo.tm_year = day.year - 1900;
+        timeinfo.tm_mon = day.month - 1;
+        timeinfo.tm_mday = day.monthDay;
+        timeinfo.tm_yday = day.yearDay;
+        timeinfo.tm_wday = day.weekDay;
+
+        for (int hour = 0; hour < 24; hour++) {
+            timeinfo.tm_hour = hour;
+            for (int minute = 0; minute < 60; minute++) {
+                timeinfo.tm_min = minute;
+
+                JJYFrame frame;
+                JJYCode::encodeTime(frame, &timeinfo);
+                JJYDecoded decoded;
+                JJYDecoder::Result status;
+                if (viaTimeline) {
+                    timeline.compile(frame, 0, JJYCode::SHAPES);
+                    status = JJYDecoder::decode(timeline, decoded);
+                } else {
+                    status = JJYDecoder::decode(frame, decoded);
+                }
+                result.frames++;
+
+                if (status != JJYDecoder::OK || !matches(decoded, day, hour, minute)) {
+                    if (!result.hasFailure) {
+                        result.hasFailure = true;
+                        result.first = {d, hour, minute, status, decoded};
+                    }
+                    result.failures++;
+                }
+            }
+        }
+    }
+    out = result;
+}
+
+int main(int argc, char** argv) {
+    bool viaTimeline = false;
+    unsigned threads = std::thread::hardware_concurrency();
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--timeline") == 0) {
+            viaTimeline = true;
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threads = (unsigned)atoi(argv[++i]);
+        } else {
+            fprintf(stderr, "usage: %s [--timeline] [--threads N]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (threads == 0) {
+        threads = 1;
+    }
+
+    const std::vector<CivilDay> days = buildCalendar();
+    const int dayCount = (int)days.size();
+    std::vector<WorkerResult> results(threads);
+    std::vector<std::thread> workers;
+
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned t = 0; t < threads; t++) {
+        int firstDay = (int)((int64_t)dayCount * t / threads);
+        int endDay = (int)((int64_t)dayCount * (t + 1) / threads);
+        workers.emplace_back(validateDays, std::cref(days), firstDay, endDay, viaTimeline, std::ref(results[t]));
+    }
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    uint64_t frames = 0;
+    uint64_t failures = 0;
+    const Failure* first = nullptr;
+    for (const WorkerResult& result : results) {
+        frames += result.frames;
+        failures += result.failures;
+        if (result.hasFailure && first == nullptr) {
+            first = &result.first;
+        }
+    }
+
+    printf("JJY round trip %d-%d (%s): %llu frames, %u threads, %.2f s, %.0f frames/s\n",
+           FIRST_YEAR, LAST_YEAR, viaTimeline ? "timeline" : "frame", (unsigned long long)frames, threads,
+           seconds, frames / seconds);
+    if (first != nullptr) {
+        const CivilDay& day = days[first->day];
+        printf("%llu failures, first at %04d-%02d-%02d %02d:%02d: %s",
+               (unsigned long long)failures, day.year, day.month, day.monthDay, first->hour, first->minute,
+               JJYDecoder::resultName(first->result));
+        if (first->result == JJYDecoder::OK) {
+            printf(" (decoded %02d:%02d day %d year %02d week %d)", first->decoded.hour, first->decoded.minute,
+                   first->decoded.dayOfYear, first->decoded.year2, first->decoded.weekDay);
+        }
+        printf("\n");
+        return 1;
+    }
+    printf("all frames decoded back to their input\n");
+    return 0;
+}